@@ -0,0 +1,621 @@
+// Throughput benchmarks for the reader/writer hot paths (Google Benchmark).
+//
+//   g++ -std=c++20 -O2 -Iinclude bench/bpw_bench.cpp src/*.cpp -lbenchmark -lpthread -o bpw_bench
+//   ./bpw_bench | tee bench_output.txt
+//
+// Every benchmark reports bytes/s over the encoded input (or output); the
+// record benchmarks also report records/s. Kernels that dispatch on the CPU
+// take the instruction set as the last argument so the vector paths can be
+// compared with scalar directly.
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "bpw/bit_reader.hpp"
+#include "bpw/bit_writer.hpp"
+#include "bpw/bulk.hpp"
+#include "bpw/crc32c.hpp"
+#include "bpw/delta.hpp"
+#include "bpw/framing.hpp"
+#include "bpw/layout.hpp"
+#include "bpw/layout_cache.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/runtime_layout.hpp"
+#include "bpw/simd.hpp"
+#include "bpw/unchecked.hpp"
+#include "bpw/varint.hpp"
+#include "bpw/writer.hpp"
+
+namespace {
+
+constexpr size_t buffer_size = size_t{1} << 20;
+constexpr size_t record_count = size_t{1} << 16;
+
+std::vector<uint8_t> random_bytes(size_t n, uint32_t seed = 1) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> v(n);
+    for (auto& b : v) b = static_cast<uint8_t>(rng());
+    return v;
+}
+
+void report(benchmark::State& state, size_t bytes, size_t records = 0) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    if (records)
+        state.counters["records/s"] =
+            benchmark::Counter(static_cast<double>(state.iterations() * records), benchmark::Counter::kIsRate);
+}
+
+// Pin dispatch for one benchmark run; skips ISAs the CPU lacks.
+bool use_isa(benchmark::State& state, int64_t arg) {
+    auto isa = static_cast<bpw::simd::Isa>(arg);
+    bpw::simd::force_isa(isa);
+    if (bpw::simd::active_isa() != isa) {
+        state.SkipWithError("instruction set not supported on this CPU");
+        return false;
+    }
+    state.SetLabel(bpw::simd::to_string(isa));
+    return true;
+}
+
+void isa_args(benchmark::internal::Benchmark* b) {
+    using bpw::simd::Isa;
+    for (Isa isa : {Isa::scalar, Isa::ssse3, Isa::avx2, Isa::neon}) b->Arg(static_cast<int64_t>(isa));
+}
+
+// ---------------------------------------------------------------- bit reads
+
+// Args: width in bits, starting bit offset (0 keeps byte-aligned widths
+// aligned; 3 makes every read straddle byte boundaries).
+void BM_BitRead(benchmark::State& state) {
+    const auto width = static_cast<unsigned>(state.range(0));
+    const auto offset = static_cast<unsigned>(state.range(1));
+    const auto buf = random_bytes(buffer_size);
+    const size_t reads = (buffer_size * 8 - offset) / width;
+    for (auto _ : state) {
+        bpw::BitReader br(buf.data(), buf.size());
+        br.skip_bits(offset);
+        uint32_t acc = 0;
+        for (size_t i = 0; i < reads; ++i) acc ^= br.read_bits(width);
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, buffer_size);
+}
+BENCHMARK(BM_BitRead)->ArgsProduct({{1, 7, 8, 13, 16, 24, 32}, {0, 3}});
+
+void BM_BitWrite(benchmark::State& state) {
+    const auto width = static_cast<unsigned>(state.range(0));
+    const size_t writes = buffer_size * 8 / width;
+    const uint32_t mask = width == 32 ? ~uint32_t{0} : (uint32_t{1} << width) - 1;
+    bpw::Writer out(buffer_size + 8);
+    for (auto _ : state) {
+        out.clear();
+        bpw::BitWriter bw(out);
+        for (size_t i = 0; i < writes; ++i) bw.write_bits(static_cast<uint32_t>(i) & mask, width);
+        benchmark::DoNotOptimize(bw.finish());
+    }
+    report(state, buffer_size);
+}
+BENCHMARK(BM_BitWrite)->Arg(1)->Arg(7)->Arg(13)->Arg(32);
+
+// Args: bit width, ISA.
+void BM_UnpackBits(benchmark::State& state) {
+    if (!use_isa(state, state.range(1))) return;
+    const auto width = static_cast<unsigned>(state.range(0));
+    const size_t count = buffer_size * 8 / width;
+    const auto buf = random_bytes(bpw::simd::packed_size(width, count));
+    std::vector<uint32_t> out(count);
+    for (auto _ : state) {
+        bpw::simd::unpack_bits(buf.data(), width, count, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    report(state, buf.size());
+}
+BENCHMARK(BM_UnpackBits)->ArgsProduct({{3, 12, 17, 29}, {0, 1, 2, 3}});
+
+// ---------------------------------------------------------------- endian swap
+
+template <class T>
+void BM_ReadArrayBig(benchmark::State& state) {
+    if (!use_isa(state, state.range(0))) return;
+    const auto buf = random_bytes(buffer_size);
+    std::vector<T> out(buffer_size / sizeof(T));
+    for (auto _ : state) {
+        bpw::Reader r(buf.data(), buf.size());
+        benchmark::DoNotOptimize(bpw::read_array<bpw::Endian::big>(r, out.data(), out.size()));
+    }
+    report(state, buffer_size);
+}
+BENCHMARK_TEMPLATE(BM_ReadArrayBig, uint16_t)->Apply(isa_args);
+BENCHMARK_TEMPLATE(BM_ReadArrayBig, uint32_t)->Apply(isa_args);
+BENCHMARK_TEMPLATE(BM_ReadArrayBig, uint64_t)->Apply(isa_args);
+
+template <class T>
+void BM_WriteArrayBig(benchmark::State& state) {
+    if (!use_isa(state, state.range(0))) return;
+    std::vector<T> src(buffer_size / sizeof(T));
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<T>(i * 0x9e3779b97f4a7c15ull);
+    bpw::Writer out(buffer_size);
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(bpw::write_array<bpw::Endian::big>(out, src.data(), src.size()));
+    }
+    report(state, buffer_size);
+}
+BENCHMARK_TEMPLATE(BM_WriteArrayBig, uint32_t)->Apply(isa_args);
+BENCHMARK_TEMPLATE(BM_WriteArrayBig, uint64_t)->Apply(isa_args);
+
+// ---------------------------------------------------------------- checksums
+
+// Args: buffer size.
+void BM_Crc32c(benchmark::State& state) {
+    const auto buf = random_bytes(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) benchmark::DoNotOptimize(bpw::crc32c(buf.data(), buf.size()));
+    state.SetLabel(bpw::crc32c_hardware() ? "hardware" : "tables");
+    report(state, buf.size());
+}
+BENCHMARK(BM_Crc32c)->Arg(64)->Arg(4096)->Arg(buffer_size);
+
+// ---------------------------------------------------------------- varints
+
+// Value mixes: 0 = all below 128, 1 = mostly small with 1-in-8 full-width
+// values, 2 = uniformly distributed bit lengths.
+std::vector<uint64_t> varint_values(int mix, size_t n) {
+    std::mt19937_64 rng(7);
+    std::vector<uint64_t> v(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t r = rng();
+        if (mix == 0) r &= 0x7f;
+        else if (mix == 1) r = i % 8 ? r & 0x7f : r;
+        else r >>= rng() % 64;
+        v[i] = r;
+    }
+    return v;
+}
+
+// Args: value mix.
+void BM_VarintDecode(benchmark::State& state) {
+    const auto values = varint_values(static_cast<int>(state.range(0)), record_count);
+    bpw::Writer enc;
+    for (uint64_t v : values) (void)bpw::write_varint(enc, v);
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        uint64_t v, acc = 0;
+        while (bpw::read_varint(r, v) == bpw::Status::ok) acc += v;
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, enc.size(), values.size());
+}
+BENCHMARK(BM_VarintDecode)->DenseRange(0, 2);
+
+// Args: value mix, ISA.
+void BM_VarintDecodeBulk(benchmark::State& state) {
+    if (!use_isa(state, state.range(1))) return;
+    const auto values = varint_values(static_cast<int>(state.range(0)), record_count);
+    bpw::Writer enc;
+    (void)bpw::write_varints(enc, values.data(), values.size());
+    std::vector<uint64_t> out(values.size());
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        benchmark::DoNotOptimize(bpw::read_varints(r, out.data(), out.size()));
+    }
+    report(state, enc.size(), values.size());
+}
+BENCHMARK(BM_VarintDecodeBulk)->ArgsProduct({{0, 1, 2}, {0, 1, 2, 3}});
+
+void BM_VarintEncodeBulk(benchmark::State& state) {
+    const auto values = varint_values(static_cast<int>(state.range(0)), record_count);
+    bpw::Writer out(values.size() * bpw::max_varint_size);
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(bpw::write_varints(out, values.data(), values.size()));
+    }
+    report(state, out.size(), values.size());
+}
+BENCHMARK(BM_VarintEncodeBulk)->DenseRange(0, 2);
+
+// Args: value mix, ISA.
+void BM_StreamVByteDecode(benchmark::State& state) {
+    if (!use_isa(state, state.range(1))) return;
+    const auto wide = varint_values(static_cast<int>(state.range(0)), record_count);
+    std::vector<uint32_t> values(wide.begin(), wide.end());
+    bpw::Writer enc;
+    (void)bpw::write_streamvbyte(enc, values.data(), values.size());
+    std::vector<uint32_t> out(values.size());
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        benchmark::DoNotOptimize(bpw::read_streamvbyte(r, out.data(), out.size()));
+    }
+    report(state, enc.size(), values.size());
+}
+BENCHMARK(BM_StreamVByteDecode)->ArgsProduct({{0, 1, 2}, {0, 1, 2, 3}});
+
+// Microsecond timestamps ~1 ms apart with jitter, as in a capture.
+std::vector<uint64_t> capture_timestamps(size_t n) {
+    std::mt19937_64 rng(13);
+    std::vector<uint64_t> v(n);
+    uint64_t ts = 1'700'000'000'000'000;
+    for (auto& t : v) t = ts += 1000 + rng() % 50;
+    return v;
+}
+
+// Bytes/s are of the decoded 8-byte values, so the numbers compare with
+// reading the raw column (BM_ReadArrayBig<uint64_t>).
+void BM_DeltaDecode(benchmark::State& state) {
+    if (!use_isa(state, state.range(0))) return;
+    const auto values = capture_timestamps(record_count);
+    bpw::Writer enc;
+    (void)bpw::write_delta(enc, values.data(), values.size());
+    std::vector<uint64_t> out(values.size());
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        benchmark::DoNotOptimize(bpw::read_delta(r, out.data(), out.size()));
+    }
+    report(state, values.size() * sizeof(uint64_t), values.size());
+    state.counters["ratio"] = static_cast<double>(values.size() * sizeof(uint64_t)) / static_cast<double>(enc.size());
+}
+BENCHMARK(BM_DeltaDecode)->Apply(isa_args);
+
+void BM_DeltaEncode(benchmark::State& state) {
+    const auto values = capture_timestamps(record_count);
+    bpw::Writer out(bpw::delta_max_size(values.size()));
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(bpw::write_delta(out, values.data(), values.size()));
+    }
+    report(state, values.size() * sizeof(uint64_t), values.size());
+}
+BENCHMARK(BM_DeltaEncode);
+
+// ---------------------------------------------------------------- records
+
+struct Trade {
+    uint64_t timestamp;
+    uint32_t instrument;
+    int32_t price;
+    uint32_t quantity;
+    uint16_t venue;
+    uint8_t side;
+    bool aggressor;
+};
+
+// 21-byte big-endian wire record with a 40-bit timestamp.
+using TradeLayout = bpw::Layout<Trade,
+    bpw::Field<&Trade::timestamp,  0, 5, bpw::Endian::big>,
+    bpw::Field<&Trade::instrument, 5, 4, bpw::Endian::big>,
+    bpw::Field<&Trade::price,      9, 4, bpw::Endian::big>,
+    bpw::Field<&Trade::quantity,  13, 4, bpw::Endian::big>,
+    bpw::Field<&Trade::venue,     17, 2, bpw::Endian::big>,
+    bpw::Field<&Trade::side,      19, 1, bpw::Endian::big>,
+    bpw::Field<&Trade::aggressor, 20, 1, bpw::Endian::big>>;
+
+std::vector<Trade> make_trades(size_t n) {
+    std::mt19937_64 rng(11);
+    std::vector<Trade> v(n);
+    uint64_t ts = 1'700'000'000'000;
+    for (auto& t : v) {
+        ts += rng() % 1000;
+        t = Trade{ts & 0xffffffffffull,
+                  static_cast<uint32_t>(rng() % 5000),
+                  static_cast<int32_t>(rng() % 200000) - 100000,
+                  static_cast<uint32_t>(rng() % 10000),
+                  static_cast<uint16_t>(rng() % 40),
+                  static_cast<uint8_t>(rng() & 1),
+                  (rng() & 1) != 0};
+    }
+    return v;
+}
+
+// Touch every field so decoding cannot be trimmed to the fields used.
+uint64_t checksum(const Trade& t) noexcept {
+    return t.timestamp ^ t.instrument ^ static_cast<uint32_t>(t.price) ^ t.quantity ^ t.venue ^ t.side ^
+           static_cast<uint64_t>(t.aggressor);
+}
+
+void BM_RecordEncode(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    bpw::Writer out(trades.size() * TradeLayout::size);
+    for (auto _ : state) {
+        out.clear();
+        for (const Trade& t : trades) benchmark::DoNotOptimize(TradeLayout::write(out, t));
+    }
+    report(state, trades.size() * TradeLayout::size, trades.size());
+}
+BENCHMARK(BM_RecordEncode);
+
+// One prepared block for the batch instead of a capacity check per record.
+void BM_RecordEncodeMany(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    bpw::Writer out(TradeLayout::serialized_size(trades));
+    for (auto _ : state) {
+        out.clear();
+        benchmark::DoNotOptimize(TradeLayout::write_many(out, trades));
+    }
+    report(state, trades.size() * TradeLayout::size, trades.size());
+}
+BENCHMARK(BM_RecordEncodeMany);
+
+// Variable-length messages (a Trade, a varint length and a 0-64 byte note)
+// encoded into a fresh writer: grown on demand and checked on every write,
+// against sized up front and written unchecked.
+struct Message {
+    Trade trade;
+    std::span<const uint8_t> note;
+};
+
+std::vector<Message> make_messages(const std::vector<Trade>& trades, const std::vector<uint8_t>& notes) {
+    std::mt19937 rng(9);
+    std::vector<Message> v;
+    v.reserve(trades.size());
+    for (const Trade& t : trades) v.push_back(Message{t, {notes.data(), rng() % 65}});
+    return v;
+}
+
+void BM_MessageEncodeGrowing(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const auto notes = random_bytes(64);
+    const auto messages = make_messages(trades, notes);
+    size_t bytes = 0;
+    for (auto _ : state) {
+        bpw::Writer out;
+        for (const Message& m : messages) {
+            (void)TradeLayout::write(out, m.trade);
+            (void)bpw::write_varint(out, m.note.size());
+            (void)out.write_bytes(m.note);
+        }
+        bytes = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    report(state, bytes, messages.size());
+}
+BENCHMARK(BM_MessageEncodeGrowing);
+
+void BM_MessageEncodeExact(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const auto notes = random_bytes(64);
+    const auto messages = make_messages(trades, notes);
+    bpw::Writer out;
+    size_t bytes = 0;
+    for (auto _ : state) {
+        const Message* m = nullptr;
+        auto enc = [&](auto& w) {
+            w.write_record(TradeLayout{}, m->trade);
+            w.write_varint(m->note.size());
+            w.write_bytes(m->note);
+        };
+        size_t total = 0;
+        for (const Message& msg : messages) {
+            m = &msg;
+            total += bpw::serialized_size(enc);
+        }
+        out.clear();
+        bpw::UncheckedWriter w(out.prepare(total), total);
+        for (const Message& msg : messages) {
+            m = &msg;
+            enc(w);
+        }
+        out.commit(total);
+        bytes = out.size();
+        benchmark::DoNotOptimize(out.data());
+    }
+    report(state, bytes, messages.size());
+}
+BENCHMARK(BM_MessageEncodeExact);
+
+void BM_RecordDecode(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    bpw::Writer enc;
+    for (const Trade& t : trades) (void)TradeLayout::write(enc, t);
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        Trade t;
+        uint64_t acc = 0;
+        while (TradeLayout::parse(r, t) == bpw::Status::ok) acc += checksum(t);
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, enc.size(), trades.size());
+}
+BENCHMARK(BM_RecordDecode);
+
+void BM_RecordRoundTrip(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    bpw::Writer out(trades.size() * TradeLayout::size);
+    for (auto _ : state) {
+        out.clear();
+        for (const Trade& t : trades) (void)TradeLayout::write(out, t);
+        bpw::Reader r(out.data(), out.size());
+        Trade t;
+        uint64_t acc = 0;
+        while (TradeLayout::parse(r, t) == bpw::Status::ok) acc += checksum(t);
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, 2 * trades.size() * TradeLayout::size, trades.size());
+}
+BENCHMARK(BM_RecordRoundTrip);
+
+// TradeLayout described at run time, to compare the compiled op program
+// with the fully inlined compile-time layout.
+bpw::RuntimeLayout runtime_trade_layout() {
+    using bpw::FieldKind;
+    const bpw::RuntimeField fields[] = {
+        {FieldKind::unsigned_int,  0, 5, bpw::Endian::big, offsetof(Trade, timestamp), 8},
+        {FieldKind::unsigned_int,  5, 4, bpw::Endian::big, offsetof(Trade, instrument), 4},
+        {FieldKind::signed_int,    9, 4, bpw::Endian::big, offsetof(Trade, price), 4},
+        {FieldKind::unsigned_int, 13, 4, bpw::Endian::big, offsetof(Trade, quantity), 4},
+        {FieldKind::unsigned_int, 17, 2, bpw::Endian::big, offsetof(Trade, venue), 2},
+        {FieldKind::unsigned_int, 19, 1, bpw::Endian::big, offsetof(Trade, side), 1},
+        {FieldKind::boolean,      20, 1, bpw::Endian::big, offsetof(Trade, aggressor), 1},
+    };
+    bpw::RuntimeLayout layout;
+    (void)bpw::RuntimeLayout::compile(fields, sizeof(Trade), layout);
+    return layout;
+}
+
+void BM_RuntimeRecordEncode(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const auto layout = runtime_trade_layout();
+    bpw::Writer out(trades.size() * layout.size());
+    for (auto _ : state) {
+        out.clear();
+        for (const Trade& t : trades) benchmark::DoNotOptimize(layout.write(out, &t));
+    }
+    report(state, trades.size() * layout.size(), trades.size());
+}
+BENCHMARK(BM_RuntimeRecordEncode);
+
+void BM_RuntimeRecordDecode(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const auto layout = runtime_trade_layout();
+    bpw::Writer enc;
+    for (const Trade& t : trades) (void)layout.write(enc, &t);
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        Trade t;
+        uint64_t acc = 0;
+        while (layout.parse(r, &t) == bpw::Status::ok) acc += checksum(t);
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, enc.size(), trades.size());
+}
+BENCHMARK(BM_RuntimeRecordDecode);
+
+// Startup cost per layout: compiling, a cache hit, and loading a saved cache.
+std::vector<bpw::RuntimeField> trade_fields() {
+    const bpw::RuntimeLayout layout = runtime_trade_layout();
+    return {layout.fields().begin(), layout.fields().end()};
+}
+
+void BM_LayoutCompile(benchmark::State& state) {
+    const auto fields = trade_fields();
+    for (auto _ : state) {
+        bpw::RuntimeLayout layout;
+        benchmark::DoNotOptimize(bpw::RuntimeLayout::compile(fields, sizeof(Trade), layout));
+    }
+}
+BENCHMARK(BM_LayoutCompile);
+
+void BM_LayoutCacheHit(benchmark::State& state) {
+    const auto fields = trade_fields();
+    bpw::LayoutCache cache;
+    const bpw::RuntimeLayout* layout;
+    (void)cache.get(fields, sizeof(Trade), layout);
+    for (auto _ : state) benchmark::DoNotOptimize(cache.get(fields, sizeof(Trade), layout));
+}
+BENCHMARK(BM_LayoutCacheHit);
+
+// Arg: layouts in the saved cache; reported per layout.
+void BM_LayoutCacheLoad(benchmark::State& state) {
+    auto fields = trade_fields();
+    bpw::LayoutCache cache;
+    const bpw::RuntimeLayout* layout;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        // Distinct schemas: vary the target size.
+        (void)cache.get(fields, sizeof(Trade) + static_cast<size_t>(i), layout);
+    }
+    bpw::Writer saved;
+    (void)cache.serialize(saved);
+    for (auto _ : state) {
+        bpw::LayoutCache warm;
+        benchmark::DoNotOptimize(warm.deserialize(bpw::Reader(saved.data(), saved.size())));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LayoutCacheLoad)->Arg(100);
+
+// Length-prefixed frames: a 4-byte big-endian length, then a Trade and a
+// 0-64 byte payload.
+bpw::Writer encode_framed_trades(const std::vector<Trade>& trades) {
+    std::mt19937 rng(5);
+    bpw::Writer enc;
+    const auto payload = random_bytes(64);
+    for (const Trade& t : trades) {
+        size_t extra = rng() % 65;
+        (void)enc.write_be<uint32_t>(static_cast<uint32_t>(TradeLayout::size + extra));
+        (void)TradeLayout::write(enc, t);
+        (void)enc.write_bytes(payload.data(), extra);
+    }
+    return enc;
+}
+
+const bpw::Framing trade_framing = bpw::Framing::length_prefixed(4, 0, 4, bpw::Endian::big, 1 << 16);
+
+// Framing plus decode.
+void BM_FramedRecordDecode(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const bpw::Writer enc = encode_framed_trades(trades);
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        bpw::Reader rec;
+        Trade t;
+        uint64_t acc = 0;
+        while (trade_framing.next(r, rec) == bpw::Status::ok) {
+            (void)rec.skip(4);
+            if (TradeLayout::parse(rec, t) == bpw::Status::ok) acc += checksum(t);
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, enc.size(), trades.size());
+}
+BENCHMARK(BM_FramedRecordDecode);
+
+// Hand-written field-by-field decoders of the framed records: every read
+// checked by Reader, against one check per frame with UncheckedReader.
+void BM_FieldDecodeChecked(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const bpw::Writer enc = encode_framed_trades(trades);
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        bpw::Reader rec;
+        uint64_t acc = 0;
+        while (trade_framing.next(r, rec) == bpw::Status::ok) {
+            Trade t;
+            uint8_t hi, aggressor;
+            uint32_t lo;
+            if (rec.skip(4) != bpw::Status::ok || rec.read_u8(hi) != bpw::Status::ok ||
+                rec.read_be(lo) != bpw::Status::ok || rec.read_be(t.instrument) != bpw::Status::ok ||
+                rec.read_be(t.price) != bpw::Status::ok || rec.read_be(t.quantity) != bpw::Status::ok ||
+                rec.read_be(t.venue) != bpw::Status::ok || rec.read_u8(t.side) != bpw::Status::ok ||
+                rec.read_u8(aggressor) != bpw::Status::ok)
+                break;
+            t.timestamp = uint64_t{hi} << 32 | lo;
+            t.aggressor = aggressor != 0;
+            acc += checksum(t);
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, enc.size(), trades.size());
+}
+BENCHMARK(BM_FieldDecodeChecked);
+
+void BM_FieldDecodeUnchecked(benchmark::State& state) {
+    const auto trades = make_trades(record_count);
+    const bpw::Writer enc = encode_framed_trades(trades);
+    for (auto _ : state) {
+        bpw::Reader r(enc.data(), enc.size());
+        bpw::UncheckedReader rec;
+        uint64_t acc = 0;
+        while (bpw::next_unchecked(r, trade_framing, 4 + TradeLayout::size, rec) == bpw::Status::ok) {
+            Trade t;
+            rec.skip(4);
+            uint64_t hi = rec.read_u8();
+            t.timestamp = hi << 32 | rec.read_be<uint32_t>();
+            t.instrument = rec.read_be<uint32_t>();
+            t.price = rec.read_be<int32_t>();
+            t.quantity = rec.read_be<uint32_t>();
+            t.venue = rec.read_be<uint16_t>();
+            t.side = rec.read_u8();
+            t.aggressor = rec.read_u8() != 0;
+            acc += checksum(t);
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+    report(state, enc.size(), trades.size());
+}
+BENCHMARK(BM_FieldDecodeUnchecked);
+
+}  // namespace
+
+BENCHMARK_MAIN();
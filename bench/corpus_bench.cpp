@@ -0,0 +1,500 @@
+// Corpus-driven throughput regression harness.
+//
+//   g++ -std=c++20 -O2 -Iinclude bench/corpus_bench.cpp src/*.cpp -lpthread -o corpus_bench
+//   ./corpus_bench --generate corpus/               # synthetic corpora
+//   ./corpus_bench --corpus corpus/ --baseline bench/corpus_baseline.json
+//   ./corpus_bench --corpus corpus/ --baseline bench/corpus_baseline.json --update
+//
+// Every regular file in the corpus directory is a stream of frames: a 4-byte
+// big-endian payload length, then a payload of typed fields, each a type
+// byte followed by its value:
+//
+//   0 u8   1 u16 BE   2 u32 BE   3 u64 BE   4 varint   5 zigzag varint
+//   6 bytes (varint length, then the bytes)
+//
+// Frames are decoded field by field ("parse") and re-encoded from the
+// decoded values ("write"), so throughput depends on the corpus's mix of
+// field widths and message sizes rather than on one synthetic record.
+// Parsing CRC-32Cs every `bytes` payload, so payload-heavy corpora measure
+// reading the payload rather than skipping it. Each workload runs --repeat
+// times and the fastest run counts. Peak RSS is the VmHWM of the process,
+// reset before each corpus.
+//
+// The run fails (exit status 1) if any corpus is more than --max-slowdown
+// (a fraction, default 0.10) below its baseline throughput, or its peak RSS
+// grew by more than --max-rss-growth (default 0.25). --update rewrites the
+// baseline from this run instead. Baselines are only comparable on the
+// machine they were recorded on; record them on the CI host. An entry
+// with "placeholder": 1 (as in the committed bench/corpus_baseline.json,
+// recorded on a development machine) gates with wide tolerances instead:
+// it fails only past a 50% slowdown or a doubled peak RSS, which catches
+// gross regressions on any reasonable host without flagging the machine
+// difference.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "bpw/crc32c.hpp"
+#include "bpw/file_source.hpp"
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+#include "bpw/varint.hpp"
+#include "bpw/writer.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr auto framing = bpw::Framing::length_prefixed(4, 0, 4, bpw::Endian::big, size_t{64} << 20);
+
+enum FieldType : uint8_t { u8, u16, u32, u64, varint, svarint, bytes, type_count };
+
+struct Field {
+    FieldType type;
+    uint64_t value;
+    std::span<const uint8_t> data;  // for `bytes`
+};
+
+// ---------------------------------------------------------------- workloads
+
+bpw::Status parse_field(bpw::Reader& in, Field& f) noexcept {
+    uint8_t type;
+    if (bpw::Status s = in.read_u8(type); s != bpw::Status::ok) return s;
+    if (type >= type_count) return bpw::Status::malformed;
+    f.type = static_cast<FieldType>(type);
+    switch (f.type) {
+    case u8: {
+        uint8_t v = 0;
+        bpw::Status s = in.read_u8(v);
+        f.value = v;
+        return s;
+    }
+    case u16: {
+        uint16_t v = 0;
+        bpw::Status s = in.read_be(v);
+        f.value = v;
+        return s;
+    }
+    case u32: {
+        uint32_t v = 0;
+        bpw::Status s = in.read_be(v);
+        f.value = v;
+        return s;
+    }
+    case u64: return in.read_be(f.value);
+    case varint: return bpw::read_varint(in, f.value);
+    case svarint: {
+        int64_t v = 0;
+        bpw::Status s = bpw::read_svarint(in, v);
+        f.value = static_cast<uint64_t>(v);
+        return s;
+    }
+    case bytes:
+        if (bpw::Status s = bpw::read_varint(in, f.value); s != bpw::Status::ok) return s;
+        if (f.value > in.remaining()) return bpw::Status::out_of_bounds;
+        return in.read_bytes(static_cast<size_t>(f.value), f.data);
+    default: return bpw::Status::malformed;
+    }
+}
+
+bpw::Status write_field(bpw::Writer& out, const Field& f) noexcept {
+    if (bpw::Status s = out.write_u8(f.type); s != bpw::Status::ok) return s;
+    switch (f.type) {
+    case u8: return out.write_u8(static_cast<uint8_t>(f.value));
+    case u16: return out.write_be(static_cast<uint16_t>(f.value));
+    case u32: return out.write_be(static_cast<uint32_t>(f.value));
+    case u64: return out.write_be(f.value);
+    case varint: return bpw::write_varint(out, f.value);
+    case svarint: return bpw::write_svarint(out, static_cast<int64_t>(f.value));
+    case bytes:
+        if (bpw::Status s = bpw::write_varint(out, f.data.size()); s != bpw::Status::ok) return s;
+        return out.write_bytes(f.data);
+    default: return bpw::Status::invalid_argument;
+    }
+}
+
+// Decode every frame; `sink` defeats dead-code elimination.
+bpw::Status parse_corpus(bpw::Reader in, size_t& records, uint64_t& sink) noexcept {
+    bpw::Reader frame;
+    bpw::Status s;
+    records = 0;
+    while ((s = framing.next(in, frame)) == bpw::Status::ok) {
+        if ((s = frame.skip(framing.header_size)) != bpw::Status::ok) return s;
+        Field f;
+        while (!frame.empty()) {
+            if ((s = parse_field(frame, f)) != bpw::Status::ok) return s;
+            // Checksum payloads so that `bytes` fields cost a read of the
+            // bytes, not just a skip over them.
+            sink += f.type == bytes ? bpw::crc32c(f.data.data(), f.data.size()) : f.value;
+        }
+        ++records;
+    }
+    return in.empty() ? bpw::Status::ok : s;
+}
+
+// Decoded form of a corpus, built once so the write timing excludes parsing.
+struct Decoded {
+    std::vector<Field> fields;
+    std::vector<size_t> record_end;  // one past each record's last field
+};
+
+bpw::Status decode_all(bpw::Reader in, Decoded& out) {
+    bpw::Reader frame;
+    bpw::Status s;
+    while ((s = framing.next(in, frame)) == bpw::Status::ok) {
+        if ((s = frame.skip(framing.header_size)) != bpw::Status::ok) return s;
+        Field f;
+        while (!frame.empty()) {
+            if ((s = parse_field(frame, f)) != bpw::Status::ok) return s;
+            out.fields.push_back(f);
+        }
+        out.record_end.push_back(out.fields.size());
+    }
+    return in.empty() ? bpw::Status::ok : s;
+}
+
+bpw::Status write_corpus(const Decoded& d, bpw::Writer& out) noexcept {
+    out.clear();
+    size_t first = 0;
+    for (size_t end : d.record_end) {
+        size_t header = out.size();
+        if (bpw::Status s = out.write_be<uint32_t>(0); s != bpw::Status::ok) return s;
+        for (size_t i = first; i < end; ++i)
+            if (bpw::Status s = write_field(out, d.fields[i]); s != bpw::Status::ok) return s;
+        bpw::store_be<uint32_t>(out.data() + header, static_cast<uint32_t>(out.size() - header - 4));
+        first = end;
+    }
+    return bpw::Status::ok;
+}
+
+// ---------------------------------------------------------------- measurement
+
+// Peak resident set in KiB since the last reset_peak_rss().
+long peak_rss_kb() {
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind("VmHWM:", 0) == 0) return std::strtol(line.c_str() + 6, nullptr, 10);
+    }
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+}
+
+void reset_peak_rss() {
+    // "5" resets VmHWM to the current RSS (Linux 4.0+); ignored elsewhere.
+    if (FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", f);
+        std::fclose(f);
+    }
+}
+
+template <class F>
+double best_seconds(unsigned repeat, F&& run) {
+    double best = 1e300;
+    for (unsigned i = 0; i < repeat; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (!run()) return -1;
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        best = std::min(best, dt.count());
+    }
+    return best;
+}
+
+// Written once per corpus so the parse loop cannot be optimised away.
+volatile uint64_t result_sink;
+
+struct Result {
+    double parse_mb_s = 0;
+    double write_mb_s = 0;
+    double records_per_s = 0;
+    long peak_rss_kb = 0;
+};
+
+bool run_corpus(const fs::path& path, unsigned repeat, Result& r) {
+    reset_peak_rss();
+    bpw::FileSource file;
+    bpw::Reader in;
+    if (bpw::FileSource::open(path.c_str(), file) != bpw::Status::ok || file.reader(in) != bpw::Status::ok) {
+        std::fprintf(stderr, "%s: cannot map file\n", path.c_str());
+        return false;
+    }
+    const double mb = static_cast<double>(in.size()) / 1e6;
+
+    size_t records = 0;
+    uint64_t sink = 0;
+    bpw::Status status = bpw::Status::ok;
+    double parse_s = best_seconds(repeat, [&] { return (status = parse_corpus(in, records, sink)) == bpw::Status::ok; });
+    if (parse_s < 0) {
+        std::fprintf(stderr, "%s: parse failed: %s\n", path.c_str(), bpw::to_string(status));
+        return false;
+    }
+
+    Decoded decoded;
+    if ((status = decode_all(in, decoded)) != bpw::Status::ok) return false;
+    bpw::Writer out(in.size());
+    double write_s = best_seconds(repeat, [&] { return (status = write_corpus(decoded, out)) == bpw::Status::ok; });
+    if (write_s < 0 || out.size() != in.size()) {
+        std::fprintf(stderr, "%s: write failed: %s\n", path.c_str(), bpw::to_string(status));
+        return false;
+    }
+
+    r.parse_mb_s = mb / parse_s;
+    r.write_mb_s = mb / write_s;
+    r.records_per_s = static_cast<double>(records) / parse_s;
+    r.peak_rss_kb = peak_rss_kb();
+    result_sink = sink;
+    return true;
+}
+
+// ---------------------------------------------------------------- baseline file
+
+// The baseline is a flat JSON object of objects of numbers:
+//   { "corpus.bin": { "parse_mb_s": 812.5, "write_mb_s": 640.1, ... }, ... }
+// and is read by the matching minimal parser below.
+using Baseline = std::map<std::string, std::map<std::string, double>>;
+
+struct JsonIn {
+    const char* p;
+    const char* end;
+
+    void ws() {
+        while (p < end && std::strchr(" \t\r\n", *p)) ++p;
+    }
+    bool eat(char c) {
+        ws();
+        if (p < end && *p == c) {
+            ++p;
+            return true;
+        }
+        return false;
+    }
+    bool string(std::string& out) {
+        if (!eat('"')) return false;
+        out.clear();
+        while (p < end && *p != '"') {
+            if (*p == '\\' && p + 1 < end) ++p;
+            out += *p++;
+        }
+        return eat('"');
+    }
+    bool number(double& out) {
+        ws();
+        char* stop;
+        out = std::strtod(p, &stop);
+        if (stop == p) return false;
+        p = stop;
+        return true;
+    }
+};
+
+bool read_baseline(const fs::path& path, Baseline& out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::stringstream ss;
+    ss << f.rdbuf();
+    const std::string text = ss.str();
+    JsonIn in{text.data(), text.data() + text.size()};
+    if (!in.eat('{')) return false;
+    if (in.eat('}')) return true;
+    do {
+        std::string name;
+        if (!in.string(name) || !in.eat(':') || !in.eat('{')) return false;
+        auto& metrics = out[name];
+        if (in.eat('}')) continue;
+        do {
+            std::string key;
+            double v;
+            if (!in.string(key) || !in.eat(':') || !in.number(v)) return false;
+            metrics[key] = v;
+        } while (in.eat(','));
+        if (!in.eat('}')) return false;
+    } while (in.eat(','));
+    return in.eat('}');
+}
+
+bool write_baseline(const fs::path& path, const std::map<std::string, Result>& results) {
+    std::ofstream f(path);
+    f << "{\n";
+    size_t i = 0;
+    for (const auto& [name, r] : results) {
+        char line[512];
+        std::snprintf(line, sizeof line,
+                      "  \"%s\": { \"parse_mb_s\": %.1f, \"write_mb_s\": %.1f, \"records_per_s\": %.0f, "
+                      "\"peak_rss_kb\": %ld }%s\n",
+                      name.c_str(), r.parse_mb_s, r.write_mb_s, r.records_per_s, r.peak_rss_kb,
+                      ++i < results.size() ? "," : "");
+        f << line;
+    }
+    f << "}\n";
+    return static_cast<bool>(f);
+}
+
+// ---------------------------------------------------------------- generator
+
+struct Mix {
+    const char* name;
+    size_t min_fields, max_fields;
+    unsigned weights[type_count];  // relative frequency of each field type
+    size_t max_blob;
+};
+
+// Frame size and field-width mixes modelled on telemetry, order-book and
+// bulk-transfer traffic.
+constexpr Mix mixes[] = {
+    {"small_messages.bin", 2, 8, {4, 4, 2, 1, 6, 3, 0}, 0},
+    {"mixed_records.bin", 8, 48, {3, 3, 4, 3, 4, 2, 1}, 256},
+    {"large_payloads.bin", 1, 4, {1, 1, 1, 1, 1, 0, 4}, 16384},
+};
+
+bool generate(const fs::path& dir, size_t bytes_per_corpus) {
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    std::mt19937_64 rng(42);
+    for (const Mix& m : mixes) {
+        std::discrete_distribution<int> pick(std::begin(m.weights), std::end(m.weights));
+        std::vector<uint8_t> blob(m.max_blob ? m.max_blob : 1);
+        for (auto& b : blob) b = static_cast<uint8_t>(rng());
+        bpw::Writer out(bytes_per_corpus + (size_t{1} << 16));
+        while (out.size() < bytes_per_corpus) {
+            size_t header = out.size();
+            (void)out.write_be<uint32_t>(0);
+            size_t n = m.min_fields + rng() % (m.max_fields - m.min_fields + 1);
+            for (size_t i = 0; i < n; ++i) {
+                Field f{static_cast<FieldType>(pick(rng)), rng() >> (rng() % 64), {}};
+                if (f.type == bytes) f.data = {blob.data(), static_cast<size_t>(rng() % (m.max_blob + 1))};
+                (void)write_field(out, f);
+            }
+            bpw::store_be<uint32_t>(out.data() + header, static_cast<uint32_t>(out.size() - header - 4));
+        }
+        std::ofstream f(dir / m.name, std::ios::binary);
+        f.write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(out.size()));
+        if (!f) return false;
+        std::printf("wrote %s (%zu bytes)\n", (dir / m.name).c_str(), out.size());
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------- main
+
+int usage() {
+    std::fputs("usage: corpus_bench --corpus DIR --baseline FILE [--update] [--repeat N]\n"
+               "                    [--max-slowdown F] [--max-rss-growth F]\n"
+               "       corpus_bench --generate DIR [--size BYTES]\n",
+               stderr);
+    return 2;
+}
+
+// Tolerances for "placeholder" baseline entries, recorded on another machine.
+constexpr double placeholder_slowdown = 0.50;
+constexpr double placeholder_rss_growth = 1.00;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    fs::path corpus, baseline_path, generate_dir;
+    bool update = false;
+    unsigned repeat = 5;
+    double max_slowdown = 0.10, max_rss_growth = 0.25;
+    size_t generate_size = size_t{16} << 20;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--corpus" && has_value) corpus = argv[++i];
+        else if (a == "--baseline" && has_value) baseline_path = argv[++i];
+        else if (a == "--generate" && has_value) generate_dir = argv[++i];
+        else if (a == "--size" && has_value) generate_size = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--repeat" && has_value) repeat = static_cast<unsigned>(std::max(1L, std::strtol(argv[++i], nullptr, 10)));
+        else if (a == "--max-slowdown" && has_value) max_slowdown = std::strtod(argv[++i], nullptr);
+        else if (a == "--max-rss-growth" && has_value) max_rss_growth = std::strtod(argv[++i], nullptr);
+        else if (a == "--update") update = true;
+        else return usage();
+    }
+
+    if (!generate_dir.empty()) return generate(generate_dir, generate_size) ? 0 : 2;
+    if (corpus.empty() || baseline_path.empty()) return usage();
+
+    std::vector<fs::path> files;
+    std::error_code ec;
+    for (const auto& e : fs::directory_iterator(corpus, ec))
+        if (e.is_regular_file() && e.file_size() > 0) files.push_back(e.path());
+    if (ec || files.empty()) {
+        std::fprintf(stderr, "%s: no corpus files\n", corpus.c_str());
+        return 2;
+    }
+    std::sort(files.begin(), files.end());
+
+    std::map<std::string, Result> results;
+    for (const auto& path : files) {
+        Result r;
+        if (!run_corpus(path, repeat, r)) return 2;
+        results[path.filename().string()] = r;
+    }
+
+    if (update) {
+        if (!write_baseline(baseline_path, results)) {
+            std::fprintf(stderr, "%s: cannot write baseline\n", baseline_path.c_str());
+            return 2;
+        }
+        std::printf("baseline written to %s\n", baseline_path.c_str());
+        return 0;
+    }
+
+    Baseline baseline;
+    if (!read_baseline(baseline_path, baseline)) {
+        std::fprintf(stderr, "%s: cannot read baseline (record one with --update)\n", baseline_path.c_str());
+        return 2;
+    }
+
+    bool failed = false;
+    std::printf("%-24s %12s %12s %14s %12s\n", "corpus", "parse MB/s", "write MB/s", "records/s", "peak RSS KiB");
+    for (const auto& [name, r] : results) {
+        std::printf("%-24s %12.1f %12.1f %14.0f %12ld\n", name.c_str(), r.parse_mb_s, r.write_mb_s,
+                    r.records_per_s, r.peak_rss_kb);
+        auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::printf("  (no baseline)\n");
+            continue;
+        }
+        auto& b = it->second;
+        const bool placeholder = b.count("placeholder") && b.at("placeholder") != 0;
+        const double slowdown = placeholder ? std::max(max_slowdown, placeholder_slowdown) : max_slowdown;
+        const double rss_growth = placeholder ? std::max(max_rss_growth, placeholder_rss_growth) : max_rss_growth;
+        if (placeholder)
+            std::printf("  (placeholder baseline, gating at -%.0f%% / +%.0f%% RSS)\n", 100 * slowdown, 100 * rss_growth);
+        auto check_rate = [&](const char* key, double now) {
+            auto m = b.find(key);
+            if (m == b.end() || m->second <= 0) return;
+            double change = now / m->second - 1;
+            if (change < -slowdown) {
+                std::printf("  REGRESSION %s: %.1f vs baseline %.1f (%+.1f%%)\n", key, now, m->second, 100 * change);
+                failed = true;
+            }
+        };
+        check_rate("parse_mb_s", r.parse_mb_s);
+        check_rate("write_mb_s", r.write_mb_s);
+        if (auto m = b.find("peak_rss_kb"); m != b.end() && m->second > 0) {
+            double growth = static_cast<double>(r.peak_rss_kb) / m->second - 1;
+            if (growth > rss_growth) {
+                std::printf("  REGRESSION peak_rss_kb: %ld vs baseline %.0f (%+.1f%%)\n", r.peak_rss_kb, m->second,
+                            100 * growth);
+                failed = true;
+            }
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,431 @@
+// libFuzzer target for the reader and the format layer that also watches
+// what each input costs.
+//
+//   clang++ -std=c++20 -O1 -g -fsanitize=fuzzer,address,undefined -Iinclude fuzz/bpw_fuzz.cpp src/*.cpp -lpthread -o bpw_fuzz
+//   ./bpw_fuzz -max_len=65536 corpus/
+//
+// Without libFuzzer (g++), BPW_FUZZ_STANDALONE adds a main() that replays
+// files and directories, e.g. crash artifacts or a corpus in CI:
+//
+//   g++ -std=c++20 -O1 -g -fsanitize=address,undefined -DBPW_FUZZ_STANDALONE -Iinclude fuzz/bpw_fuzz.cpp src/*.cpp -lpthread -o bpw_fuzz
+//   ./bpw_fuzz corpus/
+//   BPW_FUZZ_SLOWEST= ./bpw_fuzz slowest-per-byte   # replay the saved slowest input
+//
+// The first input byte picks a target and the rest is its input:
+//
+//   frames        Framing::next, RecordTable::build and a walk of frames
+//                 nested inside frame payloads, up to max_depth levels
+//   stream        StreamParser fed in uneven chunks, checked against next()
+//   varints       read_varints / read_svarint over the whole input
+//   delta         read_delta with a declared count, then a round trip
+//   layout        RuntimeLayout::load, then parse every record that follows
+//   layout_cache  LayoutCache::deserialize
+//   offset_index  OffsetIndex::deserialize and serialize round trip
+//   block         BlockHeader::decode and decompress_block
+//
+// Crashes are only half of it: a hostile peer can also stall a worker with
+// a message that is valid enough to keep a decoder busy, through a huge
+// declared count, lengths nested in lengths, or a saved program that
+// visits the same bytes over and over. Every decoder here should be linear
+// in its input, so each input runs against a linear budget:
+//
+//   time    BPW_FUZZ_NS_PER_BYTE (default 20000) ns per byte, plus 1 ms
+//   memory  BPW_FUZZ_MEM_PER_BYTE (default 2048) bytes allocated at peak
+//           per byte, plus 1 MiB
+//
+// Time is the best of three runs, so a descheduled run is not reported.
+// An input over budget is printed and abort()s, which makes libFuzzer keep
+// it as a crash artifact; because libFuzzer keeps growing inputs, any
+// superlinear path eventually crosses a linear budget. The largest memory
+// amplification the targets allow legitimately is the delta column (up to
+// 64 values per encoded byte, decoded twice), about 1.5 KiB per byte.
+//
+// Independently of the budget, the slowest input per byte seen so far is
+// reported on stderr and saved to $BPW_FUZZ_SLOWEST (default
+// "slowest-per-byte"; set it empty to disable), which is the input to
+// look at when a decoder regresses without crossing the budget.
+//
+// Allocation is measured with the sanitizer malloc hooks, so it is only
+// tracked in ASan builds; other builds budget time alone.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "bpw/compression.hpp"
+#include "bpw/crc32c.hpp"
+#include "bpw/delta.hpp"
+#include "bpw/framing.hpp"
+#include "bpw/layout_cache.hpp"
+#include "bpw/offset_index.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/record_table.hpp"
+#include "bpw/runtime_layout.hpp"
+#include "bpw/status.hpp"
+#include "bpw/stream_parser.hpp"
+#include "bpw/varint.hpp"
+#include "bpw/writer.hpp"
+
+extern "C" {
+__attribute__((weak)) int __sanitizer_install_malloc_and_free_hooks(void (*)(const volatile void*, size_t),
+                                                                    void (*)(const volatile void*));
+__attribute__((weak)) size_t __sanitizer_get_allocated_size(const volatile void*);
+}
+
+namespace {
+
+using bpw::Reader;
+using bpw::Status;
+
+// Frames larger than this are malformed; bounds the StreamParser carry
+// buffer and the decompressed block size.
+constexpr size_t max_frame = size_t{64} << 10;
+constexpr unsigned max_depth = 16;
+
+// Invariant violations are bugs, not slow inputs.
+#define BPW_FUZZ_CHECK(cond)                                                                     \
+    do {                                                                                         \
+        if (!(cond)) {                                                                           \
+            std::fprintf(stderr, "bpw_fuzz: check failed: %s (%s:%d)\n", #cond, __FILE__, __LINE__); \
+            std::abort();                                                                        \
+        }                                                                                        \
+    } while (0)
+
+// ---------------------------------------------------------------- targets
+
+enum Target : uint8_t { frames, stream, varints, delta, layout, layout_cache, offset_index, block, target_count };
+
+const char* const target_names[target_count] = {"frames", "stream",       "varints",      "delta",
+                                                "layout", "layout_cache", "offset_index", "block"};
+
+// Two config bytes pick the framing: a fixed size, or a 1/2/4/8-byte
+// length of either byte order somewhere in a header of up to 14 bytes.
+bool take_framing(Reader& in, bpw::Framing& f) {
+    uint8_t a, b;
+    if (in.read_u8(a) != Status::ok || in.read_u8(b) != Status::ok) return false;
+    if (a & 0x80) {
+        f = bpw::Framing::fixed(size_t{b} + 1);
+        return true;
+    }
+    const auto width = static_cast<uint8_t>(1u << (a & 3));
+    const size_t offset = (a >> 2) & 3;
+    const size_t header = offset + width + ((a >> 4) & 3);
+    f = bpw::Framing::length_prefixed(header, offset, width, (b & 1) ? bpw::Endian::little : bpw::Endian::big,
+                                      max_frame);
+    return true;
+}
+
+// Records next() splits off before the first error.
+size_t count_frames(Reader in, const bpw::Framing& f, Status& s) {
+    size_t n = 0;
+    Reader rec;
+    while (!in.empty() && (s = f.next(in, rec)) == Status::ok) ++n;
+    if (in.empty()) s = Status::ok;
+    return n;
+}
+
+// Frames whose payloads are framed streams themselves. Every level
+// re-reads the bytes of the level above, so the walk costs depth times the
+// input; a decoder for nested formats must bound the depth like this.
+void walk_nested(Reader in, const bpw::Framing& f, unsigned depth) {
+    Reader rec;
+    while (f.next(in, rec) == Status::ok) {
+        if (depth + 1 < max_depth && rec.remaining() > f.header_size && !f.fixed_size)
+            walk_nested(Reader(rec.data() + f.header_size, rec.remaining() - f.header_size), f, depth + 1);
+    }
+}
+
+void run_frames(Reader in) {
+    bpw::Framing f;
+    if (!take_framing(in, f)) return;
+    Status s;
+    const size_t n = count_frames(in, f, s);
+    bpw::RecordTable table;
+    if (bpw::RecordTable::build(in, f, table) == Status::ok) {
+        BPW_FUZZ_CHECK(s == Status::ok && table.size() == n && table.bytes() == in.remaining());
+        Reader rec;
+        if (n) BPW_FUZZ_CHECK(table.record(in, n - 1, rec) == Status::ok);
+    }
+    walk_nested(in, f, 0);
+}
+
+void run_stream(Reader in) {
+    bpw::Framing f;
+    uint8_t seed;
+    if (!take_framing(in, f) || in.read_u8(seed) != Status::ok) return;
+    Status s;
+    const size_t expected = count_frames(in, f, s);
+
+    bpw::StreamParser parser(f);
+    if (parser.status() != Status::ok) return;
+    size_t n = 0;
+    uint32_t x = seed | 0x100u;
+    std::span<const uint8_t> rest = in.rest();
+    while (!rest.empty()) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        const size_t chunk = std::min<size_t>(rest.size(), 1 + x % 97);
+        Status fs = parser.feed(rest.first(chunk), [&n](Reader&) {
+            ++n;
+            return Status::ok;
+        });
+        if (fs != Status::ok) break;
+        rest = rest.subspan(chunk);
+    }
+    BPW_FUZZ_CHECK(n == expected);
+}
+
+void run_varints(Reader in) {
+    uint8_t mode;
+    if (in.read_u8(mode) != Status::ok) return;
+    uint64_t v64[64];
+    uint32_t v32[64];
+    int64_t sv;
+    while (!in.empty()) {
+        const size_t k = std::min<size_t>(64, in.remaining());
+        Status s;
+        switch (mode % 3) {
+        case 0: s = bpw::read_varints(in, v64, k); break;
+        case 1: s = bpw::read_varints(in, v32, k); break;
+        default: s = bpw::read_svarint(in, sv); break;
+        }
+        if (s != Status::ok) break;
+    }
+}
+
+template <class T>
+void run_delta_as(Reader& in) {
+    uint64_t count;
+    if (bpw::read_varint(in, count) != Status::ok) return;
+    // The guard a caller needs before trusting a declared count.
+    if (count > bpw::delta_max_count(in.remaining())) return;
+    std::vector<T> values(static_cast<size_t>(count));
+    if (bpw::read_delta(in, values.data(), values.size()) != Status::ok) return;
+
+    bpw::Writer out;
+    BPW_FUZZ_CHECK(bpw::write_delta(out, values.data(), values.size()) == Status::ok);
+    BPW_FUZZ_CHECK(out.size() <= bpw::delta_max_size(values.size()));
+    std::vector<T> again(values.size());
+    Reader back(out.data(), out.size());
+    BPW_FUZZ_CHECK(bpw::read_delta(back, again.data(), again.size()) == Status::ok && back.empty());
+    BPW_FUZZ_CHECK(again == values);
+}
+
+void run_delta(Reader in) {
+    uint8_t mode;
+    if (in.read_u8(mode) != Status::ok) return;
+    if (mode & 1) run_delta_as<uint32_t>(in);
+    else run_delta_as<uint64_t>(in);
+}
+
+void run_layout(Reader in) {
+    const uint8_t* start = in.data();
+    bpw::RuntimeLayout l;
+    if (bpw::RuntimeLayout::load(in, l) != Status::ok) return;
+
+    bpw::Writer saved;
+    BPW_FUZZ_CHECK(l.save(saved) == Status::ok);
+    BPW_FUZZ_CHECK(saved.size() == static_cast<size_t>(in.data() - start));
+    BPW_FUZZ_CHECK(std::memcmp(saved.data(), start, saved.size()) == 0);
+
+    if (l.size() > max_frame || l.target_size() > max_frame) return;
+    std::vector<uint8_t> target(l.target_size());
+    while (l.parse(in, target.data()) == Status::ok) {
+    }
+    bpw::Writer out;
+    BPW_FUZZ_CHECK(l.write(out, target.data()) == Status::ok && out.size() == l.size());
+}
+
+void run_layout_cache(Reader in) {
+    bpw::LayoutCache cache;
+    if (cache.deserialize(in) != Status::ok) return;
+    bpw::Writer out;
+    BPW_FUZZ_CHECK(cache.serialize(out) == Status::ok);
+}
+
+void run_offset_index(Reader in) {
+    bpw::OffsetIndex index;
+    if (bpw::OffsetIndex::deserialize(in, index) != Status::ok) return;
+    bpw::Writer out;
+    BPW_FUZZ_CHECK(index.serialize(out) == Status::ok);
+    BPW_FUZZ_CHECK(out.size() == in.remaining() && std::memcmp(out.data(), in.data(), out.size()) == 0);
+}
+
+void run_block(Reader in) {
+    bpw::BlockHeader h;
+    if (!in.has(bpw::BlockHeader::size) || bpw::BlockHeader::decode(in.data(), h) != Status::ok) return;
+    (void)in.skip(bpw::BlockHeader::size);
+    // As CompressionOptions::max_block_size does for the reader.
+    if (h.raw_size > max_frame || h.stored_size > in.remaining()) return;
+    std::vector<uint8_t> raw(h.raw_size);
+    if (bpw::decompress_block(h.codec, {in.data(), h.stored_size}, raw.data(), raw.size()) != Status::ok) return;
+    (void)bpw::crc32c(raw.data(), raw.size());
+}
+
+void run(const uint8_t* data, size_t size) {
+    if (size == 0) return;
+    Reader in(data + 1, size - 1);
+    switch (data[0] % target_count) {
+    case frames: run_frames(in); break;
+    case stream: run_stream(in); break;
+    case varints: run_varints(in); break;
+    case delta: run_delta(in); break;
+    case layout: run_layout(in); break;
+    case layout_cache: run_layout_cache(in); break;
+    case offset_index: run_offset_index(in); break;
+    case block: run_block(in); break;
+    }
+}
+
+// ---------------------------------------------------------------- cost
+
+std::atomic<int64_t> live_bytes{0};
+std::atomic<int64_t> peak_bytes{0};
+
+void on_malloc(const volatile void*, size_t n) {
+    const int64_t now = live_bytes.fetch_add(static_cast<int64_t>(n), std::memory_order_relaxed) +
+                        static_cast<int64_t>(n);
+    int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+}
+
+void on_free(const volatile void* p) {
+    if (p) live_bytes.fetch_sub(static_cast<int64_t>(__sanitizer_get_allocated_size(p)), std::memory_order_relaxed);
+}
+
+struct Settings {
+    double ns_per_byte = 20000;
+    double mem_per_byte = 2048;
+    const char* slowest_path = "slowest-per-byte";
+    bool track_memory = false;
+
+    Settings() {
+        if (const char* e = std::getenv("BPW_FUZZ_NS_PER_BYTE")) ns_per_byte = std::strtod(e, nullptr);
+        if (const char* e = std::getenv("BPW_FUZZ_MEM_PER_BYTE")) mem_per_byte = std::strtod(e, nullptr);
+        if (const char* e = std::getenv("BPW_FUZZ_SLOWEST")) slowest_path = e;
+        track_memory = __sanitizer_install_malloc_and_free_hooks && __sanitizer_get_allocated_size &&
+                       __sanitizer_install_malloc_and_free_hooks(on_malloc, on_free) != 0;
+    }
+};
+
+constexpr double time_allowance_ns = 1e6;
+constexpr double mem_allowance = double(size_t{1} << 20);
+// Added to the size when ranking inputs per byte, so that the fixed cost of
+// a call does not make the smallest inputs always the slowest.
+constexpr double rank_bytes = 64;
+
+const Settings& settings() {
+    static const Settings s;
+    return s;
+}
+
+struct Cost {
+    double ns = 0;
+    int64_t bytes = 0;  // peak allocation above the level at the start
+};
+
+Cost measure(const uint8_t* data, size_t size) {
+    const int64_t base = live_bytes.load(std::memory_order_relaxed);
+    peak_bytes.store(base, std::memory_order_relaxed);
+    const auto t0 = std::chrono::steady_clock::now();
+    run(data, size);
+    const auto t1 = std::chrono::steady_clock::now();
+    return {std::chrono::duration<double, std::nano>(t1 - t0).count(),
+            peak_bytes.load(std::memory_order_relaxed) - base};
+}
+
+// Re-run an expensive-looking input and keep its cheapest time.
+Cost settle(const uint8_t* data, size_t size, Cost c) {
+    for (int i = 0; i < 2; ++i) c.ns = std::min(c.ns, measure(data, size).ns);
+    return c;
+}
+
+const char* target_name(const uint8_t* data, size_t size) {
+    return size ? target_names[data[0] % target_count] : "empty";
+}
+
+void save_input(const char* path, const uint8_t* data, size_t size) {
+    if (!path || !*path) return;
+    if (std::FILE* f = std::fopen(path, "wb")) {
+        (void)std::fwrite(data, 1, size, f);
+        std::fclose(f);
+    }
+}
+
+double slowest_per_byte = 0;
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const Settings& cfg = settings();
+    Cost c = measure(data, size);
+    const double bytes = static_cast<double>(size);
+
+    const double time_budget = cfg.ns_per_byte * bytes + time_allowance_ns;
+    const double rank = c.ns / (bytes + rank_bytes);
+    if (c.ns > time_budget || rank > slowest_per_byte) c = settle(data, size, c);
+
+    const double per_byte = c.ns / (bytes + rank_bytes);
+    if (per_byte > slowest_per_byte) {
+        slowest_per_byte = per_byte;
+        std::fprintf(stderr, "bpw_fuzz: slowest so far: %.1f ns/byte (%s, %zu bytes, %.0f ns, %lld bytes peak)\n",
+                     per_byte, target_name(data, size), size, c.ns, static_cast<long long>(c.bytes));
+        save_input(cfg.slowest_path, data, size);
+    }
+
+    const bool slow = c.ns > time_budget;
+    const bool big = cfg.track_memory && double(c.bytes) > cfg.mem_per_byte * bytes + mem_allowance;
+    if (slow || big) {
+        std::fprintf(stderr, "bpw_fuzz: %s input over budget (%s, %zu bytes): %.0f ns (budget %.0f), %lld bytes peak\n",
+                     slow ? "slow" : "memory-hungry", target_name(data, size), size, c.ns, time_budget,
+                     static_cast<long long>(c.bytes));
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef BPW_FUZZ_STANDALONE
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+    std::vector<fs::path> files;
+    for (int i = 1; i < argc; ++i) {
+        std::error_code ec;
+        if (fs::is_directory(argv[i], ec)) {
+            for (const auto& e : fs::directory_iterator(argv[i], ec))
+                if (e.is_regular_file()) files.push_back(e.path());
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::fprintf(stderr, "usage: %s FILE|DIR...\n", argv[0]);
+        return 2;
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& path : files) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) {
+            std::fprintf(stderr, "%s: cannot open\n", path.c_str());
+            return 2;
+        }
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        (void)LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    std::printf("%zu inputs, slowest %.1f ns/byte\n", files.size(), slowest_per_byte);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,189 @@
+// Bump-pointer arena for the owned copies of variable-length fields.
+//
+// Strings, blobs and nested arrays decoded out of a message are carved from
+// large blocks with a pointer bump; nothing is freed individually. reset()
+// releases a whole message's allocations at once but keeps the blocks, so a
+// worker that resets its arena per message stops calling malloc after the
+// first few messages and never contends on the global allocator.
+//
+// Arena is also a std::pmr::memory_resource, so pmr containers
+// (std::pmr::vector, std::pmr::string) can allocate from it directly. It is
+// not thread safe; use one per thread.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "bpw/bulk.hpp"
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class Arena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t default_block_size = size_t{64} << 10;
+
+    explicit Arena(size_t block_size = default_block_size) noexcept
+        : block_size_(block_size ? block_size : default_block_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() override { release(); }
+
+    // Uninitialised storage, or nullptr if the system is out of memory.
+    void* allocate(size_t n, size_t align = alignof(std::max_align_t)) noexcept {
+        uintptr_t p = (reinterpret_cast<uintptr_t>(ptr_) + (align - 1)) & ~(uintptr_t{align} - 1);
+        uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+        if (ptr_ && p <= end && n <= end - p) {
+            ptr_ = reinterpret_cast<uint8_t*>(p + n);
+            used_ += n;
+            return reinterpret_cast<void*>(p);
+        }
+        return allocate_slow(n, align);
+    }
+
+    template <class T>
+    T* allocate_array(size_t count) noexcept {
+        static_assert(std::is_trivially_destructible_v<T>, "arena memory is never destroyed");
+        if (count > SIZE_MAX / sizeof(T)) return nullptr;
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Owned copies of bytes / text.
+    std::span<const uint8_t> copy(std::span<const uint8_t> src) noexcept {
+        auto* p = static_cast<uint8_t*>(allocate(src.size(), 1));
+        if (!p) return {};
+        if (!src.empty()) std::memcpy(p, src.data(), src.size());
+        return {p, src.size()};
+    }
+
+    // Drop every allocation but keep the blocks for reuse.
+    void reset() noexcept {
+        cur_ = head_;
+        ptr_ = cur_ ? cur_->data() : nullptr;
+        end_ = cur_ ? cur_->data() + cur_->size : nullptr;
+        used_ = 0;
+    }
+
+    // Return every block to the system.
+    void release() noexcept {
+        for (Block* b = head_; b;) {
+            Block* next = b->next;
+            std::free(b);
+            b = next;
+        }
+        head_ = cur_ = nullptr;
+        ptr_ = end_ = nullptr;
+        used_ = reserved_ = 0;
+    }
+
+    size_t bytes_used() const noexcept { return used_; }
+    size_t bytes_reserved() const noexcept { return reserved_; }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;
+        uint8_t* data() noexcept { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    // Move to the next retained block that fits, or allocate a new one after
+    // the current block. Oversized requests get a block of their own.
+    void* allocate_slow(size_t n, size_t align) noexcept {
+        if (n > SIZE_MAX - align - sizeof(Block)) return nullptr;
+        size_t need = n + align;
+        Block* prev = cur_;
+        for (Block* b = cur_ ? cur_->next : head_; b; b = b->next) {
+            if (b->size >= need) return use_block(b, n, align);
+        }
+        size_t size = need > block_size_ ? need : block_size_;
+        auto* b = static_cast<Block*>(std::malloc(sizeof(Block) + size));
+        if (!b) return nullptr;
+        b->size = size;
+        if (prev) {
+            b->next = prev->next;
+            prev->next = b;
+        } else {
+            b->next = head_;
+            head_ = b;
+        }
+        reserved_ += size;
+        return use_block(b, n, align);
+    }
+
+    void* use_block(Block* b, size_t n, size_t align) noexcept {
+        cur_ = b;
+        ptr_ = b->data();
+        end_ = b->data() + b->size;
+        return allocate(n, align);
+    }
+
+    void* do_allocate(size_t n, size_t align) override {
+        void* p = allocate(n, align);
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& o) const noexcept override { return this == &o; }
+
+    size_t block_size_;
+    Block* head_ = nullptr;  // every block, in reuse order
+    Block* cur_ = nullptr;   // block being bumped
+    uint8_t* ptr_ = nullptr;
+    uint8_t* end_ = nullptr;
+    size_t used_ = 0;
+    size_t reserved_ = 0;
+};
+
+// Copy the next n bytes out of `in` into the arena.
+[[nodiscard]] inline Status read_owned_bytes(Reader& in, size_t n, Arena& arena,
+                                             std::span<const uint8_t>& out) noexcept {
+    std::span<const uint8_t> view;
+    if (Status s = in.read_bytes(n, view); s != Status::ok) return s;
+    out = arena.copy(view);
+    return out.data() || n == 0 ? Status::ok : Status::out_of_memory;
+}
+
+[[nodiscard]] inline Status read_owned_string(Reader& in, size_t n, Arena& arena, std::string_view& out) noexcept {
+    std::span<const uint8_t> bytes;
+    if (Status s = read_owned_bytes(in, n, arena, bytes); s != Status::ok) return s;
+    out = {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    return Status::ok;
+}
+
+// Decode `count` E-endian integers from `in` into an arena-owned array.
+template <Endian E, class T>
+[[nodiscard]] inline Status read_owned_array(Reader& in, size_t count, Arena& arena, std::span<T>& out) noexcept {
+    if (count > in.remaining() / sizeof(T)) return in.bounds_error();
+    T* p = arena.allocate_array<T>(count);
+    if (!p && count) return Status::out_of_memory;
+    if (Status s = read_array<E>(in, p, count); s != Status::ok) return s;
+    out = {p, count};
+    return Status::ok;
+}
+
+// Length-prefixed variants: a LenT length in byte order E, then the bytes.
+template <class LenT, Endian E>
+[[nodiscard]] inline Status read_prefixed_string(Reader& in, Arena& arena, std::string_view& out) noexcept {
+    LenT len;
+    if (Status s = in.read<E>(len); s != Status::ok) return s;
+    return read_owned_string(in, static_cast<size_t>(len), arena, out);
+}
+
+template <class LenT, Endian E>
+[[nodiscard]] inline Status read_prefixed_bytes(Reader& in, Arena& arena, std::span<const uint8_t>& out) noexcept {
+    LenT len;
+    if (Status s = in.read<E>(len); s != Status::ok) return s;
+    return read_owned_bytes(in, static_cast<size_t>(len), arena, out);
+}
+
+}  // namespace bpw
@@ -0,0 +1,356 @@
+// Coroutine parsing of push-fed network input.
+//
+// AsyncReader is fed chunks as they arrive (from an epoll / io_uring loop or
+// any other event source) and parses with co_await instead of blocking a
+// thread:
+//
+//   bpw::Task handle(bpw::AsyncReader& in) {
+//       for (;;) {
+//           Header h;
+//           if (bpw::Status s = co_await bpw::parse<HeaderLayout>(in, h); s != bpw::Status::ok) co_return s;
+//           std::span<const uint8_t> body;
+//           if (bpw::Status s = co_await in.read_bytes(h.length, body); s != bpw::Status::ok) co_return s;
+//           ...
+//       }
+//   }
+//
+//   conn.task = handle(conn.in);
+//   conn.task.start();             // runs until the first read that lacks data
+//   ...
+//   (void)conn.in.feed(bytes);     // resumes the parser inline when it can proceed
+//   if (conn.task.done()) ...      // conn.task.result()
+//
+// Every awaitable completes without suspending when the bytes are already
+// buffered, so a burst of records in one chunk parses at the speed of the
+// synchronous Reader. Only a read that runs past the data received so far
+// suspends; feed() resumes it on the caller's thread once the request can
+// be met. When nothing is buffered, feed() parses straight out of the
+// caller's chunk and copies only an incomplete tail, as StreamParser does.
+// close() ends the input: a pending read resumes with out_of_bounds.
+//
+// A Task is a coroutine returning Status. It starts suspended and runs on
+// start() or when awaited by another Task. Frame allocation failure yields
+// an empty Task whose result() is out_of_memory; exceptions escaping a
+// coroutine terminate. One AsyncReader serves one coroutine chain at a
+// time, and both belong to one thread at a time.
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "bpw/endian.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+class Task {
+public:
+    struct promise_type {
+        Status result = Status::ok;
+        std::coroutine_handle<> continuation;
+
+        // Frames come from nothrow operator new; failure gives an empty Task.
+        static Task get_return_object_on_allocation_failure() noexcept { return Task(); }
+        Task get_return_object() noexcept { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept {
+            struct Final {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+                    std::coroutine_handle<> next = h.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return Final{};
+        }
+        void return_value(Status s) noexcept { result = s; }
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        static void* operator new(size_t n) noexcept { return ::operator new(n, std::nothrow); }
+        static void operator delete(void* p) noexcept { ::operator delete(p); }
+    };
+
+    Task() noexcept = default;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task(Task&& o) noexcept : h_(std::exchange(o.h_, {})), started_(std::exchange(o.started_, false)) {}
+    Task& operator=(Task&& o) noexcept {
+        if (this != &o) {
+            if (h_) h_.destroy();
+            h_ = std::exchange(o.h_, {});
+            started_ = std::exchange(o.started_, false);
+        }
+        return *this;
+    }
+    // Destroying a suspended task abandons it; the reader it waits on must
+    // not be fed afterwards.
+    ~Task() {
+        if (h_) h_.destroy();
+    }
+
+    // Run the coroutine until it first suspends. No-op once started.
+    void start() noexcept {
+        if (h_ && !started_) {
+            started_ = true;
+            h_.resume();
+        }
+    }
+
+    bool done() const noexcept { return !h_ || h_.done(); }
+    // The co_return value once done(); out_of_memory for an empty Task.
+    Status result() const noexcept { return h_ ? h_.promise().result : Status::out_of_memory; }
+
+    // co_await a child task: runs it and resumes the parent when it returns.
+    bool await_ready() const noexcept { return !h_; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> parent) noexcept {
+        started_ = true;
+        h_.promise().continuation = parent;
+        return h_;
+    }
+    Status await_resume() const noexcept { return result(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> h) noexcept : h_(h) {}
+
+    std::coroutine_handle<promise_type> h_;
+    bool started_ = false;
+};
+
+class AsyncReader {
+public:
+    // Bytes buffered between feed() calls are capped at max_buffered; a read
+    // larger than that fails rather than waiting forever.
+    explicit AsyncReader(size_t max_buffered = size_t{1} << 20) noexcept : max_buffered_(max_buffered) {}
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+
+    // Hand over the next chunk and resume the waiting coroutine if its read
+    // can now complete. Fails with out_of_bounds if the unconsumed bytes
+    // would exceed max_buffered (nothing is kept), out_of_memory if they
+    // cannot be stored, and invalid_argument after close().
+    [[nodiscard]] Status feed(std::span<const uint8_t> chunk) noexcept {
+        if (closed_) return Status::invalid_argument;
+        if (chunk.empty()) return Status::ok;
+        if (cur_ == end_ && waiter_) {
+            // Parse in place, then keep whatever the coroutine left.
+            cur_ = chunk.data();
+            end_ = cur_ + chunk.size();
+            wake();
+            return retain_tail();
+        }
+        if (buffered() + chunk.size() > max_buffered_) return Status::out_of_bounds;
+        if (Status s = append(chunk); s != Status::ok) return s;
+        wake();
+        return Status::ok;
+    }
+
+    // End of input: a pending read resumes and fails with out_of_bounds, as
+    // do later reads that need more than is buffered.
+    void close() noexcept {
+        closed_ = true;
+        if (waiter_) std::exchange(waiter_, {}).resume();
+    }
+
+    bool closed() const noexcept { return closed_; }
+    // A coroutine is suspended waiting for input.
+    bool waiting() const noexcept { return static_cast<bool>(waiter_); }
+    // Unconsumed bytes, counting a partially read byte as unconsumed.
+    size_t buffered() const noexcept { return static_cast<size_t>(end_ - cur_); }
+    // Peek at the unconsumed bytes, e.g. to compute a frame size after
+    // co_await need(header_size). Valid until the next co_await.
+    const uint8_t* data() const noexcept { return cur_; }
+
+    // Awaitable returned by the read functions; co_await yields a Status.
+    template <class F>
+    class [[nodiscard]] Read {
+    public:
+        bool await_ready() const noexcept { return r_->ready(n_); }
+        void await_suspend(std::coroutine_handle<> h) noexcept { r_->suspend(h, n_); }
+        Status await_resume() noexcept {
+            if (n_ > r_->buffered()) return Status::out_of_bounds;
+            return f_(r_->cur_);
+        }
+
+    private:
+        friend class AsyncReader;
+        Read(AsyncReader* r, size_t n, F f) noexcept : r_(r), n_(n), f_(std::move(f)) {}
+
+        AsyncReader* r_;
+        size_t n_;
+        F f_;
+    };
+
+    // Wait until n bytes are buffered; consumes nothing.
+    auto need(size_t n) noexcept {
+        return make(aligned(n), [this](const uint8_t*) { return Status::ok; });
+    }
+
+    // Point `out` at the next n bytes and consume them. Valid until the
+    // next co_await on this reader.
+    auto read_bytes(size_t n, std::span<const uint8_t>& out) noexcept {
+        return make(aligned(n), [this, n, &out](const uint8_t* p) {
+            out = {p + (bit_pos_ != 0), n};
+            consume(n);
+            return Status::ok;
+        });
+    }
+
+    auto skip(size_t n) noexcept {
+        return make(aligned(n), [this, n](const uint8_t*) {
+            consume(n);
+            return Status::ok;
+        });
+    }
+
+    template <class T>
+    auto read_le(T& out) noexcept {
+        static_assert(std::is_integral_v<T>, "read_le requires an integer type");
+        return make(aligned(sizeof(T)), [this, &out](const uint8_t* p) {
+            out = load_le<T>(p + (bit_pos_ != 0));
+            consume(sizeof(T));
+            return Status::ok;
+        });
+    }
+
+    template <class T>
+    auto read_be(T& out) noexcept {
+        static_assert(std::is_integral_v<T>, "read_be requires an integer type");
+        return make(aligned(sizeof(T)), [this, &out](const uint8_t* p) {
+            out = load_be<T>(p + (bit_pos_ != 0));
+            consume(sizeof(T));
+            return Status::ok;
+        });
+    }
+
+    auto read_u8(uint8_t& out) noexcept { return read_le(out); }
+
+    // Next n bits (1..64), most significant first, as BitReader reads them.
+    // Byte reads that follow skip the rest of a partially read byte.
+    auto read_bits(unsigned n, uint64_t& out) noexcept {
+        if (n > 64) n = ~0u;  // never satisfiable: fails with out_of_bounds
+        size_t bytes = n == ~0u ? SIZE_MAX : (bit_pos_ + size_t{n} + 7) / 8;
+        return make(bytes, [this, n, &out](const uint8_t* p) {
+            out = extract_bits(p, n);
+            size_t bits = bit_pos_ + size_t{n};
+            cur_ += bits / 8;
+            bit_pos_ = static_cast<unsigned>(bits % 8);
+            return Status::ok;
+        });
+    }
+
+    // Record of a fixed layout (bpw/layout.hpp), decoded in place.
+    template <class L>
+    auto parse(typename L::record_type& out) noexcept {
+        return make(aligned(L::size), [this, &out](const uint8_t* p) {
+            L::decode(p + (bit_pos_ != 0), out);
+            consume(L::size);
+            return Status::ok;
+        });
+    }
+
+private:
+    template <class F>
+    Read<F> make(size_t n, F f) noexcept {
+        return Read<F>(this, n, std::move(f));
+    }
+
+    // Bytes needed for an n-byte read, counting a partial byte that the
+    // read will skip.
+    size_t aligned(size_t n) const noexcept {
+        size_t extra = bit_pos_ != 0;
+        return n > SIZE_MAX - extra ? SIZE_MAX : n + extra;
+    }
+
+    bool ready(size_t n) const noexcept { return n <= buffered() || closed_ || n > max_buffered_; }
+
+    void suspend(std::coroutine_handle<> h, size_t n) noexcept {
+        waiter_ = h;
+        want_ = n;
+    }
+
+    // Consume n whole bytes after dropping a partially read byte.
+    void consume(size_t n) noexcept {
+        cur_ += n + (bit_pos_ != 0);
+        bit_pos_ = 0;
+    }
+
+    uint64_t extract_bits(const uint8_t* p, unsigned n) const noexcept {
+        if (n == 0) return 0;
+        if (bit_pos_ + n <= 64 && buffered() >= 8) return (load_be<uint64_t>(p) << bit_pos_) >> (64 - n);
+        // Near the end of the buffer, or spanning nine bytes.
+        uint64_t v = 0;
+        unsigned pos = bit_pos_;
+        for (unsigned left = n; left;) {
+            unsigned avail = 8 - pos;
+            unsigned take = left < avail ? left : avail;
+            v = (v << take) | ((*p >> (avail - take)) & ((1u << take) - 1));
+            left -= take;
+            pos += take;
+            if (pos == 8) {
+                pos = 0;
+                ++p;
+            }
+        }
+        return v;
+    }
+
+    void wake() noexcept {
+        if (waiter_ && want_ <= buffered()) std::exchange(waiter_, {}).resume();
+    }
+
+    // Copy the unconsumed bytes of the caller's chunk into our buffer.
+    Status retain_tail() noexcept {
+        size_t left = buffered();
+        if (left == 0) {
+            cur_ = end_ = nullptr;
+            return Status::ok;
+        }
+        const uint8_t* tail = cur_;
+        buf_.clear();
+        cur_ = end_ = nullptr;
+        if (left > max_buffered_) return Status::out_of_bounds;
+        if (Status s = buf_.write_bytes(tail, left); s != Status::ok) return s;
+        cur_ = buf_.data();
+        end_ = cur_ + left;
+        return Status::ok;
+    }
+
+    // Add a chunk after the unconsumed bytes, first moving them to the
+    // front of the buffer.
+    Status append(std::span<const uint8_t> chunk) noexcept {
+        size_t left = buffered();
+        if (left && cur_ != buf_.data()) std::memmove(buf_.data(), cur_, left);
+        buf_.clear();
+        buf_.commit(left);  // the moved bytes are already in place
+        Status s = buf_.write_bytes(chunk.data(), chunk.size());
+        cur_ = buf_.data();
+        end_ = cur_ + buf_.size();
+        return s;
+    }
+
+    Writer buf_;
+    const uint8_t* cur_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    unsigned bit_pos_ = 0;  // bits of *cur_ already consumed
+    size_t max_buffered_;
+    std::coroutine_handle<> waiter_;
+    size_t want_ = 0;
+    bool closed_ = false;
+};
+
+// co_await bpw::parse<Layout>(reader, record)
+template <class L>
+auto parse(AsyncReader& in, typename L::record_type& out) noexcept {
+    return in.parse<L>(out);
+}
+
+}  // namespace bpw
@@ -0,0 +1,166 @@
+// MSB-first bit reader with a 64-bit refill cache.
+//
+// Bits are consumed most-significant first within each byte (network /
+// telemetry order). The cache is refilled a whole 64-bit word at a time; as
+// long as 8 or more input bytes remain the refill needs no per-byte bounds
+// checks, so peek_bits / skip_bits / read_bits cost the same for every field
+// width from 1 to 32 bits.
+//
+// Reading past the end of the input does not fail immediately: missing bits
+// read as zero and the overrun is latched. Check status() once per record
+// instead of after every field.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class BitReader {
+public:
+    static constexpr unsigned max_bits = 32;  // widest single peek/read
+
+    constexpr BitReader() noexcept = default;
+    BitReader(const uint8_t* data, size_t size) noexcept
+        : begin_(data), cur_(data), end_(data + size) {}
+    // Starts at the reader's current position and covers its unread bytes.
+    // Reports to the reader's stats, if any.
+    explicit BitReader(const Reader& r) noexcept : BitReader(r.data(), r.remaining()) { set_stats(r.stats()); }
+
+    // Counters (bpw/stats.hpp); no-ops unless built with BPW_STATS.
+    void set_stats([[maybe_unused]] ReadStats* s) noexcept {
+#if BPW_STATS
+        stats_ = s;
+#endif
+    }
+
+    // Next n bits (0 <= n <= 32) without consuming them.
+    uint32_t peek_bits(unsigned n) noexcept {
+        if (bits_ < n) refill();
+        return static_cast<uint32_t>((cache_ >> 1) >> (63 - n));
+    }
+
+    // Drop n bits; n may be any size, including beyond max_bits.
+    void skip_bits(size_t n) noexcept {
+        if (n <= bits_) {
+            consume(static_cast<unsigned>(n));
+            return;
+        }
+        n -= bits_;
+        cache_ = 0;
+        bits_ = 0;
+        size_t bytes = n >> 3;
+        size_t avail = static_cast<size_t>(end_ - cur_);
+        if (bytes > avail) {
+            pad_ += (bytes - avail) * 8;
+            bytes = avail;
+        }
+        cur_ += bytes;
+        BPW_COUNT(stats_, bytes, bytes);
+        refill();
+        consume(static_cast<unsigned>(n & 7));
+    }
+
+    // Read n bits (0 <= n <= 32) as an unsigned value.
+    uint32_t read_bits(unsigned n) noexcept {
+        uint32_t v = peek_bits(n);
+        consume(n);
+        return v;
+    }
+
+    // Read n bits (1 <= n <= 32) as a two's complement value.
+    int32_t read_signed_bits(unsigned n) noexcept {
+        uint32_t v = read_bits(n);
+        uint32_t sign = 1u << (n - 1);
+        return static_cast<int32_t>((v ^ sign) - sign);
+    }
+
+    bool read_bit() noexcept { return read_bits(1) != 0; }
+
+    // Read up to 64 bits as two halves.
+    uint64_t read_bits64(unsigned n) noexcept {
+        if (n <= max_bits) return read_bits(n);
+        uint64_t hi = read_bits(n - max_bits);
+        return (hi << max_bits) | read_bits(max_bits);
+    }
+
+    // Skip to the next byte boundary.
+    void align_to_byte() noexcept { consume(bits_ & 7); }
+    bool is_byte_aligned() const noexcept { return (bit_position() & 7) == 0; }
+
+    // Bits consumed so far, including any zero padding read past the end.
+    size_t bit_position() const noexcept {
+        return static_cast<size_t>(cur_ - begin_) * 8 + pad_ - bits_;
+    }
+    size_t bit_size() const noexcept { return static_cast<size_t>(end_ - begin_) * 8; }
+    size_t bits_remaining() const noexcept {
+        size_t pos = bit_position();
+        return pos < bit_size() ? bit_size() - pos : 0;
+    }
+
+    bool overrun() const noexcept { return bit_position() > bit_size(); }
+    Status status() const noexcept { return overrun() ? Status::out_of_bounds : Status::ok; }
+
+    // Byte reader over the unread input. The bit reader must be byte
+    // aligned; any bits still in the cache are handed back to the input.
+    [[nodiscard]] Status byte_reader(Reader& out) const noexcept {
+        if (!is_byte_aligned() || overrun()) return Status::invalid_argument;
+        const uint8_t* p = begin_ + bit_position() / 8;
+        out = Reader(p, static_cast<size_t>(end_ - p));
+        return Status::ok;
+    }
+
+private:
+    void consume(unsigned n) noexcept {
+        cache_ <<= n;  // n <= bits_ < 64
+        bits_ -= n;
+    }
+
+    // Top up the cache to at least 56 valid bits.
+    void refill() noexcept {
+        BPW_COUNT(stats_, refills, 1);
+        if (end_ - cur_ >= 8) {
+            // The word also carries bits past the new bits_ mark; they are
+            // the same stream bits the next refill will OR in, so they are
+            // harmless. See F. Giesen, "Reading bits in far too many ways".
+            cache_ |= load_be<uint64_t>(cur_) >> bits_;
+            cur_ += (63 - bits_) >> 3;
+            BPW_COUNT(stats_, bytes, (63 - bits_) >> 3);
+            bits_ |= 56;
+            return;
+        }
+        refill_tail();
+    }
+
+    void refill_tail() noexcept {
+        BPW_COUNT(stats_, slow_paths, 1);
+        while (bits_ <= 56 && cur_ < end_) {
+            cache_ |= static_cast<uint64_t>(*cur_++) << (56 - bits_);
+            bits_ += 8;
+            BPW_COUNT(stats_, bytes, 1);
+        }
+        if (bits_ <= 56) {
+            // Input exhausted: pretend zero bytes follow.
+            unsigned pad = (63 - bits_) & ~7u;
+            pad_ += pad;
+            bits_ += pad;
+        }
+    }
+
+    const uint8_t* begin_ = nullptr;
+    const uint8_t* cur_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    uint64_t cache_ = 0;   // valid bits are left aligned
+    unsigned bits_ = 0;    // number of valid bits in cache_
+    size_t pad_ = 0;       // zero bits synthesized past the end
+#if BPW_STATS
+    ReadStats* stats_ = nullptr;
+#endif
+};
+
+}  // namespace bpw
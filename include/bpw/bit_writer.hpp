@@ -0,0 +1,99 @@
+// MSB-first bit writer with a 64-bit accumulator; mirror of BitReader.
+//
+// Sub-byte writes are merged into a 64-bit register. When the next field no
+// longer fits, all whole bytes in the register are flushed with one 64-bit
+// big-endian store, so the underlying Writer sees one append per ~7 bytes
+// rather than one per field.
+//
+// Failure to obtain output space is latched; check status() (or the result
+// of finish()) once at the end of an encode.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bpw/endian.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+class BitWriter {
+public:
+    static constexpr unsigned max_bits = 32;  // widest single write
+
+    explicit BitWriter(Writer& out) noexcept : out_(&out) {}
+    // Reserves room for capacity_hint more bytes up front so the encode does
+    // not reallocate.
+    BitWriter(Writer& out, size_t capacity_hint) noexcept : out_(&out) {
+        // The extra word covers the over-wide store in flush_bytes().
+        if (out.owns_buffer() && out.reserve(out.size() + capacity_hint + 8) != Status::ok)
+            status_ = Status::out_of_memory;
+    }
+
+    BitWriter(const BitWriter&) = delete;
+    BitWriter& operator=(const BitWriter&) = delete;
+
+    // Append the low n bits of v (0 <= n <= 32).
+    void write_bits(uint32_t v, unsigned n) noexcept {
+        uint64_t bits = v & ((uint64_t{1} << n) - 1);
+        if (n > 64 - bits_) flush_bytes();
+        acc_ |= bits << ((64 - bits_ - n) & 63);
+        bits_ += n;
+    }
+
+    void write_bit(bool b) noexcept { write_bits(b ? 1u : 0u, 1); }
+
+    // Append the low n bits of v (0 <= n <= 64) as two halves.
+    void write_bits64(uint64_t v, unsigned n) noexcept {
+        if (n <= max_bits) {
+            write_bits(static_cast<uint32_t>(v), n);
+            return;
+        }
+        write_bits(static_cast<uint32_t>(v >> max_bits), n - max_bits);
+        write_bits(static_cast<uint32_t>(v), max_bits);
+    }
+
+    // Pad with zero bits up to the next byte boundary.
+    void align_to_byte() noexcept { bits_ = (bits_ + 7) & ~7u; }
+
+    size_t bit_position() const noexcept { return (out_->size() - base_) * 8 + bits_; }
+
+    // Flush every pending bit (zero padding the final byte) to the Writer.
+    [[nodiscard]] Status finish() noexcept {
+        align_to_byte();
+        flush_bytes();
+        return status_;
+    }
+
+    Status status() const noexcept { return status_; }
+
+private:
+    // Move all whole bytes out of the accumulator, leaving < 8 bits.
+    void flush_bytes() noexcept {
+        unsigned bytes = bits_ >> 3;
+        if (uint8_t* p = out_->prepare(8)) {
+            store_be<uint64_t>(p, acc_);
+        } else if (uint8_t* q = out_->prepare(bytes)) {
+            // Fixed buffer close to full: store only what is needed.
+            out_->count_slow_path();
+            for (unsigned i = 0; i < bytes; ++i) q[i] = static_cast<uint8_t>(acc_ >> (56 - 8 * i));
+        } else {
+            status_ = out_->failure();
+            acc_ = 0;
+            bits_ = 0;
+            return;
+        }
+        out_->commit(bytes);
+        acc_ = bytes == 8 ? 0 : acc_ << (bytes * 8);
+        bits_ -= bytes * 8;
+    }
+
+    Writer* out_;
+    size_t base_ = out_->size();
+    uint64_t acc_ = 0;   // pending bits, left aligned
+    unsigned bits_ = 0;  // number of pending bits
+    Status status_ = Status::ok;
+};
+
+}  // namespace bpw
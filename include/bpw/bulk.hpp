@@ -0,0 +1,79 @@
+// Bulk array reads and writes on Reader / Writer, backed by the dispatched
+// kernels in bpw/simd.hpp.
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/simd.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+namespace detail {
+
+template <class T>
+inline void swap_array(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    if constexpr (sizeof(T) == 1) std::memmove(dst, src, count);
+    else if constexpr (sizeof(T) == 2) simd::bswap16(src, dst, count);
+    else if constexpr (sizeof(T) == 4) simd::bswap32(src, dst, count);
+    else simd::bswap64(src, dst, count);
+}
+
+template <Endian E>
+constexpr bool is_native() {
+    return (E == Endian::little) == (std::endian::native == std::endian::little);
+}
+
+}  // namespace detail
+
+// Read `count` E-endian integers into out[0..count).
+template <Endian E, class T>
+[[nodiscard]] inline Status read_array(Reader& in, T* out, size_t count) noexcept {
+    static_assert(std::is_integral_v<T>, "read_array requires an integer type");
+    if (count > in.remaining() / sizeof(T)) return in.bounds_error();
+    const size_t bytes = count * sizeof(T);
+    if constexpr (sizeof(T) == 1 || detail::is_native<E>()) {
+        if (bytes) std::memcpy(out, in.data(), bytes);
+    } else {
+        detail::swap_array<T>(in.data(), reinterpret_cast<uint8_t*>(out), count);
+    }
+    return in.skip(bytes);
+}
+
+// Append `count` integers from src in E byte order.
+template <Endian E, class T>
+[[nodiscard]] inline Status write_array(Writer& out, const T* src, size_t count) noexcept {
+    static_assert(std::is_integral_v<T>, "write_array requires an integer type");
+    if (count > SIZE_MAX / sizeof(T)) return Status::invalid_argument;
+    const size_t bytes = count * sizeof(T);
+    uint8_t* p = out.prepare(bytes);
+    if (!p) return out.failure();
+    if constexpr (sizeof(T) == 1 || detail::is_native<E>()) {
+        if (bytes) std::memcpy(p, src, bytes);
+    } else {
+        detail::swap_array<T>(reinterpret_cast<const uint8_t*>(src), p, count);
+    }
+    out.commit(bytes);
+    return Status::ok;
+}
+
+// Read `count` MSB-first packed integers of `width` bits (1..32). The packed
+// block is assumed to start on a byte boundary and is consumed up to the
+// next byte boundary.
+[[nodiscard]] inline Status read_packed(Reader& in, unsigned width, size_t count, uint32_t* out) noexcept {
+    if (width < 1 || width > 32) return Status::invalid_argument;
+    if (count > SIZE_MAX / 32) return in.bounds_error();
+    const size_t bytes = simd::packed_size(width, count);
+    if (!in.has(bytes)) return in.bounds_error();
+    simd::unpack_bits(in.data(), width, count, out);
+    return in.skip(bytes);
+}
+
+}  // namespace bpw
@@ -0,0 +1,87 @@
+// Columnar (structure-of-arrays) batch decode for fixed-layout records.
+//
+// Instead of materialising N Record structs, decode_columns() writes each
+// bound field into its own contiguous output array. Unbound fields are not
+// touched at all, so pulling one or two columns out of millions of records
+// costs one tight loop per column:
+//
+//   std::vector<uint32_t> lengths(n);
+//   bpw::Columns<HeaderLayout> cols;
+//   cols.bind<&Header::length>(lengths.data());
+//   if (bpw::decode_columns(reader, n, cols) != bpw::Status::ok) ...
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include "bpw/layout.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+template <class L>
+class Columns;
+
+// Output arrays for a layout, one optional pointer per field.
+template <class Record, class... Fields>
+class Columns<Layout<Record, Fields...>> {
+public:
+    using layout = Layout<Record, Fields...>;
+
+    // out must have room for as many elements as records will be decoded.
+    template <auto Member>
+    void bind(typename layout::template field<layout::template index_of<Member>>::value_type* out) noexcept {
+        static_assert(layout::template has_member<Member>, "member is not part of this layout");
+        std::get<layout::template index_of<Member>>(ptrs_) = out;
+    }
+
+    template <size_t I>
+    auto* get() const noexcept { return std::get<I>(ptrs_); }
+
+    // Advance every bound column by n elements, for chunked decoding into
+    // the same arrays.
+    void advance(size_t n) noexcept {
+        std::apply([n](auto*&... p) { ((p = p ? p + n : p), ...); }, ptrs_);
+    }
+
+private:
+    std::tuple<typename Fields::value_type*...> ptrs_{};
+};
+
+namespace detail {
+
+template <class F, class T>
+inline void decode_column(const uint8_t* p, size_t stride, size_t count, T* out) noexcept {
+    if (!out) return;
+    for (size_t i = 0; i < count; ++i) F::decode_value(p + i * stride, out[i]);
+}
+
+template <class L, size_t... I>
+inline void decode_columns_impl(const uint8_t* p, size_t count, const Columns<L>& cols,
+                                std::index_sequence<I...>) noexcept {
+    (decode_column<typename L::template field<I>>(p, L::size, count, cols.template get<I>()), ...);
+}
+
+}  // namespace detail
+
+// Unchecked: p must reference count * L::size readable bytes. Columns are
+// filled one at a time so each inner loop is a unit-stride store stream.
+template <class L>
+inline void decode_columns(const uint8_t* p, size_t count, const Columns<L>& cols) noexcept {
+    detail::decode_columns_impl(p, count, cols, std::make_index_sequence<L::field_count>{});
+}
+
+// Decode `count` consecutive records from `in` into the bound columns. The
+// whole batch is bounds checked once up front.
+template <class L>
+[[nodiscard]] inline Status decode_columns(Reader& in, size_t count, const Columns<L>& cols) noexcept {
+    if (count > in.remaining() / L::size) return in.bounds_error();
+    decode_columns(in.data(), count, cols);
+    in.count_records(count);
+    return in.skip(count * L::size);
+}
+
+}  // namespace bpw
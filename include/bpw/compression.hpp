@@ -0,0 +1,212 @@
+// Block compression layer between files and the reader / writer.
+//
+// A compressed stream is a sequence of self-describing blocks:
+//
+//   offset  size  field (little-endian)
+//        0     4  magic "BPWZ"
+//        4     1  codec (Codec)
+//        5     3  reserved, zero
+//        8     4  raw size
+//       12     4  stored size (bytes that follow the header)
+//       16     4  CRC-32C of the raw bytes
+//
+// CompressedWriter collects records in a raw block buffer and seals a
+// block once it reaches block_size. Blocks therefore end on record
+// boundaries and every block can be parsed with its own Reader or
+// BitReader. Sealed blocks are compressed and written to the descriptor,
+// on a background thread when `background` is set, so the caller fills the
+// next block in the meantime. A block that does not shrink is stored with
+// Codec::none.
+//
+// CompressedReader pulls blocks from a FileSource and hands out one
+// decompressed block at a time. With `background` set, a worker thread
+// decompresses the next block while the caller parses the current one.
+// Blocks need not end on record boundaries for the reader; feed them to a
+// StreamParser when they were produced elsewhere.
+//
+// LZ4 and Zstandard are used when their headers are found at build time
+// (link with -llz4 / -lzstd); define BPW_WITH_LZ4=0 or BPW_WITH_ZSTD=0 to
+// leave one out. Without a codec, codec_available() is false and encoding
+// or decoding with it fails with Status::unsupported.
+//
+// POSIX only; implemented in src/compression.cpp.
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+
+#include "bpw/file_source.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+enum class Codec : uint8_t {
+    none = 0,
+    lz4 = 1,
+    zstd = 2,
+};
+
+// True when the codec was compiled in. Codec::none is always available.
+bool codec_available(Codec c) noexcept;
+
+// Largest stored size compress_block() can produce for n raw bytes.
+size_t compress_bound(Codec c, size_t n) noexcept;
+
+// Compress `in` into [out, out + capacity). `level` 0 selects the codec's
+// default; otherwise it is the Zstandard compression level or the LZ4
+// acceleration factor (higher is faster). capacity >= compress_bound()
+// never fails for lack of space.
+[[nodiscard]] Status compress_block(Codec c, int level, std::span<const uint8_t> in, uint8_t* out,
+                                    size_t capacity, size_t& written) noexcept;
+
+// Decompress `in` into exactly raw_size bytes at out. Fails with malformed
+// if the data is corrupt or does not decode to raw_size bytes.
+[[nodiscard]] Status decompress_block(Codec c, std::span<const uint8_t> in, uint8_t* out,
+                                      size_t raw_size) noexcept;
+
+struct BlockHeader {
+    static constexpr size_t size = 20;
+    static constexpr uint32_t magic = 0x5a575042;  // "BPWZ"
+
+    Codec codec = Codec::none;
+    uint32_t raw_size = 0;
+    uint32_t stored_size = 0;
+    uint32_t crc = 0;
+
+    void encode(uint8_t* p) const noexcept;
+    // Fails with malformed on a bad magic, reserved bits or unknown codec.
+    [[nodiscard]] static Status decode(const uint8_t* p, BlockHeader& out) noexcept;
+};
+
+struct CompressionOptions {
+    Codec codec = Codec::lz4;
+    int level = 0;
+    // Raw bytes per block. Blocks are sealed at the first record boundary
+    // at or past this size.
+    size_t block_size = size_t{1} << 20;
+    // Compress and write (writer) or read ahead (reader) on a worker thread.
+    bool background = true;
+    // Reader: blocks claiming more raw bytes than this are rejected as
+    // malformed, which bounds the memory a corrupt header can request.
+    size_t max_block_size = size_t{64} << 20;
+};
+
+class CompressedWriter {
+public:
+    // Writes blocks to `fd`, which stays owned by the caller. Check
+    // status() for setup failures (unavailable codec, thread creation).
+    explicit CompressedWriter(int fd, const CompressionOptions& opts = {});
+    CompressedWriter(const CompressedWriter&) = delete;
+    CompressedWriter& operator=(const CompressedWriter&) = delete;
+    // Calls finish(); use finish() directly to see its status.
+    ~CompressedWriter();
+
+    // Raw bytes of the block being filled. Write whole records here and
+    // call end_record() after each.
+    Writer& block() noexcept { return block_; }
+
+    // Seal the block if it has reached block_size. Write errors from the
+    // worker surface here at the next seal.
+    [[nodiscard]] Status end_record() {
+        return block_.size() >= opts_.block_size ? seal() : Status::ok;
+    }
+
+    // Seal the current block (if not empty) and wait until every sealed
+    // block has been written.
+    [[nodiscard]] Status flush();
+
+    // flush(), then stop the worker. Further writes fail.
+    [[nodiscard]] Status finish();
+
+    // Sticky error from setup, compression or the descriptor.
+    Status status() const;
+    // errno of the last failed write.
+    int last_error() const;
+
+    // Totals for blocks written so far (raw bytes in, bytes out with headers).
+    uint64_t blocks_written() const;
+    uint64_t raw_bytes() const;
+    uint64_t stored_bytes() const;
+
+private:
+    Status seal();
+    Status write_block(Writer& raw, Writer& scratch);
+    void worker_loop();
+
+    CompressionOptions opts_;
+    int fd_;
+    Writer block_;       // filled by the caller
+    Writer pending_;     // sealed, waiting for the worker
+    Writer scratch_;     // worker's compression output
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    bool has_pending_ = false;
+    bool stop_ = false;
+    bool finished_ = false;
+    Status status_ = Status::ok;
+    int errno_ = 0;
+    uint64_t blocks_ = 0;
+    uint64_t raw_ = 0;
+    uint64_t stored_ = 0;
+    std::thread worker_;
+};
+
+class CompressedReader {
+public:
+    // Reads blocks from `src`, which must outlive the reader and must not
+    // be used by anyone else while it is. Check status() for setup failures.
+    explicit CompressedReader(FileSource& src, const CompressionOptions& opts = {});
+    CompressedReader(const CompressedReader&) = delete;
+    CompressedReader& operator=(const CompressedReader&) = delete;
+    ~CompressedReader();
+
+    // The next decompressed block, valid until the next call. An empty span
+    // signals the end of the input. A stream that ends inside a block fails
+    // with out_of_bounds; a bad header or checksum with malformed.
+    [[nodiscard]] Status next_block(std::span<const uint8_t>& out);
+
+    // Sticky error; ok otherwise. Errors are reported by next_block() only
+    // once the blocks before them have been handed out.
+    Status status() const;
+
+    uint64_t blocks_read() const noexcept { return blocks_; }
+
+private:
+    // One decoded block, or the error / end of input that ended the stream.
+    struct Slot {
+        Writer data;
+        Status status = Status::ok;
+        bool end = false;
+    };
+
+    Status load_block(Slot& slot);
+    Status next_chunk();
+    Status pull(size_t n, const uint8_t*& p);
+    void worker_loop();
+
+    CompressionOptions opts_;
+    FileSource* src_;
+    std::span<const uint8_t> chunk_;  // current FileSource chunk, or the whole mapping
+    size_t chunk_pos_ = 0;
+    bool whole_ = false;              // chunk_ is the entire mapped file
+    Writer stage_;                    // bytes that straddle chunks
+    Slot slots_[2];
+    mutable std::mutex m_;
+    std::condition_variable cv_;
+    unsigned ready_ = 0;    // slots filled by the worker, not yet consumed
+    unsigned produce_ = 0;  // slot the worker fills next
+    unsigned consume_ = 0;  // slot handed out by next_block()
+    bool holding_ = false;  // the caller holds slots_[consume_]
+    bool stop_ = false;
+    bool done_ = false;     // end of input or an error has been handed out
+    Status status_ = Status::ok;
+    uint64_t blocks_ = 0;
+    std::thread worker_;
+};
+
+}  // namespace bpw
@@ -0,0 +1,131 @@
+// Reusable per-message parse/encode contexts and a pool that caches them.
+//
+// A Context bundles the state one message needs: an output Writer, a
+// scratch Writer for staging (length-prefixed sub-messages, re-encoding),
+// and an Arena for owned variable-length fields. reset() rewinds all three
+// without freeing, so a context that has served a few messages has touched
+// every page it needs and stops allocating. New contexts are optionally
+// pre-faulted so even the first message avoids first-touch page faults.
+//
+// ContextPool hands contexts out as RAII leases. Each thread keeps the
+// context it released last in a one-slot cache, so the common acquire/release
+// on one thread takes no lock; other contexts sit on a mutex-protected free
+// list and can move between threads. Contexts that grew past
+// max_retained_bytes for one unusually large message are trimmed back on
+// release. Implemented in src/context.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "bpw/arena.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+struct ContextOptions {
+    size_t output_capacity = size_t{64} << 10;
+    size_t scratch_capacity = size_t{16} << 10;
+    size_t arena_block_size = Arena::default_block_size;
+    // Buffers above this size are released on reset() rather than kept.
+    size_t max_retained_bytes = size_t{16} << 20;
+    // Touch every page of new buffers up front.
+    bool prefault = true;
+};
+
+class Context {
+public:
+    explicit Context(const ContextOptions& opts = {}) noexcept;
+    Context(const Context&) = delete;
+    Context& operator=(const Context&) = delete;
+
+    Writer& output() noexcept { return output_; }
+    Writer& scratch() noexcept { return scratch_; }
+    Arena& arena() noexcept { return arena_; }
+
+    // Rewind for the next message, keeping (and trimming) the buffers.
+    void reset() noexcept;
+
+    // Messages served since the context was created.
+    uint64_t uses() const noexcept { return uses_; }
+
+private:
+    void prepare_buffers() noexcept;
+
+    ContextOptions opts_;
+    Writer output_;
+    Writer scratch_;
+    Arena arena_;
+    uint64_t uses_ = 0;
+};
+
+class ContextPool {
+public:
+    // Exclusive use of one context; returns it to the pool when destroyed.
+    class Lease {
+    public:
+        Lease() noexcept = default;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& o) noexcept : pool_(std::exchange(o.pool_, nullptr)), ctx_(std::exchange(o.ctx_, nullptr)) {}
+        Lease& operator=(Lease&& o) noexcept {
+            if (this != &o) {
+                release();
+                pool_ = std::exchange(o.pool_, nullptr);
+                ctx_ = std::exchange(o.ctx_, nullptr);
+            }
+            return *this;
+        }
+        ~Lease() { release(); }
+
+        // Empty only if allocating a new context failed.
+        explicit operator bool() const noexcept { return ctx_ != nullptr; }
+        Context& operator*() const noexcept { return *ctx_; }
+        Context* operator->() const noexcept { return ctx_; }
+
+        // Give the context back early.
+        void release() noexcept {
+            if (ctx_) pool_->give_back(ctx_);
+            pool_ = nullptr;
+            ctx_ = nullptr;
+        }
+
+    private:
+        friend class ContextPool;
+        Lease(ContextPool* pool, Context* ctx) noexcept : pool_(pool), ctx_(ctx) {}
+
+        ContextPool* pool_ = nullptr;
+        Context* ctx_ = nullptr;
+    };
+
+    // Keeps at most max_idle contexts on the shared free list.
+    explicit ContextPool(const ContextOptions& opts = {}, size_t max_idle = 64) noexcept;
+    ContextPool(const ContextPool&) = delete;
+    ContextPool& operator=(const ContextPool&) = delete;
+    // Leases must not outlive the pool. Contexts parked in other threads'
+    // caches are freed when those threads exit or next use a pool.
+    ~ContextPool();
+
+    // A reset context: this thread's cached one if it is idle, else one
+    // from the free list, else a new one.
+    [[nodiscard]] Lease acquire() noexcept;
+
+    // Contexts on the shared free list (not counting thread caches).
+    size_t idle() const noexcept;
+    const ContextOptions& options() const noexcept { return opts_; }
+
+private:
+    void give_back(Context* ctx) noexcept;
+
+    ContextOptions opts_;
+    size_t max_idle_;
+    uint64_t id_;  // distinguishes pools in the thread-local caches
+    mutable std::mutex m_;
+    std::vector<std::unique_ptr<Context>> free_;
+};
+
+}  // namespace bpw
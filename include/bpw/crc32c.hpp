@@ -0,0 +1,92 @@
+// CRC32C (Castagnoli) checksums, computed while bytes are consumed or emitted.
+//
+// crc32c() uses the SSE4.2 crc32 instruction on x86-64 or the ARMv8 CRC
+// extension on AArch64 when the CPU has it, chosen once on first use. It
+// falls back to slicing-by-8 tables otherwise. Large buffers are split into
+// three interleaved streams so the hardware path is not bound by the latency
+// of the crc32 instruction. Implemented in src/crc32c.cpp.
+//
+// ReaderCrc and WriterCrc fold in whatever a Reader has consumed or a Writer
+// has emitted since the last update(). Calling update() once per record
+// checksums each record while it is still in cache, so integrity checking
+// does not need a second pass over the buffer.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "bpw/reader.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+// CRC32C of n bytes, continuing from `crc` (the value returned for the
+// preceding bytes, or 0 to start): crc32c(b, crc32c(a)) == crc32c(a ++ b).
+uint32_t crc32c(const void* data, size_t n, uint32_t crc = 0) noexcept;
+
+inline uint32_t crc32c(std::span<const uint8_t> data, uint32_t crc = 0) noexcept {
+    return crc32c(data.data(), data.size(), crc);
+}
+
+// Whether crc32c() uses a CPU instruction rather than tables.
+bool crc32c_hardware() noexcept;
+
+// Running checksum over the bytes a Reader consumes.
+//
+// Bytes count once they are read or skipped past. Seeking backwards moves
+// the mark back without un-hashing anything, so re-read bytes are counted
+// again; seeking forwards counts the skipped bytes.
+class ReaderCrc {
+public:
+    explicit ReaderCrc(const Reader& in, uint32_t crc = 0) noexcept : in_(&in), mark_(in.data()), crc_(crc) {}
+
+    uint32_t update() noexcept {
+        const uint8_t* p = in_->data();
+        if (p > mark_) crc_ = crc32c(mark_, static_cast<size_t>(p - mark_), crc_);
+        mark_ = p;
+        return crc_;
+    }
+
+    // Checksum as of the last update().
+    uint32_t value() const noexcept { return crc_; }
+
+    // Start over from the reader's current position.
+    void reset(uint32_t crc = 0) noexcept {
+        mark_ = in_->data();
+        crc_ = crc;
+    }
+
+private:
+    const Reader* in_;
+    const uint8_t* mark_;
+    uint32_t crc_;
+};
+
+// Running checksum over the bytes a Writer emits. The mark is an offset, so
+// buffer growth does not invalidate it; a Writer::clear() restarts it at 0.
+class WriterCrc {
+public:
+    explicit WriterCrc(const Writer& out, uint32_t crc = 0) noexcept : out_(&out), mark_(out.size()), crc_(crc) {}
+
+    uint32_t update() noexcept {
+        size_t n = out_->size();
+        if (n > mark_) crc_ = crc32c(out_->data() + mark_, n - mark_, crc_);
+        mark_ = n;
+        return crc_;
+    }
+
+    uint32_t value() const noexcept { return crc_; }
+
+    void reset(uint32_t crc = 0) noexcept {
+        mark_ = out_->size();
+        crc_ = crc;
+    }
+
+private:
+    const Writer* out_;
+    size_t mark_;
+    uint32_t crc_;
+};
+
+}  // namespace bpw
@@ -0,0 +1,60 @@
+// Delta / frame-of-reference encoding for sorted or slowly changing integer
+// columns (timestamps, sequence numbers).
+//
+// A column of `count` values is stored as the first value followed by the
+// differences between neighbours, in blocks of delta_block_size deltas:
+//
+//   varint  first value
+//   per block:
+//     svarint  reference: the smallest delta in the block
+//     u8       width w (0..64)
+//     packed   delta - reference for each delta in the block, w bits each,
+//              MSB first, padded to a whole byte
+//
+// Monotonic timestamps with jitter pack to a few bits per value instead of
+// 8 bytes, and a constant stride (sequence numbers) packs to width 0 with no
+// payload at all. Arithmetic is modulo 2^64, so any input round-trips;
+// values that jump around just get wide blocks.
+//
+// The count is not stored; pass the same count to read_delta(), as with
+// read_varints(). Decoding unpacks each block with the dispatched
+// simd::unpack_bits() kernel (widths up to 32) and then runs the prefix sum.
+// Implemented in src/delta.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+#include "bpw/varint.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+constexpr size_t delta_block_size = 128;
+
+// Upper bound on the encoded size of `count` values.
+constexpr size_t delta_max_size(size_t count) noexcept {
+    const size_t blocks = count > 1 ? (count - 1 + delta_block_size - 1) / delta_block_size : 0;
+    return max_varint_size + blocks * (max_varint_size + 1) + 8 * count;
+}
+
+// Largest count an encoding of `bytes` bytes can hold. A width-0 block
+// stores 128 values in two bytes, so check a count read from untrusted
+// input against this before allocating the output.
+constexpr size_t delta_max_count(size_t bytes) noexcept {
+    if (bytes == 0) return 0;
+    const size_t blocks = (bytes - 1) / 2;
+    return blocks > (SIZE_MAX - 1) / delta_block_size ? SIZE_MAX : 1 + blocks * delta_block_size;
+}
+
+[[nodiscard]] Status write_delta(Writer& out, const uint64_t* src, size_t count) noexcept;
+[[nodiscard]] Status write_delta(Writer& out, const uint32_t* src, size_t count) noexcept;
+
+// Decode `count` values. Widths over 64 and, for uint32_t output, values
+// that do not fit are rejected as malformed.
+[[nodiscard]] Status read_delta(Reader& in, uint64_t* out, size_t count) noexcept;
+[[nodiscard]] Status read_delta(Reader& in, uint32_t* out, size_t count) noexcept;
+
+}  // namespace bpw
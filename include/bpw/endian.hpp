@@ -0,0 +1,73 @@
+// Unaligned little/big endian loads and stores.
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace bpw {
+
+enum class Endian : uint8_t { little, big };
+
+template <class T>
+constexpr T byteswap(T v) noexcept {
+    static_assert(std::is_integral_v<T>, "byteswap requires an integer type");
+    using U = std::make_unsigned_t<T>;
+    U u = static_cast<U>(v);
+    if constexpr (sizeof(T) == 1) {
+        return v;
+    } else if constexpr (sizeof(T) == 2) {
+        return static_cast<T>(__builtin_bswap16(u));
+    } else if constexpr (sizeof(T) == 4) {
+        return static_cast<T>(__builtin_bswap32(u));
+    } else {
+        static_assert(sizeof(T) == 8, "unsupported integer width");
+        return static_cast<T>(__builtin_bswap64(u));
+    }
+}
+
+// memcpy keeps these well-defined for unaligned pointers; compilers lower
+// them to a single (possibly byte-swapping) load or store.
+template <class T>
+inline T load_le(const uint8_t* p) noexcept {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) v = byteswap(v);
+    return v;
+}
+
+template <class T>
+inline T load_be(const uint8_t* p) noexcept {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    if constexpr (std::endian::native == std::endian::little) v = byteswap(v);
+    return v;
+}
+
+template <class T>
+inline void store_le(uint8_t* p, T v) noexcept {
+    if constexpr (std::endian::native == std::endian::big) v = byteswap(v);
+    std::memcpy(p, &v, sizeof(T));
+}
+
+template <class T>
+inline void store_be(uint8_t* p, T v) noexcept {
+    if constexpr (std::endian::native == std::endian::little) v = byteswap(v);
+    std::memcpy(p, &v, sizeof(T));
+}
+
+template <Endian E, class T>
+inline T load(const uint8_t* p) noexcept {
+    if constexpr (E == Endian::little) return load_le<T>(p);
+    else return load_be<T>(p);
+}
+
+template <Endian E, class T>
+inline void store(uint8_t* p, T v) noexcept {
+    if constexpr (E == Endian::little) store_le<T>(p, v);
+    else store_be<T>(p, v);
+}
+
+}  // namespace bpw
@@ -0,0 +1,88 @@
+// File-backed input for the bounded reader.
+//
+// Regular files are memory mapped read-only, so parsing reads straight out of
+// the page cache with no copy into heap buffers. As the caller reports
+// progress, the source issues madvise(MADV_WILLNEED) for a window ahead of
+// the parse position and optionally MADV_DONTNEED behind it. Inputs that
+// cannot be mapped fall back to a fixed-size chunk buffer filled with pread
+// (regular files) or read (pipes, sockets, character devices).
+//
+// POSIX only; implemented in src/file_source.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class FileSource {
+public:
+    struct Options {
+        // Bytes hinted with MADV_WILLNEED ahead of the parse position.
+        size_t readahead = size_t{8} << 20;
+        // Release pages behind the parse position (bounded RSS on huge files).
+        bool drop_behind = false;
+        // Chunk size for next_chunk(), and buffer size when not mapped.
+        size_t chunk_size = size_t{1} << 20;
+        // Never map; always use the buffered fallback.
+        bool disable_mmap = false;
+    };
+
+    FileSource() noexcept = default;
+    FileSource(const FileSource&) = delete;
+    FileSource& operator=(const FileSource&) = delete;
+    FileSource(FileSource&& o) noexcept;
+    FileSource& operator=(FileSource&& o) noexcept;
+    ~FileSource();
+
+    [[nodiscard]] static Status open(const char* path, FileSource& out, const Options& opts);
+    [[nodiscard]] static Status open(const char* path, FileSource& out) { return open(path, out, Options{}); }
+    // Take ownership of an already open descriptor (e.g. stdin or a pipe).
+    [[nodiscard]] static Status adopt(int fd, FileSource& out, const Options& opts);
+
+    bool is_open() const noexcept { return fd_ >= 0; }
+    bool mapped() const noexcept { return map_ != nullptr; }
+    // File size; 0 if unknown (pipes).
+    size_t size() const noexcept { return size_; }
+    // errno of the last failed system call.
+    int last_error() const noexcept { return errno_; }
+
+    // Whole file as one zero-copy reader. Only available when mapped();
+    // report progress with advise() while parsing it.
+    [[nodiscard]] Status reader(Reader& out) const noexcept;
+
+    // Update readahead / drop-behind hints for parse position `pos`. Cheap
+    // to call per record: the kernel is only asked again once the position
+    // has moved by half a readahead window.
+    void advise(size_t pos) noexcept;
+
+    // Sequential pull interface that works for every kind of input. Mapped
+    // files yield windows of the mapping; other inputs yield the internal
+    // buffer, valid until the next call. An empty span signals end of input.
+    [[nodiscard]] Status next_chunk(std::span<const uint8_t>& out);
+
+    void close() noexcept;
+
+private:
+    Status init(int fd, const Options& opts);
+    // Read ahead of `ahead_of`; drop behind `parsed`.
+    void advise(size_t ahead_of, size_t parsed) noexcept;
+
+    int fd_ = -1;
+    const uint8_t* map_ = nullptr;
+    size_t size_ = 0;
+    size_t pos_ = 0;          // next_chunk() position
+    size_t advised_to_ = 0;   // end of the last WILLNEED window
+    size_t dropped_to_ = 0;   // end of the last DONTNEED range
+    bool regular_ = false;
+    int errno_ = 0;
+    Options opts_;
+    std::unique_ptr<uint8_t[]> buf_;
+};
+
+}  // namespace bpw
@@ -0,0 +1,99 @@
+// Record framing: how to tell where one record ends and the next begins.
+//
+// A Framing is either a fixed record size or a length field at a fixed
+// position in a fixed-size header. It only needs the header bytes to compute
+// the size of the whole record, which is what the streaming, indexing and
+// bulk APIs need to split input without decoding it.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+struct Framing {
+    // Bytes that must be available before frame_size() can be called.
+    size_t header_size = 0;
+    // Non-zero: every record has exactly this many bytes.
+    size_t fixed_size = 0;
+    // Length field: `length_width` (1, 2, 4 or 8) bytes at `length_offset`.
+    size_t length_offset = 0;
+    uint8_t length_width = 0;
+    Endian length_endian = Endian::big;
+    // Record size = length field + length_adjust. Use header_size when the
+    // length counts only the payload, 0 when it counts the whole record.
+    int64_t length_adjust = 0;
+    // Records larger than this are rejected as malformed.
+    size_t max_size = SIZE_MAX;
+
+    static constexpr Framing fixed(size_t size) noexcept {
+        Framing f;
+        f.header_size = size;
+        f.fixed_size = size;
+        f.max_size = size;
+        return f;
+    }
+
+    // Header of `header` bytes containing a `width`-byte payload length at
+    // `offset`; the record is header + payload.
+    static constexpr Framing length_prefixed(size_t header, size_t offset, uint8_t width, Endian e,
+                                             size_t max_size = SIZE_MAX) noexcept {
+        Framing f;
+        f.header_size = header;
+        f.length_offset = offset;
+        f.length_width = width;
+        f.length_endian = e;
+        f.length_adjust = static_cast<int64_t>(header);
+        f.max_size = max_size;
+        return f;
+    }
+
+    constexpr bool valid() const noexcept {
+        if (header_size > max_size) return false;
+        if (fixed_size) return header_size <= fixed_size;
+        bool width_ok = length_width == 1 || length_width == 2 || length_width == 4 || length_width == 8;
+        return width_ok && header_size > 0 && length_offset + length_width <= header_size;
+    }
+
+    // Size of the record whose first header_size bytes are at `header`.
+    [[nodiscard]] Status frame_size(const uint8_t* header, size_t& out) const noexcept {
+        if (fixed_size) {
+            out = fixed_size;
+            return Status::ok;
+        }
+        const uint8_t* p = header + length_offset;
+        uint64_t len;
+        bool be = length_endian == Endian::big;
+        switch (length_width) {
+        case 1: len = p[0]; break;
+        case 2: len = be ? load_be<uint16_t>(p) : load_le<uint16_t>(p); break;
+        case 4: len = be ? load_be<uint32_t>(p) : load_le<uint32_t>(p); break;
+        case 8: len = be ? load_be<uint64_t>(p) : load_le<uint64_t>(p); break;
+        default: return Status::invalid_argument;
+        }
+        if (length_adjust >= 0) {
+            if (len > UINT64_MAX - static_cast<uint64_t>(length_adjust)) return Status::malformed;
+            len += static_cast<uint64_t>(length_adjust);
+        } else {
+            if (len < static_cast<uint64_t>(-length_adjust)) return Status::malformed;
+            len -= static_cast<uint64_t>(-length_adjust);
+        }
+        if (len < header_size || len == 0 || len > max_size) return Status::malformed;
+        out = static_cast<size_t>(len);
+        return Status::ok;
+    }
+
+    // Split the next whole record off `in`.
+    [[nodiscard]] Status next(Reader& in, Reader& record) const noexcept {
+        if (!in.has(header_size)) return in.bounds_error();
+        size_t n;
+        if (Status s = frame_size(in.data(), n); s != Status::ok) return s;
+        return in.sub_reader(n, record);
+    }
+};
+
+}  // namespace bpw
@@ -0,0 +1,277 @@
+// Compile-time record layout descriptors.
+//
+// A layout is declared once as a list of fields, each binding a struct member
+// to a byte offset, a width and an endianness:
+//
+//   struct Header { uint16_t type; uint32_t length; int8_t flags; };
+//   using HeaderLayout = bpw::Layout<Header,
+//       bpw::Field<&Header::type,   0, 2, bpw::Endian::big>,
+//       bpw::Field<&Header::length, 2, 3, bpw::Endian::big>,   // 24-bit
+//       bpw::Field<&Header::flags,  5, 1, bpw::Endian::big>>;
+//
+// decode()/encode() expand to one straight-line load or store per field;
+// there is no layout table to walk at run time, and because both directions
+// come from the same field list they cannot drift apart.
+//
+// Supported member types: integers, enums, bool (width <= sizeof(member);
+// narrower signed fields are sign extended), float/double (width ==
+// sizeof(member)) and arrays of a byte-sized type (width == array size).
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+namespace detail {
+
+template <class M>
+struct member_traits;
+
+template <class C, class T>
+struct member_traits<T C::*> {
+    using class_type = C;
+    using value_type = T;
+};
+
+template <class T>
+struct byte_array_traits : std::false_type {};
+template <class T, size_t N>
+struct byte_array_traits<T[N]> : std::bool_constant<sizeof(T) == 1> {
+    static constexpr size_t size = N;
+};
+template <class T, size_t N>
+struct byte_array_traits<std::array<T, N>> : std::bool_constant<sizeof(T) == 1> {
+    static constexpr size_t size = N;
+};
+
+// Load a W-byte unsigned integer (1 <= W <= 8).
+template <size_t W, Endian E>
+inline uint64_t load_uint(const uint8_t* p) noexcept {
+    if constexpr (W == 1) return p[0];
+    else if constexpr (W == 2) return load<E, uint16_t>(p);
+    else if constexpr (W == 4) return load<E, uint32_t>(p);
+    else if constexpr (W == 8) return load<E, uint64_t>(p);
+    else {
+        uint64_t v = 0;
+        for (size_t i = 0; i < W; ++i) {
+            size_t shift = E == Endian::little ? 8 * i : 8 * (W - 1 - i);
+            v |= static_cast<uint64_t>(p[i]) << shift;
+        }
+        return v;
+    }
+}
+
+template <size_t W, Endian E>
+inline void store_uint(uint8_t* p, uint64_t v) noexcept {
+    if constexpr (W == 1) p[0] = static_cast<uint8_t>(v);
+    else if constexpr (W == 2) store<E, uint16_t>(p, static_cast<uint16_t>(v));
+    else if constexpr (W == 4) store<E, uint32_t>(p, static_cast<uint32_t>(v));
+    else if constexpr (W == 8) store<E, uint64_t>(p, v);
+    else {
+        for (size_t i = 0; i < W; ++i) {
+            size_t shift = E == Endian::little ? 8 * i : 8 * (W - 1 - i);
+            p[i] = static_cast<uint8_t>(v >> shift);
+        }
+    }
+}
+
+template <class T, size_t W>
+constexpr bool field_width_ok() {
+    if constexpr (byte_array_traits<T>::value) return W == byte_array_traits<T>::size;
+    else if constexpr (std::is_floating_point_v<T>) return W == sizeof(T);
+    else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) return W >= 1 && W <= sizeof(T);
+    else return false;
+}
+
+template <class T, size_t W, Endian E>
+inline void load_value(const uint8_t* p, T& out) noexcept {
+    if constexpr (byte_array_traits<T>::value) {
+        std::memcpy(&out, p, W);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        out = std::bit_cast<T>(static_cast<U>(load_uint<W, E>(p)));
+    } else if constexpr (std::is_same_v<T, bool>) {
+        out = load_uint<W, E>(p) != 0;
+    } else if constexpr (std::is_enum_v<T>) {
+        std::underlying_type_t<T> u;
+        load_value<std::underlying_type_t<T>, W, E>(p, u);
+        out = static_cast<T>(u);
+    } else {
+        uint64_t raw = load_uint<W, E>(p);
+        if constexpr (std::is_signed_v<T> && W < 8) {
+            constexpr uint64_t sign = uint64_t{1} << (8 * W - 1);
+            raw = (raw ^ sign) - sign;
+        }
+        out = static_cast<T>(raw);
+    }
+}
+
+template <class T, size_t W, Endian E>
+inline void store_value(uint8_t* p, const T& v) noexcept {
+    if constexpr (byte_array_traits<T>::value) {
+        std::memcpy(p, &v, W);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+        store_uint<W, E>(p, std::bit_cast<U>(v));
+    } else if constexpr (std::is_enum_v<T>) {
+        store_uint<W, E>(p, static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(v)));
+    } else {
+        store_uint<W, E>(p, static_cast<uint64_t>(v));
+    }
+}
+
+template <class... Fields>
+constexpr bool fields_disjoint() {
+    constexpr size_t n = sizeof...(Fields);
+    constexpr std::array<size_t, n> offs{Fields::offset...};
+    constexpr std::array<size_t, n> ends{Fields::end...};
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = i + 1; j < n; ++j)
+            if (offs[i] < ends[j] && offs[j] < ends[i]) return false;
+    return true;
+}
+
+template <auto A, auto B>
+constexpr bool same_member() {
+    if constexpr (std::is_same_v<decltype(A), decltype(B)>) return A == B;
+    else return false;
+}
+
+// Position of the field bound to Member, or sizeof...(Fields) if none is.
+template <auto Member, class... Fields>
+constexpr size_t field_index() {
+    size_t i = 0, found = sizeof...(Fields);
+    ((same_member<Member, Fields::member>() && found == sizeof...(Fields) ? found = i : 0, ++i), ...);
+    return found;
+}
+
+}  // namespace detail
+
+// One field of a layout: member `Member` stored at byte `Offset`, `Width`
+// bytes wide, in byte order `E`.
+template <auto Member, size_t Offset, size_t Width, Endian E>
+struct Field {
+    using traits = detail::member_traits<decltype(Member)>;
+    using record_type = typename traits::class_type;
+    using value_type = typename traits::value_type;
+
+    static constexpr auto member = Member;
+    static constexpr size_t offset = Offset;
+    static constexpr size_t width = Width;
+    static constexpr size_t end = Offset + Width;
+    static constexpr Endian endian = E;
+
+    static_assert(detail::field_width_ok<value_type, Width>(),
+                  "field width does not fit the member type");
+
+    // p points at the start of the record.
+    static void decode(const uint8_t* p, record_type& r) noexcept {
+        detail::load_value<value_type, Width, E>(p + Offset, r.*Member);
+    }
+    // Single field straight out of an encoded record.
+    static void decode_value(const uint8_t* p, value_type& v) noexcept {
+        detail::load_value<value_type, Width, E>(p + Offset, v);
+    }
+    static auto get(const uint8_t* p) noexcept
+        requires(!std::is_array_v<value_type>)
+    {
+        value_type v;
+        decode_value(p, v);
+        return v;
+    }
+    static void encode(uint8_t* p, const record_type& r) noexcept {
+        detail::store_value<value_type, Width, E>(p + Offset, r.*Member);
+    }
+};
+
+template <class Record, class... Fields>
+struct Layout {
+    using record_type = Record;
+    using fields = std::tuple<Fields...>;
+    template <size_t I>
+    using field = std::tuple_element_t<I, fields>;
+    static constexpr size_t field_count = sizeof...(Fields);
+    template <auto Member>
+    static constexpr size_t index_of = detail::field_index<Member, Fields...>();
+    template <auto Member>
+    static constexpr bool has_member = index_of<Member> < field_count;
+    // Encoded size in bytes: the end of the last field.
+    static constexpr size_t size = std::max({size_t{0}, Fields::end...});
+
+    static_assert(field_count > 0, "a layout needs at least one field");
+    static_assert((std::is_same_v<typename Fields::record_type, Record> && ...),
+                  "every field must be a member of the layout's record type");
+
+    static_assert(detail::fields_disjoint<Fields...>(), "layout fields overlap");
+
+private:
+    // True when the fields tile [0, size) with no gaps, so encode() does
+    // not have to zero padding bytes first.
+    static constexpr bool dense = (Fields::width + ...) == size;
+
+public:
+    // Unchecked: p must reference at least `size` readable bytes.
+    static void decode(const uint8_t* p, Record& r) noexcept { (Fields::decode(p, r), ...); }
+
+    // Unchecked: p must reference at least `size` writable bytes. Gaps
+    // between fields are written as zero.
+    static void encode(uint8_t* p, const Record& r) noexcept {
+        if constexpr (!dense) std::memset(p, 0, size);
+        (Fields::encode(p, r), ...);
+    }
+
+    // Checked once for the whole record, then decoded field by field.
+    [[nodiscard]] static Status parse(Reader& in, Record& r) noexcept {
+        if (!in.has(size)) return in.bounds_error();
+        decode(in.data(), r);
+        in.count_records();
+        return in.skip(size);
+    }
+
+    [[nodiscard]] static Status write(Writer& out, const Record& r) noexcept {
+        uint8_t* p = out.prepare(size);
+        if (!p) return out.failure();
+        encode(p, r);
+        out.commit(size);
+        out.count_records();
+        return Status::ok;
+    }
+
+    // Encoded size of a record or a batch. The layout is fixed, so this is
+    // a constant; use it to size the output before a bulk encode.
+    static constexpr size_t serialized_size(const Record&) noexcept { return size; }
+    static constexpr size_t serialized_size(std::span<const Record> rs) noexcept {
+        return rs.size() > SIZE_MAX / size ? SIZE_MAX : rs.size() * size;
+    }
+
+    // Encode a batch back to back: space for all of it is obtained once,
+    // then each record is stored with no further capacity checks.
+    [[nodiscard]] static Status write_many(Writer& out, std::span<const Record> rs) noexcept {
+        if (rs.size() > SIZE_MAX / size) return Status::invalid_argument;
+        const size_t n = rs.size() * size;
+        uint8_t* p = out.prepare(n);
+        if (!p) return out.failure();
+        for (const Record& r : rs) {
+            encode(p, r);
+            p += size;
+        }
+        out.commit(n);
+        out.count_records(rs.size());
+        return Status::ok;
+    }
+};
+
+}  // namespace bpw
@@ -0,0 +1,77 @@
+// Cache of compiled RuntimeLayouts keyed by a hash of the schema.
+//
+// get() compiles a schema the first time it is seen and hands out the same
+// layout for every later request with an identical schema, from any thread.
+// The hash only picks the bucket; a hit also compares the full field list,
+// so colliding schemas are never confused. Field order does not matter: the
+// schema is taken sorted by wire offset, as compile() sorts it.
+//
+// save() writes every cached program to disk, and load() at the next start
+// brings them back without compiling: the saved ops are bounds checked
+// against the layout sizes and linked to the handlers of the running
+// binary. A file written by a binary with different handler tables is
+// rejected as unsupported and the layouts are simply compiled again.
+//
+// On-disk format (all integers little endian):
+//
+//   magic "BPWLAYC1", u32 version, u32 entry_count,
+//   { u64 schema_hash, u32 size, u32 crc32c, u8 program[size] }[entry_count]
+//
+// where program is RuntimeLayout::save() output.
+//
+// Implemented in src/layout_cache.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+#include "bpw/reader.hpp"
+#include "bpw/runtime_layout.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+// 64-bit hash of the canonical (offset-sorted) schema.
+[[nodiscard]] uint64_t schema_hash(std::span<const RuntimeField> fields, size_t target_size);
+
+class LayoutCache {
+public:
+    static constexpr uint32_t version = 1;
+
+    LayoutCache() = default;
+    LayoutCache(const LayoutCache&) = delete;
+    LayoutCache& operator=(const LayoutCache&) = delete;
+
+    // Layout for the schema, compiled on first use. The pointer stays valid
+    // for the lifetime of the cache. Fails as compile() does.
+    [[nodiscard]] Status get(std::span<const RuntimeField> fields, size_t target_size, const RuntimeLayout*& out);
+
+    size_t size() const;
+    // get() calls that had to compile (diagnostics and tests).
+    size_t compilations() const;
+
+    [[nodiscard]] Status serialize(Writer& out) const;
+    // Add the entries of a serialized cache. Nothing is added unless the
+    // whole input is valid; schemas already cached are kept as they are.
+    [[nodiscard]] Status deserialize(Reader in);
+
+    // Written to a uniquely named temporary file, synced and renamed (then
+    // the directory is synced), so neither a crash, a concurrent save() nor
+    // a concurrent load() ever sees a partial cache.
+    [[nodiscard]] Status save(const char* path) const;
+    [[nodiscard]] Status load(const char* path);
+
+private:
+    const RuntimeLayout* find(uint64_t hash, std::span<const RuntimeField> sorted, size_t target_size) const;
+
+    mutable std::mutex m_;
+    std::unordered_multimap<uint64_t, std::unique_ptr<RuntimeLayout>> layouts_;
+    size_t compilations_ = 0;
+};
+
+}  // namespace bpw
@@ -0,0 +1,100 @@
+// NUMA topology, thread pinning and node-local memory.
+//
+// Linux places a page on the node of the thread that first touches it. So
+// the cheap way to keep a parallel decode node-local is to pin the pool's
+// workers (ThreadPoolOptions::pinning) and let each worker be the first to
+// write its own buffers: arenas used only by one worker, the part of an
+// output column it fills, slices of the input it reads in with pread().
+// NumaBuffer helps with the last two. It maps memory without touching it,
+// unlike std::vector, which zero-fills on the allocating thread. It can also
+// bind the memory to one node explicitly.
+//
+// Talks to the kernel through sysfs and the raw mbind / getcpu system calls,
+// so libnuma is not needed. Elsewhere, or when the kernel has no NUMA
+// support, the machine looks like a single node; pinning and binding then
+// report Status::unsupported and callers carry on unpinned.
+//
+// Implemented in src/numa.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class NumaTopology {
+public:
+    // Nodes and the CPUs this process may run on. Without sysfs the result
+    // is one node holding every allowed CPU; only allocation can fail.
+    [[nodiscard]] static Status detect(NumaTopology& out);
+
+    unsigned nodes() const noexcept { return static_cast<unsigned>(cpus_.size()); }
+    // Allowed CPUs of `node`, ascending; may be empty (memory-only nodes).
+    std::span<const unsigned> cpus(unsigned node) const noexcept {
+        return node < cpus_.size() ? std::span<const unsigned>(cpus_[node]) : std::span<const unsigned>();
+    }
+    // Kernel node number of index `node` (node ids may be sparse).
+    unsigned node_id(unsigned node) const noexcept { return node < ids_.size() ? ids_[node] : 0; }
+
+private:
+    std::vector<unsigned> ids_;
+    std::vector<std::vector<unsigned>> cpus_;
+};
+
+// Restrict the calling thread to `cpus`.
+[[nodiscard]] Status pin_current_thread(std::span<const unsigned> cpus) noexcept;
+
+// Kernel node number the calling thread is running on, or -1 if unknown.
+int current_numa_node() noexcept;
+
+// Prefer kernel node `node_id` for the pages of [p, p + n), moving pages
+// that are already resident. The range is widened to whole pages.
+[[nodiscard]] Status bind_to_node(void* p, size_t n, unsigned node_id) noexcept;
+
+// Page-aligned, zero-initialised memory that is mapped but not touched, so
+// each page lands on the node that first writes it, or on `node_id` if one
+// is given.
+class NumaBuffer {
+public:
+    static constexpr int first_touch = -1;
+
+    NumaBuffer() noexcept = default;
+    NumaBuffer(const NumaBuffer&) = delete;
+    NumaBuffer& operator=(const NumaBuffer&) = delete;
+    NumaBuffer(NumaBuffer&& o) noexcept
+        : data_(std::exchange(o.data_, nullptr)), size_(std::exchange(o.size_, 0)) {}
+    NumaBuffer& operator=(NumaBuffer&& o) noexcept {
+        if (this != &o) {
+            release();
+            data_ = std::exchange(o.data_, nullptr);
+            size_ = std::exchange(o.size_, 0);
+        }
+        return *this;
+    }
+    ~NumaBuffer() { release(); }
+
+    // A failed bind is not an error: the memory stays first-touch.
+    [[nodiscard]] static Status allocate(size_t n, NumaBuffer& out, int node_id = first_touch) noexcept;
+
+    uint8_t* data() noexcept { return data_; }
+    const uint8_t* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+
+    template <class T>
+    T* as() noexcept {
+        return reinterpret_cast<T*>(data_);
+    }
+
+    void release() noexcept;
+
+private:
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace bpw
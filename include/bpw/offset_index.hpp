@@ -0,0 +1,106 @@
+// Persistent sidecar index from record number (and optionally a key) to
+// byte offset, for random access into large framed files.
+//
+// The index keeps the offset of every `stride`-th record; seek(k) jumps to
+// the nearest checkpoint at or before record k and walks at most stride - 1
+// record headers from there. A keyed index additionally stores one
+// (key, record number) pair per record, sorted by key.
+//
+// On-disk format (all integers little endian):
+//
+//   magic "BPWIDX01", u32 version, u32 stride, u64 record_count,
+//   u64 source_size, u64 checkpoint_count, u64 key_count,
+//   u64 checkpoints[checkpoint_count],
+//   { u64 key, u64 record }[key_count]
+//
+// Implemented in src/offset_index.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+class OffsetIndex {
+public:
+    static constexpr uint32_t version = 1;
+
+    OffsetIndex() = default;
+
+    // Scan `in` once and record every stride-th record offset.
+    [[nodiscard]] static Status build(Reader in, const Framing& framing, uint32_t stride, OffsetIndex& out) {
+        return scan(in, framing, stride, out, nullptr);
+    }
+
+    // As build(), additionally recording key_fn(Reader& record) -> uint64_t
+    // for every record.
+    template <class KeyFn>
+    [[nodiscard]] static Status build_keyed(Reader in, const Framing& framing, uint32_t stride, OffsetIndex& out,
+                                            KeyFn&& key_fn) {
+        return scan(in, framing, stride, out, key_fn);
+    }
+
+    uint64_t record_count() const noexcept { return record_count_; }
+    uint64_t source_size() const noexcept { return source_size_; }
+    uint32_t stride() const noexcept { return stride_; }
+    bool keyed() const noexcept { return !keys_.empty(); }
+
+    // True if the index was built from an input of this size.
+    bool matches(size_t source_size) const noexcept { return source_size == source_size_; }
+
+    // Position a reader over the indexed input (`in` covers the whole file)
+    // at the start of record k.
+    [[nodiscard]] Status seek(Reader in, const Framing& framing, uint64_t record, Reader& out) const noexcept;
+
+    // First record with this key, or Status::out_of_bounds if none.
+    [[nodiscard]] Status find_key(uint64_t key, uint64_t& record) const noexcept;
+
+    [[nodiscard]] Status serialize(Writer& out) const noexcept;
+    [[nodiscard]] static Status deserialize(Reader in, OffsetIndex& out);
+
+    // Written to a uniquely named temporary file, synced and renamed over
+    // `path` (then the directory is synced), so a crash, a concurrent save()
+    // or a concurrent load() sees the old index or the new one, never a
+    // truncated one.
+    [[nodiscard]] Status save(const char* path) const;
+    [[nodiscard]] static Status load(const char* path, OffsetIndex& out);
+
+private:
+    template <class KeyFn>
+    static Status scan(Reader in, const Framing& framing, uint32_t stride, OffsetIndex& out, KeyFn&& key_fn) {
+        constexpr bool with_keys = !std::is_same_v<std::decay_t<KeyFn>, std::nullptr_t>;
+        out = OffsetIndex();
+        if (!framing.valid() || stride == 0) return Status::invalid_argument;
+        out.stride_ = stride;
+        out.source_size_ = in.remaining();
+        const size_t base = in.position();
+        for (uint64_t k = 0; !in.empty(); ++k) {
+            size_t off = in.position() - base;
+            Reader rec;
+            if (Status s = framing.next(in, rec); s != Status::ok) return s;
+            if (k % stride == 0) out.checkpoints_.push_back(off);
+            if constexpr (with_keys) out.keys_.emplace_back(static_cast<uint64_t>(key_fn(rec)), k);
+            ++out.record_count_;
+        }
+        if constexpr (with_keys) out.sort_keys();
+        return Status::ok;
+    }
+
+    void sort_keys();
+
+    uint32_t stride_ = 1;
+    uint64_t record_count_ = 0;
+    uint64_t source_size_ = 0;
+    std::vector<uint64_t> checkpoints_;                   // offset of record i * stride
+    std::vector<std::pair<uint64_t, uint64_t>> keys_;    // (key, record), sorted
+};
+
+}  // namespace bpw
@@ -0,0 +1,85 @@
+// Parallel decoding of large inputs split at record boundaries.
+//
+// Decoding runs in two steps. A planning pass finds record boundaries and
+// groups whole records into byte ranges of roughly `target_bytes`:
+//
+//   - plan_ranges() walks a Framing (fixed or length-prefixed records). It
+//     only reads record headers, so it is much cheaper than decoding.
+//   - plan_sync_ranges() splits formats with a sync marker by searching for
+//     the marker near evenly spaced cut points, without touching the rest
+//     of the input.
+//
+// parallel_decode() then runs a decode function over every range on a
+// ThreadPool and stores each range's result at that range's index, so the
+// results come back in input order no matter which worker finished first.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+#include "bpw/thread_pool.hpp"
+
+namespace bpw {
+
+// Offsets are relative to the planned Reader's position when it was
+// planned, not to the start of its buffer; pass the same Reader, at the
+// same position, to parallel_decode() or range_reader().
+struct Range {
+    size_t offset = 0;        // byte offset from the planned position
+    size_t size = 0;          // bytes in the range
+    size_t first_record = 0;  // index of the first record (framed plans only)
+    size_t record_count = 0;  // records in the range (framed plans only)
+};
+
+// Split `in` into ranges of whole records of about target_bytes each. Fails
+// with the framing error if a record header is invalid, or out_of_bounds if
+// the input ends inside a record.
+[[nodiscard]] Status plan_ranges(Reader in, const Framing& framing, size_t target_bytes, std::vector<Range>& out);
+
+// Split `in` into ranges that each start with `marker` (except possibly the
+// first, which starts at offset 0). The format must guarantee the marker
+// cannot occur inside a record.
+[[nodiscard]] Status plan_sync_ranges(Reader in, std::span<const uint8_t> marker, size_t target_bytes,
+                                      std::vector<Range>& out);
+
+// Reader over range r of `in`, which must be at the planned position. Like
+// slice(), the result reports to in's stats; re-attach before handing it
+// to another thread.
+[[nodiscard]] inline Status range_reader(const Reader& in, const Range& r, Reader& out) noexcept {
+    if (r.offset > in.remaining() || r.size > in.remaining() - r.offset) return in.bounds_error();
+    out = Reader(in.data() + r.offset, r.size);
+    out.set_stats(in.stats());
+    return Status::ok;
+}
+
+// Run fn(const Range&, Reader& chunk, Result&) -> Status for every range in
+// parallel. results[i] belongs to ranges[i]. Returns ok, or the error of the
+// lowest-indexed failing range.
+template <class Result, class F>
+[[nodiscard]] Status parallel_decode(ThreadPool& pool, Reader in, std::span<const Range> ranges,
+                                     std::vector<Result>& results, F&& fn) {
+    results.clear();
+    results.resize(ranges.size());
+    std::vector<Status> status(ranges.size(), Status::ok);
+    // Stats are not atomic: each range counts privately, merged below.
+    ReadStats* const shared = in.stats();
+    std::vector<ReadStats> local(shared ? ranges.size() : 0);
+    pool.parallel_for(ranges.size(), [&](size_t i) {
+        Reader chunk;
+        status[i] = range_reader(in, ranges[i], chunk);
+        chunk.set_stats(shared ? &local[i] : nullptr);
+        if (status[i] == Status::ok) status[i] = fn(ranges[i], chunk, results[i]);
+    });
+    for (const ReadStats& l : local) *shared += l;
+    for (Status s : status)
+        if (s != Status::ok) return s;
+    return Status::ok;
+}
+
+}  // namespace bpw
@@ -0,0 +1,212 @@
+// Pipelined decode -> transform -> encode over planned input ranges.
+//
+// run_pipeline() converts one framed input into an output stream using
+// three stages, each on its own set of threads, so that parsing, the user's
+// transform and encoding overlap instead of running back to back:
+//
+//   decode     Status(const Range&, Reader& chunk, Batch& batch)
+//   transform  Status(const Range&, Batch& batch)
+//   encode     Status(const Range&, const Batch& batch, Writer& out)
+//   output     Status(const Range&, std::span<const uint8_t> bytes)
+//
+// The input is split beforehand with plan_ranges() / plan_sync_ranges()
+// (bpw/parallel.hpp); each range becomes one batch. Stages pass batches
+// through bounded MpmcRing queues (bpw/ring.hpp). A fixed pool of
+// max_in_flight work items, each holding a Batch and an encode Writer, is
+// allocated up front and recycled, so once the buffers have grown the
+// pipeline stops allocating. output runs on the calling thread and sees the
+// ranges in input order, whatever order the workers finished in.
+//
+// Batches are recycled: decode receives one left over from an earlier
+// range and should clear it first. Stage functions must not throw; they may
+// run concurrently with themselves, except output. The first failing range
+// (lowest index) stops the pipeline and its status is returned; ranges
+// before it have already been output.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "bpw/parallel.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/ring.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+struct PipelineOptions {
+    unsigned decode_threads = 1;
+    unsigned transform_threads = 1;
+    unsigned encode_threads = 1;
+    // Batches alive across all stages, including the output reorder window.
+    // 0 picks twice the number of worker threads.
+    size_t max_in_flight = 0;
+};
+
+namespace detail {
+
+template <class Batch>
+struct PipelineItem {
+    size_t index = 0;
+    Status status = Status::ok;
+    Batch batch;
+    Writer bytes;
+};
+
+// Move items from `in` to `out` through fn until `upstream` producers are
+// done and `in` is drained.
+template <class Item, class F>
+void pipeline_stage(MpmcRing<Item*>& in, const std::atomic<unsigned>& upstream, MpmcRing<Item*>& out,
+                    const std::atomic<bool>& abort, F& fn) noexcept {
+    Backoff wait;
+    for (;;) {
+        Item* it = nullptr;
+        if (!in.try_pop(it)) {
+            if (upstream.load(std::memory_order_acquire) != 0) {
+                wait.pause();
+                continue;
+            }
+            // Producers are done; whatever they pushed is visible now.
+            if (!in.try_pop(it)) return;
+        }
+        wait.reset();
+        if (it->status == Status::ok && !abort.load(std::memory_order_relaxed)) it->status = fn(*it);
+        while (!out.try_push(std::move(it))) wait.pause();
+    }
+}
+
+}  // namespace detail
+
+template <class Batch, class Decode, class Transform, class Encode, class Output>
+[[nodiscard]] Status run_pipeline(Reader in, std::span<const Range> ranges, const PipelineOptions& opts,
+                                  Decode&& decode, Transform&& transform, Encode&& encode, Output&& output) {
+    using Item = detail::PipelineItem<Batch>;
+    if (ranges.empty()) return Status::ok;
+
+    const unsigned nd = std::max(1u, opts.decode_threads);
+    const unsigned nt = std::max(1u, opts.transform_threads);
+    const unsigned ne = std::max(1u, opts.encode_threads);
+    const size_t pool = std::min(ranges.size(),
+                                 opts.max_in_flight ? opts.max_in_flight : 2 * size_t{nd + nt + ne});
+
+    // Every ring can hold the whole pool, so pushes only fail transiently.
+    std::unique_ptr<Item[]> items(new (std::nothrow) Item[pool]);
+    std::unique_ptr<Item*[]> reorder(new (std::nothrow) Item*[pool]());
+    MpmcRing<Item*> free_items(pool), decoded(pool), transformed(pool), encoded(pool);
+    if (!items || !reorder || !free_items.valid() || !decoded.valid() || !transformed.valid() || !encoded.valid())
+        return Status::out_of_memory;
+    for (size_t i = 0; i < pool; ++i) (void)free_items.try_push(&items[i]);
+
+    // Stats are not atomic: each range counts privately, merged on return.
+    ReadStats* const shared = in.stats();
+    std::vector<ReadStats> local;
+    try {
+        local.resize(shared ? ranges.size() : 0);
+    } catch (const std::bad_alloc&) {
+        return Status::out_of_memory;
+    }
+
+    std::atomic<size_t> next_range{0};
+    std::atomic<bool> abort{false};
+    std::atomic<unsigned> decoders{nd}, transformers{nt}, encoders{ne};
+
+    auto decode_loop = [&] {
+        Backoff wait;
+        while (!abort.load(std::memory_order_relaxed)) {
+            Item* it = nullptr;
+            if (!free_items.try_pop(it)) {
+                wait.pause();
+                continue;
+            }
+            wait.reset();
+            // Claim a range only while holding an item, which keeps every
+            // in-flight index within `pool` of the next one to be output.
+            size_t i = next_range.fetch_add(1, std::memory_order_relaxed);
+            if (i >= ranges.size()) {
+                (void)free_items.try_push(std::move(it));
+                break;
+            }
+            it->index = i;
+            Reader chunk;
+            it->status = range_reader(in, ranges[i], chunk);
+            chunk.set_stats(shared ? &local[i] : nullptr);
+            if (it->status == Status::ok) it->status = decode(ranges[i], chunk, it->batch);
+            while (!decoded.try_push(std::move(it))) wait.pause();
+        }
+        decoders.fetch_sub(1, std::memory_order_release);
+    };
+    auto transform_fn = [&](Item& it) { return transform(ranges[it.index], it.batch); };
+    auto encode_fn = [&](Item& it) {
+        it.bytes.clear();
+        return encode(ranges[it.index], static_cast<const Batch&>(it.batch), it.bytes);
+    };
+    auto transform_loop = [&] {
+        detail::pipeline_stage(decoded, decoders, transformed, abort, transform_fn);
+        transformers.fetch_sub(1, std::memory_order_release);
+    };
+    auto encode_loop = [&] {
+        detail::pipeline_stage(transformed, transformers, encoded, abort, encode_fn);
+        encoders.fetch_sub(1, std::memory_order_release);
+    };
+
+    std::vector<std::thread> threads;
+    auto spawn = [&](auto& loop, unsigned n, std::atomic<unsigned>& running) {
+        for (unsigned i = 0; i < n; ++i) {
+            try {
+                threads.emplace_back(loop);
+            } catch (const std::exception&) {
+                // Threads that never started count as finished.
+                running.fetch_sub(n - i, std::memory_order_release);
+                abort.store(true, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        return true;
+    };
+    bool started = spawn(decode_loop, nd, decoders);
+    started = spawn(transform_loop, nt, transformers) && started;
+    started = spawn(encode_loop, ne, encoders) && started;
+
+    // Output in range order; items that arrive early wait in `reorder`.
+    Status result = started ? Status::ok : Status::out_of_memory;
+    size_t next = 0;
+    Backoff wait;
+    for (;;) {
+        Item* it = nullptr;
+        if (!encoded.try_pop(it)) {
+            if (encoders.load(std::memory_order_acquire) != 0) {
+                wait.pause();
+                continue;
+            }
+            if (!encoded.try_pop(it)) break;
+        }
+        wait.reset();
+        reorder[it->index % pool] = it;
+        while (Item* ready = reorder[next % pool]) {
+            reorder[next % pool] = nullptr;
+            if (result == Status::ok) {
+                result = ready->status;
+                if (result == Status::ok) result = output(ranges[next], {ready->bytes.data(), ready->bytes.size()});
+                if (result != Status::ok) abort.store(true, std::memory_order_relaxed);
+            }
+            ++next;
+            (void)free_items.try_push(std::move(ready));
+        }
+    }
+
+    for (std::thread& t : threads) t.join();
+    for (const ReadStats& l : local) *shared += l;
+    return result;
+}
+
+}  // namespace bpw
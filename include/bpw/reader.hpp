@@ -0,0 +1,169 @@
+// Zero-copy bounded reader over a caller-owned byte buffer.
+//
+// Reader never allocates and never copies the input; it is three pointers
+// wide (four with BPW_STATS) and cheap to pass by value. Every other read
+// API in the module (bit reader, layouts, streaming parser, ...) is built
+// on top of it.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "bpw/endian.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class Reader {
+public:
+    constexpr Reader() noexcept = default;
+    constexpr Reader(const uint8_t* data, size_t size) noexcept
+        : begin_(data), cur_(data), end_(data + size) {}
+    constexpr explicit Reader(std::span<const uint8_t> bytes) noexcept
+        : Reader(bytes.data(), bytes.size()) {}
+
+    // Buffer geometry.
+    constexpr const uint8_t* begin() const noexcept { return begin_; }
+    constexpr const uint8_t* end() const noexcept { return end_; }
+    constexpr const uint8_t* data() const noexcept { return cur_; }
+    constexpr size_t size() const noexcept { return static_cast<size_t>(end_ - begin_); }
+    constexpr size_t position() const noexcept { return static_cast<size_t>(cur_ - begin_); }
+    constexpr size_t remaining() const noexcept { return static_cast<size_t>(end_ - cur_); }
+    constexpr bool empty() const noexcept { return cur_ == end_; }
+    constexpr bool has(size_t n) const noexcept { return n <= remaining(); }
+
+    // Unread part of the buffer, without consuming it.
+    constexpr std::span<const uint8_t> rest() const noexcept { return {cur_, remaining()}; }
+
+    // Counters (bpw/stats.hpp); no-ops unless built with BPW_STATS.
+    void set_stats([[maybe_unused]] ReadStats* s) noexcept {
+#if BPW_STATS
+        stats_ = s;
+#endif
+    }
+    ReadStats* stats() const noexcept {
+#if BPW_STATS
+        return stats_;
+#else
+        return nullptr;
+#endif
+    }
+    void count_records([[maybe_unused]] uint64_t n = 1) const noexcept { BPW_COUNT(stats_, records, n); }
+    void count_slow_path() const noexcept { BPW_COUNT(stats_, slow_paths, 1); }
+
+    // Status::out_of_bounds, counted as a bounds failure. For decoders
+    // built on top of Reader that check has() themselves.
+    [[nodiscard]] Status bounds_error() const noexcept {
+        BPW_COUNT(stats_, bounds_failures, 1);
+        return Status::out_of_bounds;
+    }
+
+    [[nodiscard]] Status seek(size_t pos) noexcept {
+        if (pos > size()) return bounds_error();
+        cur_ = begin_ + pos;
+        return Status::ok;
+    }
+
+    [[nodiscard]] Status skip(size_t n) noexcept {
+        if (!has(n)) return bounds_error();
+        advance(n);
+        return Status::ok;
+    }
+
+    // Point `out` at the next n bytes and consume them. No data is copied;
+    // the span stays valid as long as the caller's buffer does.
+    [[nodiscard]] Status read_bytes(size_t n, std::span<const uint8_t>& out) noexcept {
+        if (!has(n)) return bounds_error();
+        out = {cur_, n};
+        advance(n);
+        return Status::ok;
+    }
+
+    // Copy the next n bytes into dst. Only for callers that need an owned
+    // copy; prefer read_bytes().
+    [[nodiscard]] Status copy_to(void* dst, size_t n) noexcept {
+        if (!has(n)) return bounds_error();
+        std::memcpy(dst, cur_, n);
+        advance(n);
+        return Status::ok;
+    }
+
+    // Carve the next n bytes off as an independent reader and consume them.
+    // O(1): the child refers to the same underlying buffer.
+    [[nodiscard]] Status sub_reader(size_t n, Reader& out) noexcept {
+        if (!has(n)) return bounds_error();
+        out = Reader(cur_, n);
+        out.set_stats(stats());
+        advance(n);
+        return Status::ok;
+    }
+
+    // Reader over [offset, offset + n) of the whole buffer. Does not move
+    // this reader's position.
+    [[nodiscard]] Status slice(size_t offset, size_t n, Reader& out) const noexcept {
+        if (offset > size() || n > size() - offset) return bounds_error();
+        out = Reader(begin_ + offset, n);
+        out.set_stats(stats());
+        return Status::ok;
+    }
+
+    template <class T>
+    [[nodiscard]] Status read_le(T& out) noexcept {
+        static_assert(std::is_integral_v<T>, "read_le requires an integer type");
+        if (!has(sizeof(T))) return bounds_error();
+        out = load_le<T>(cur_);
+        advance(sizeof(T));
+        return Status::ok;
+    }
+
+    template <class T>
+    [[nodiscard]] Status read_be(T& out) noexcept {
+        static_assert(std::is_integral_v<T>, "read_be requires an integer type");
+        if (!has(sizeof(T))) return bounds_error();
+        out = load_be<T>(cur_);
+        advance(sizeof(T));
+        return Status::ok;
+    }
+
+    template <Endian E, class T>
+    [[nodiscard]] Status read(T& out) noexcept {
+        if constexpr (E == Endian::little) return read_le(out);
+        else return read_be(out);
+    }
+
+    [[nodiscard]] Status read_u8(uint8_t& out) noexcept { return read_le(out); }
+
+    // Peek without consuming.
+    template <class T>
+    [[nodiscard]] Status peek_le(T& out) const noexcept {
+        if (!has(sizeof(T))) return bounds_error();
+        out = load_le<T>(cur_);
+        return Status::ok;
+    }
+
+    template <class T>
+    [[nodiscard]] Status peek_be(T& out) const noexcept {
+        if (!has(sizeof(T))) return bounds_error();
+        out = load_be<T>(cur_);
+        return Status::ok;
+    }
+
+private:
+    void advance(size_t n) noexcept {
+        cur_ += n;
+        BPW_COUNT(stats_, bytes, n);
+    }
+
+    const uint8_t* begin_ = nullptr;
+    const uint8_t* cur_ = nullptr;
+    const uint8_t* end_ = nullptr;
+#if BPW_STATS
+    ReadStats* stats_ = nullptr;
+#endif
+};
+
+}  // namespace bpw
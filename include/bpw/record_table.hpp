@@ -0,0 +1,116 @@
+// Two-pass bulk decoding of framed (fixed-size or length-prefixed) streams.
+//
+// Pass 1, RecordTable::build(), finds every record boundary and stores the
+// prefix sums of the record sizes as an offset table: offsets()[i] is where
+// record i starts and offsets()[size()] is the end of the last record.
+// Fixed-size streams need no scan; the table is filled arithmetically. For
+// length-prefixed streams each length depends on where the previous record
+// ended, so the scan is inherently a serial chain. It runs as a tight loop
+// specialised for the length field's width and byte order that reads only
+// the length bytes, which is cheaper than walking Framing::next and far
+// cheaper than decoding.
+//
+// Pass 2 decodes records independently using the table: record() is O(1)
+// for any index, decode_records() runs a decode function over all records
+// on a ThreadPool, and ranges() groups records into byte ranges for
+// parallel_decode() without scanning again.
+//
+// Implemented in src/record_table.cpp.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bpw/framing.hpp"
+#include "bpw/parallel.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+#include "bpw/thread_pool.hpp"
+
+namespace bpw {
+
+class RecordTable {
+public:
+    RecordTable() = default;
+
+    // Scan `in` (from its current position) and record every record
+    // boundary. Fails with invalid_argument for an invalid framing, the
+    // framing's error for a bad length, or out_of_bounds if the input ends
+    // inside a record.
+    [[nodiscard]] static Status build(Reader in, const Framing& framing, RecordTable& out);
+
+    // Number of records.
+    size_t size() const noexcept { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    bool empty() const noexcept { return size() == 0; }
+    // size() + 1 offsets relative to the scanned position.
+    std::span<const size_t> offsets() const noexcept { return offsets_; }
+    // Bytes covered by the records.
+    size_t bytes() const noexcept { return offsets_.empty() ? 0 : offsets_.back(); }
+
+    // Record i of the input the table was built from, which `in` must cover
+    // from the same starting position. Unchecked beyond i < size(). Like
+    // slice(), the record reports to in's stats, so use it on the thread
+    // that owns them or re-attach; decode_records() does the latter.
+    [[nodiscard]] Status record(const Reader& in, size_t i, Reader& out) const noexcept {
+        if (i >= size() || in.remaining() < bytes()) return Status::out_of_bounds;
+        out = Reader(in.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+        out.set_stats(in.stats());
+        return Status::ok;
+    }
+
+    // Group whole records into ranges of about target_bytes, as
+    // plan_ranges() would, straight from the table.
+    [[nodiscard]] Status ranges(size_t target_bytes, std::vector<Range>& out) const;
+
+private:
+    std::vector<size_t> offsets_;
+};
+
+// Run fn(size_t index, Reader& record) -> Status for every record in
+// parallel, `grain` consecutive records per task. Records are independent,
+// so they may be decoded in any order; write results by index. Returns ok
+// or the error of the lowest-indexed failing record; records after a
+// failure in the same task are skipped.
+template <class F>
+[[nodiscard]] Status decode_records(ThreadPool& pool, const Reader& in, const RecordTable& table, F&& fn,
+                                    size_t grain = 1024) {
+    if (table.empty()) return Status::ok;
+    if (in.remaining() < table.bytes()) return Status::out_of_bounds;
+    if (grain == 0) grain = 1;
+    const size_t n = table.size();
+    const size_t tasks = (n + grain - 1) / grain;
+    const std::span<const size_t> off = table.offsets();
+    const uint8_t* base = in.data();
+
+    std::atomic<size_t> first_error{SIZE_MAX};
+    std::vector<Status> status(tasks, Status::ok);
+    // Stats are not atomic: each task counts privately, merged below.
+    ReadStats* const shared = in.stats();
+    std::vector<ReadStats> local(shared ? tasks : 0);
+    pool.parallel_for(tasks, [&](size_t t) {
+        const size_t end = t + 1 == tasks ? n : (t + 1) * grain;
+        for (size_t i = t * grain; i < end; ++i) {
+            // Records past a known failure cannot change the result.
+            if (i > first_error.load(std::memory_order_relaxed)) return;
+            Reader rec(base + off[i], off[i + 1] - off[i]);
+            rec.set_stats(shared ? &local[t] : nullptr);
+            if (Status s = fn(i, rec); s != Status::ok) {
+                status[t] = s;
+                size_t cur = first_error.load(std::memory_order_relaxed);
+                while (i < cur && !first_error.compare_exchange_weak(cur, i, std::memory_order_relaxed)) {
+                }
+                return;
+            }
+        }
+    });
+    for (const ReadStats& l : local) *shared += l;
+    for (Status s : status)
+        if (s != Status::ok) return s;
+    return Status::ok;
+}
+
+}  // namespace bpw
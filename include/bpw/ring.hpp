@@ -0,0 +1,187 @@
+// Bounded lock-free ring buffers for handing work between threads.
+//
+// SpscRing connects exactly one producer thread to one consumer thread:
+// push and pop are a load and a store each, and each side caches the other
+// side's index so it touches the shared cache line only when the ring looks
+// full or empty. MpmcRing allows any number of producers and consumers. It
+// uses a per-cell sequence number, so a push or pop claims an index with
+// one compare-and-swap and never waits for a slower thread on another cell.
+//
+// Both are non-blocking: try_push() fails when the ring is full and
+// try_pop() when it is empty. Capacities are rounded up to a power of two.
+// Construction allocates once and never throws; check valid().
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace bpw {
+
+namespace detail {
+
+inline constexpr size_t cache_line = 64;
+
+inline size_t ring_capacity(size_t n) noexcept {
+    return n < 2 ? 2 : std::bit_ceil(n);
+}
+
+}  // namespace detail
+
+// Spin briefly, then yield, while waiting on a ring. Call reset() after
+// making progress.
+class Backoff {
+public:
+    void pause() noexcept {
+        if (spins_ < 64) {
+            ++spins_;
+#if defined(__x86_64__) || defined(__i386__)
+            _mm_pause();
+#elif defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    void reset() noexcept { spins_ = 0; }
+
+private:
+    unsigned spins_ = 0;
+};
+
+template <class T>
+class SpscRing {
+    static_assert(std::is_nothrow_move_assignable_v<T> && std::is_nothrow_default_constructible_v<T>,
+                  "ring elements must be nothrow default constructible and move assignable");
+
+public:
+    explicit SpscRing(size_t capacity) noexcept
+        : cells_(new (std::nothrow) T[detail::ring_capacity(capacity)]),
+          mask_(cells_ ? detail::ring_capacity(capacity) - 1 : 0) {}
+
+    bool valid() const noexcept { return cells_ != nullptr; }
+    size_t capacity() const noexcept { return cells_ ? mask_ + 1 : 0; }
+
+    // Producer thread only.
+    bool try_push(T&& v) noexcept {
+        if (!cells_) return false;
+        size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - head_cache_ > mask_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t - head_cache_ > mask_) return false;
+        }
+        cells_[t & mask_] = std::move(v);
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only.
+    bool try_pop(T& out) noexcept {
+        size_t h = head_.load(std::memory_order_relaxed);
+        if (h == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (h == tail_cache_) return false;
+        }
+        out = std::move(cells_[h & mask_]);
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called while the other side is active.
+    bool empty() const noexcept {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::unique_ptr<T[]> cells_;
+    size_t mask_;
+    // Consumer side.
+    alignas(detail::cache_line) std::atomic<size_t> head_{0};
+    size_t tail_cache_ = 0;
+    // Producer side.
+    alignas(detail::cache_line) std::atomic<size_t> tail_{0};
+    size_t head_cache_ = 0;
+};
+
+template <class T>
+class MpmcRing {
+    static_assert(std::is_nothrow_move_assignable_v<T> && std::is_nothrow_default_constructible_v<T>,
+                  "ring elements must be nothrow default constructible and move assignable");
+
+public:
+    explicit MpmcRing(size_t capacity) noexcept
+        : cells_(new (std::nothrow) Cell[detail::ring_capacity(capacity)]),
+          mask_(cells_ ? detail::ring_capacity(capacity) - 1 : 0) {
+        if (cells_)
+            for (size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool valid() const noexcept { return cells_ != nullptr; }
+    size_t capacity() const noexcept { return cells_ ? mask_ + 1 : 0; }
+
+    bool try_push(T&& v) noexcept {
+        if (!cells_) return false;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = std::move(v);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& out) noexcept {
+        if (!cells_) return false;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(c.value);
+                    c.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // empty
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(detail::cache_line) std::atomic<size_t> head_{0};
+    alignas(detail::cache_line) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace bpw
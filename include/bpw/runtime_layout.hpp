@@ -0,0 +1,154 @@
+// Record layouts that are only known at run time.
+//
+// A RuntimeLayout is built from a list of RuntimeField descriptions (for
+// example read from configuration at startup). It cannot use the
+// compile-time Field/Layout machinery, but it does not walk the description
+// for each record either. compile() translates the fields into threaded
+// code: an array of ops, each holding a pointer to a handler specialised
+// for one (wire width, byte order, signedness, target size) combination.
+// Every handler does its one load and store and then tail-calls the next
+// op's handler, so a record costs one indirect jump per field. No switch
+// is evaluated and no per-field call returns. Runs of fields whose wire
+// bytes already match the target (native byte order and same width,
+// contiguous on both sides) are merged into a single memcpy; a layout that
+// mirrors its struct decodes with one copy.
+//
+// Records are decoded into, and encoded from, caller memory described by
+// each field's target_offset / target_size, typically a plain struct:
+//
+//   std::vector<bpw::RuntimeField> fields = {
+//       {bpw::FieldKind::unsigned_int, 0, 2, bpw::Endian::big, offsetof(Hdr, type), 2},
+//       {bpw::FieldKind::unsigned_int, 2, 3, bpw::Endian::big, offsetof(Hdr, length), 4},
+//   };
+//   bpw::RuntimeLayout layout;
+//   if (bpw::RuntimeLayout::compile(fields, sizeof(Hdr), layout) != bpw::Status::ok) ...
+//   Hdr h;
+//   bpw::Status s = layout.parse(reader, &h);
+//
+// Implemented in src/runtime_layout.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+enum class FieldKind : uint8_t {
+    unsigned_int,  // width 1..8 -> target 1, 2, 4 or 8 bytes, width <= target
+    signed_int,    // as unsigned_int, sign extended from the wire width
+    floating,      // width 4 or 8 == target_size; IEEE-754 bits in `endian` order
+    boolean,       // width 1..8 -> 1-byte bool (0 or 1)
+    bytes,         // width bytes copied verbatim; target_size == width
+};
+
+struct RuntimeField {
+    FieldKind kind = FieldKind::unsigned_int;
+    size_t offset = 0;  // byte offset within the wire record
+    size_t width = 0;   // bytes on the wire
+    Endian endian = Endian::little;
+    size_t target_offset = 0;  // byte offset within the target object
+    size_t target_size = 0;    // bytes of the target member
+};
+
+namespace detail {
+
+struct RuntimeOp;
+using RuntimeHandler = void (*)(const RuntimeOp* op, const uint8_t* wire, uint8_t* target) noexcept;
+
+// One step of a compiled program. `wire` / `target` are offsets into the
+// record and the target object; `len` is used by copy and fill ops.
+struct RuntimeOp {
+    RuntimeHandler fn;
+    uint32_t wire;
+    uint32_t target;
+    uint32_t len;
+};
+
+}  // namespace detail
+
+class RuntimeLayout {
+public:
+    RuntimeLayout() = default;
+
+    // Validate `fields` and build the decode and encode programs. Fails with
+    // invalid_argument for unsupported widths or kinds, wire fields that
+    // overlap, or targets outside [0, target_size).
+    [[nodiscard]] static Status compile(std::span<const RuntimeField> fields, size_t target_size,
+                                        RuntimeLayout& out);
+
+    // Wire record size: the end of the last field.
+    size_t size() const noexcept { return size_; }
+    size_t target_size() const noexcept { return target_size_; }
+    std::span<const RuntimeField> fields() const noexcept { return fields_; }
+    bool empty() const noexcept { return fields_.empty(); }
+
+    // Ops executed per record, after merging (diagnostics and tests).
+    size_t decode_ops() const noexcept { return decode_.empty() ? 0 : decode_.size() - 1; }
+    size_t encode_ops() const noexcept { return encode_.empty() ? 0 : encode_.size() - 1; }
+
+    // Unchecked: the layout is not empty(), `wire` holds size() bytes and
+    // `target` target_size() bytes.
+    void decode(const uint8_t* wire, void* target) const noexcept {
+        run(decode_.data(), wire, static_cast<uint8_t*>(target));
+    }
+    void encode(const void* target, uint8_t* wire) const noexcept {
+        // The encode handlers read from the target and write to the wire;
+        // the signature is shared with decode.
+        run(encode_.data(), static_cast<const uint8_t*>(target), wire);
+    }
+
+    // Checked once per record, then decoded / encoded. A default-constructed
+    // (empty) layout has no program and fails with invalid_argument, here
+    // and in the batch functions below.
+    [[nodiscard]] Status parse(Reader& in, void* target) const noexcept {
+        if (empty()) return Status::invalid_argument;
+        if (!in.has(size_)) return in.bounds_error();
+        decode(in.data(), target);
+        in.count_records();
+        return in.skip(size_);
+    }
+    [[nodiscard]] Status write(Writer& out, const void* target) const noexcept {
+        if (empty()) return Status::invalid_argument;
+        uint8_t* p = out.prepare(size_);
+        if (!p) return out.failure();
+        encode(target, p);
+        out.commit(size_);
+        out.count_records();
+        return Status::ok;
+    }
+
+    // Decode `count` consecutive records into targets spaced `stride` bytes
+    // apart. Bounds are checked once for the whole batch.
+    [[nodiscard]] Status parse_many(Reader& in, size_t count, void* targets, size_t stride) const noexcept;
+    // Encode `count` targets spaced `stride` bytes apart into one prepared
+    // block of count * size() bytes.
+    [[nodiscard]] Status write_many(Writer& out, size_t count, const void* targets, size_t stride) const noexcept;
+
+    // Serialise the compiled programs, and load them back without compiling
+    // (see bpw/layout_cache.hpp). load() checks every op against the wire
+    // and target sizes, and that the ops cover the wire in order without
+    // overlap as compiled ones do, so a corrupt or foreign blob is rejected
+    // as malformed instead of being run.
+    [[nodiscard]] Status save(Writer& out) const noexcept;
+    [[nodiscard]] static Status load(Reader& in, RuntimeLayout& out);
+
+private:
+    static void run(const detail::RuntimeOp* ops, const uint8_t* src, uint8_t* dst) noexcept {
+        ops->fn(ops, src, dst);
+    }
+
+    std::vector<RuntimeField> fields_;
+    std::vector<detail::RuntimeOp> decode_;  // each ends with a terminating op
+    std::vector<detail::RuntimeOp> encode_;
+    size_t size_ = 0;
+    size_t target_size_ = 0;
+};
+
+}  // namespace bpw
@@ -0,0 +1,181 @@
+// Writer that emits into a chain of fixed-size segments for vectored I/O.
+//
+// Small writes are copied into pooled segments of `segment_size` bytes; a
+// segment is never reallocated or moved, so nothing already written is
+// copied again as the output grows. Payloads of at least `ref_threshold`
+// bytes are not copied at all: the chain records a reference to the
+// caller's buffer, which must stay alive and unchanged until the chain has
+// been written out or cleared.
+//
+// The chain is exposed as an iovec array that can be given unchanged to
+// writev (write_to()) or to io_uring (see bpw/uring.hpp), so many frames go
+// out in one system call without being assembled into one buffer first.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include <sys/uio.h>
+
+#include "bpw/endian.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class SegmentWriter {
+public:
+    static constexpr size_t default_segment_size = size_t{64} << 10;
+    static constexpr size_t default_ref_threshold = size_t{4} << 10;
+
+    explicit SegmentWriter(size_t segment_size = default_segment_size,
+                           size_t ref_threshold = default_ref_threshold) noexcept
+        : segment_size_(segment_size ? segment_size : default_segment_size), ref_threshold_(ref_threshold) {}
+
+    SegmentWriter(const SegmentWriter&) = delete;
+    SegmentWriter& operator=(const SegmentWriter&) = delete;
+    SegmentWriter(SegmentWriter&&) noexcept = default;
+    SegmentWriter& operator=(SegmentWriter&&) noexcept = default;
+
+    size_t size() const noexcept { return size_; }
+    size_t segment_size() const noexcept { return segment_size_; }
+    size_t segments_allocated() const noexcept { return pool_.size(); }
+
+    // Chain contents, in order. Valid until the next write or clear().
+    std::span<const iovec> iovecs() const noexcept { return {iov_.data(), iov_.size()}; }
+
+    // Drop the contents; segments are kept and reused.
+    void clear() noexcept {
+        iov_.clear();
+        size_ = 0;
+        seg_ = 0;
+        fill_ = 0;
+    }
+
+    // Contiguous space for n bytes (n <= segment_size) in the current
+    // segment; follow with commit(). Returns nullptr if n is too large or
+    // allocation fails.
+    uint8_t* prepare(size_t n) noexcept {
+        if (n > segment_size_) return nullptr;
+        if (pool_.empty() || segment_size_ - fill_ < n) {
+            if (!next_segment()) return nullptr;
+        }
+        if (!reserve_iov()) return nullptr;
+        return pool_[seg_].get() + fill_;
+    }
+
+    // Never fails: prepare() already reserved the iovec slot.
+    void commit(size_t n) noexcept {
+        uint8_t* p = pool_[seg_].get() + fill_;
+        fill_ += n;
+        size_ += n;
+        if (!iov_.empty() && static_cast<uint8_t*>(iov_.back().iov_base) + iov_.back().iov_len == p) {
+            iov_.back().iov_len += n;
+        } else {
+            iov_.push_back(iovec{p, n});
+        }
+    }
+
+    // Copy bytes into the chain, spanning segment boundaries as needed.
+    [[nodiscard]] Status write_bytes(const void* src, size_t n) noexcept {
+        const auto* s = static_cast<const uint8_t*>(src);
+        while (n) {
+            if (pool_.empty() || fill_ == segment_size_) {
+                if (!next_segment()) return Status::out_of_memory;
+            }
+            if (!reserve_iov()) return Status::out_of_memory;
+            size_t k = segment_size_ - fill_ < n ? segment_size_ - fill_ : n;
+            std::memcpy(pool_[seg_].get() + fill_, s, k);
+            commit(k);
+            s += k;
+            n -= k;
+        }
+        return Status::ok;
+    }
+    [[nodiscard]] Status write_bytes(std::span<const uint8_t> src) noexcept {
+        return write_bytes(src.data(), src.size());
+    }
+
+    // Reference bytes owned by the caller without copying them.
+    [[nodiscard]] Status write_ref(std::span<const uint8_t> src) noexcept {
+        if (src.empty()) return Status::ok;
+        if (!reserve_iov()) return Status::out_of_memory;
+        iov_.push_back(iovec{const_cast<uint8_t*>(src.data()), src.size()});
+        size_ += src.size();
+        return Status::ok;
+    }
+
+    // Copy small payloads, reference large ones.
+    [[nodiscard]] Status append(std::span<const uint8_t> src) noexcept {
+        return src.size() >= ref_threshold_ ? write_ref(src) : write_bytes(src);
+    }
+
+    template <class T>
+    [[nodiscard]] Status write_le(T v) noexcept {
+        static_assert(std::is_integral_v<T>, "write_le requires an integer type");
+        uint8_t* p = prepare(sizeof(T));
+        if (!p) return Status::out_of_memory;
+        store_le<T>(p, v);
+        commit(sizeof(T));
+        return Status::ok;
+    }
+
+    template <class T>
+    [[nodiscard]] Status write_be(T v) noexcept {
+        static_assert(std::is_integral_v<T>, "write_be requires an integer type");
+        uint8_t* p = prepare(sizeof(T));
+        if (!p) return Status::out_of_memory;
+        store_be<T>(p, v);
+        commit(sizeof(T));
+        return Status::ok;
+    }
+
+    // writev the whole chain to fd, retrying short writes and splitting at
+    // IOV_MAX. Blocks until everything is written or an error occurs.
+    // Implemented in src/segment_writer.cpp.
+    [[nodiscard]] Status write_to(int fd, int* err = nullptr) const;
+
+private:
+    // Guarantee room for one more iovec so that push_back cannot throw.
+    bool reserve_iov() noexcept {
+        if (iov_.size() < iov_.capacity()) return true;
+        try {
+            iov_.reserve(iov_.empty() ? 16 : iov_.size() * 2);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+    // Move to the next pooled segment, allocating one if the pool is used up.
+    bool next_segment() noexcept {
+        size_t next = pool_.empty() ? 0 : seg_ + 1;
+        if (next == pool_.size()) {
+            std::unique_ptr<uint8_t[]> s(new (std::nothrow) uint8_t[segment_size_]);
+            if (!s) return false;
+            try {
+                pool_.push_back(std::move(s));
+            } catch (const std::bad_alloc&) {
+                return false;
+            }
+        }
+        seg_ = next;
+        fill_ = 0;
+        return true;
+    }
+
+    size_t segment_size_;
+    size_t ref_threshold_;
+    std::vector<std::unique_ptr<uint8_t[]>> pool_;
+    std::vector<iovec> iov_;
+    size_t seg_ = 0;   // index of the segment being filled
+    size_t fill_ = 0;  // bytes used in pool_[seg_]
+    size_t size_ = 0;
+};
+
+}  // namespace bpw
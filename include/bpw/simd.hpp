@@ -0,0 +1,40 @@
+// Bulk byte-swap and bit-unpack kernels with runtime CPU dispatch.
+//
+// The kernel set is chosen once, on first use, from what the CPU supports:
+// AVX2 or SSSE3 on x86-64, NEON on AArch64, portable scalar code elsewhere.
+// All pointers may be unaligned. Implemented in src/simd.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bpw::simd {
+
+enum class Isa : uint8_t { scalar, ssse3, avx2, neon };
+
+const char* to_string(Isa isa) noexcept;
+
+// Best instruction set the running CPU supports.
+Isa detected_isa() noexcept;
+// Instruction set the kernels currently dispatch to.
+Isa active_isa() noexcept;
+// Pin dispatch to `isa` (clamped to what the CPU supports). Intended for
+// benchmarks and for cross-checking the vector paths against scalar code.
+void force_isa(Isa isa) noexcept;
+
+// dst[i] = byteswap(src[i]) for `count` 2/4/8-byte elements. src and dst
+// may be the same buffer, but must not otherwise overlap.
+void bswap16(const uint8_t* src, uint8_t* dst, size_t count) noexcept;
+void bswap32(const uint8_t* src, uint8_t* dst, size_t count) noexcept;
+void bswap64(const uint8_t* src, uint8_t* dst, size_t count) noexcept;
+
+// Unpack `count` MSB-first packed unsigned integers of `width` bits
+// (1 <= width <= 32) from src, the same bit order BitReader uses. src must
+// hold packed_size(width, count) bytes.
+void unpack_bits(const uint8_t* src, unsigned width, size_t count, uint32_t* dst) noexcept;
+
+constexpr size_t packed_size(unsigned width, size_t count) noexcept {
+    return (static_cast<size_t>(width) * count + 7) / 8;
+}
+
+}  // namespace bpw::simd
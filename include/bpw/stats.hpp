@@ -0,0 +1,70 @@
+// Optional hot-path counters for readers and writers.
+//
+// Build with -DBPW_STATS=1 to compile them in. A ReadStats or WriteStats is
+// a plain struct owned by the caller and attached with set_stats(); readers
+// derived from an attached one (sub_reader(), slice(), a BitReader built
+// from it) report to the same struct, so it can be scraped or copied out
+// at any time. The counters are not atomic: attach one struct per thread.
+// The parallel decoders (parallel_decode(), decode_records(),
+// run_pipeline()) follow that rule themselves: their workers count into
+// private structs that are added to the input Reader's stats on return.
+//
+// With BPW_STATS unset or 0, readers and writers carry no stats pointer,
+// every counting statement expands to nothing, and set_stats() is a no-op,
+// so instrumented call sites still compile.
+#pragma once
+
+#include <cstdint>
+
+#ifndef BPW_STATS
+#define BPW_STATS 0
+#endif
+
+#if BPW_STATS
+#define BPW_COUNT(stats, field, n)               \
+    do {                                         \
+        if (stats) (stats)->field += (n);        \
+    } while (0)
+#else
+#define BPW_COUNT(stats, field, n) ((void)0)
+#endif
+
+namespace bpw {
+
+inline constexpr bool stats_enabled = BPW_STATS != 0;
+
+struct ReadStats {
+    uint64_t bytes = 0;            // bytes consumed
+    uint64_t records = 0;          // records decoded by layouts, views and columns
+    uint64_t bounds_failures = 0;  // reads rejected for running past the end
+    uint64_t refills = 0;          // BitReader cache refills
+    uint64_t slow_paths = 0;       // tail refills, long varints, carried frames
+};
+
+struct WriteStats {
+    uint64_t bytes = 0;            // bytes emitted
+    uint64_t records = 0;          // records encoded by layouts
+    uint64_t bounds_failures = 0;  // writes rejected (fixed buffer full or out of memory)
+    uint64_t reallocations = 0;    // buffer reallocations
+    uint64_t slow_paths = 0;       // exact-size fallbacks near the end of a fixed buffer
+};
+
+inline ReadStats& operator+=(ReadStats& a, const ReadStats& b) noexcept {
+    a.bytes += b.bytes;
+    a.records += b.records;
+    a.bounds_failures += b.bounds_failures;
+    a.refills += b.refills;
+    a.slow_paths += b.slow_paths;
+    return a;
+}
+
+inline WriteStats& operator+=(WriteStats& a, const WriteStats& b) noexcept {
+    a.bytes += b.bytes;
+    a.records += b.records;
+    a.bounds_failures += b.bounds_failures;
+    a.reallocations += b.reallocations;
+    a.slow_paths += b.slow_paths;
+    return a;
+}
+
+}  // namespace bpw
@@ -0,0 +1,33 @@
+// Status codes shared by every reader and writer in the module.
+#pragma once
+
+#include <cstdint>
+
+namespace bpw {
+
+// Result of a fallible operation. Hot-path functions return this instead of
+// throwing so that callers can branch on it without unwinding costs.
+enum class Status : uint8_t {
+    ok = 0,
+    out_of_bounds,     // not enough bytes left in the input / output
+    invalid_argument,  // caller passed a value the operation cannot accept
+    malformed,         // input is structurally invalid
+    io_error,          // the operating system reported an error
+    unsupported,       // feature not available in this build / platform
+    out_of_memory,     // an allocation failed
+};
+
+constexpr const char* to_string(Status s) noexcept {
+    switch (s) {
+    case Status::ok:               return "ok";
+    case Status::out_of_bounds:    return "out of bounds";
+    case Status::invalid_argument: return "invalid argument";
+    case Status::malformed:        return "malformed input";
+    case Status::io_error:         return "I/O error";
+    case Status::unsupported:      return "unsupported";
+    case Status::out_of_memory:    return "out of memory";
+    }
+    return "unknown";
+}
+
+}  // namespace bpw
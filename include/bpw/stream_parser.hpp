@@ -0,0 +1,146 @@
+// Push-style incremental parser for framed record streams.
+//
+// The caller feeds arbitrary chunks (as they arrive from a socket or pipe)
+// and receives one Reader per complete record. Records that lie entirely
+// inside a chunk are handed out in place, without copying. Only a record
+// that straddles two chunks is assembled into an internal carry buffer, which
+// is allocated once with Framing::max_size bytes, so memory use is constant
+// regardless of stream length.
+//
+//   bpw::StreamParser parser(bpw::Framing::fixed(HeaderLayout::size));
+//   while (auto chunk = socket.recv())
+//       if (parser.feed(chunk, [](bpw::Reader& rec) { ...; return bpw::Status::ok; }) != bpw::Status::ok)
+//           break;
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+class StreamParser {
+public:
+    // framing.max_size bounds the carry buffer and must be finite.
+    explicit StreamParser(const Framing& framing) noexcept : framing_(framing), status_(check_framing()) {
+        if (status_ == Status::ok && carry_.reserve(framing_.max_size) != Status::ok)
+            status_ = Status::out_of_memory;
+    }
+
+    const Framing& framing() const noexcept { return framing_; }
+
+    // Bytes of a partial record held between feed() calls.
+    size_t buffered() const noexcept { return carry_.size(); }
+    // True when the stream is positioned on a record boundary.
+    bool at_boundary() const noexcept { return carry_.size() == 0; }
+    // Total bytes accepted by feed() so far.
+    size_t consumed() const noexcept { return consumed_; }
+    // Sticky error from framing or from a handler; ok otherwise.
+    Status status() const noexcept { return status_; }
+
+    // Counters (bpw/stats.hpp): record Readers handed to on_record report
+    // here, and every record assembled in the carry buffer counts as a slow
+    // path. No-op unless built with BPW_STATS.
+    void set_stats([[maybe_unused]] ReadStats* s) noexcept {
+#if BPW_STATS
+        stats_ = s;
+#endif
+    }
+    ReadStats* stats() const noexcept {
+#if BPW_STATS
+        return stats_;
+#else
+        return nullptr;
+#endif
+    }
+
+    // Forget any partial record and clear the error state.
+    void reset() noexcept {
+        carry_.clear();
+        expected_ = 0;
+        consumed_ = 0;
+        status_ = carry_.capacity() >= framing_.max_size ? check_framing() : Status::out_of_memory;
+    }
+
+    // Push the next chunk. on_record is called as Status(Reader& record) for
+    // every record completed by this chunk; a non-ok result stops parsing
+    // and is returned (and latched). The Reader is only valid during the
+    // call.
+    template <class F>
+    [[nodiscard]] Status feed(std::span<const uint8_t> chunk, F&& on_record) {
+        if (status_ != Status::ok) return status_;
+        Reader in(chunk);
+        consumed_ += chunk.size();
+
+        if (carry_.size() && (status_ = finish_carried(in, on_record)) != Status::ok) return status_;
+
+        // Fast path: whole records straight out of the caller's chunk.
+        while (in.has(framing_.header_size)) {
+            size_t n;
+            if ((status_ = framing_.frame_size(in.data(), n)) != Status::ok) return status_;
+            if (!in.has(n)) break;
+            Reader rec(in.data(), n);
+            rec.set_stats(stats());
+            (void)in.skip(n);
+            if ((status_ = on_record(rec)) != Status::ok) return status_;
+        }
+
+        // Keep the tail for the next call. It is smaller than one record,
+        // so it always fits the carry buffer.
+        expected_ = 0;
+        if (!in.empty()) (void)carry_.write_bytes(in.data(), in.remaining());
+        return Status::ok;
+    }
+
+private:
+    Status check_framing() const noexcept {
+        bool ok = framing_.valid() && framing_.max_size != SIZE_MAX;
+        return ok ? Status::ok : Status::invalid_argument;
+    }
+
+    // Complete the record started in an earlier chunk.
+    template <class F>
+    Status finish_carried(Reader& in, F& on_record) {
+        if (!expected_) {
+            if (Status s = top_up(in, framing_.header_size); s != Status::ok) return s;
+            if (carry_.size() < framing_.header_size) return Status::ok;
+            if (Status s = framing_.frame_size(carry_.data(), expected_); s != Status::ok) return s;
+        }
+        if (Status s = top_up(in, expected_); s != Status::ok) return s;
+        if (carry_.size() < expected_) return Status::ok;
+        Reader rec(carry_.data(), carry_.size());
+        rec.set_stats(stats());
+        rec.count_slow_path();
+        carry_.clear();
+        expected_ = 0;
+        return on_record(rec);
+    }
+
+    // Move bytes from `in` into the carry buffer until it holds `want`.
+    Status top_up(Reader& in, size_t want) noexcept {
+        if (carry_.size() >= want) return Status::ok;
+        size_t n = want - carry_.size();
+        if (n > in.remaining()) n = in.remaining();
+        std::span<const uint8_t> bytes;
+        (void)in.read_bytes(n, bytes);
+        return carry_.write_bytes(bytes);
+    }
+
+    Framing framing_;
+    Writer carry_;
+    size_t expected_ = 0;  // size of the carried record, once its header is complete
+    size_t consumed_ = 0;
+    Status status_ = Status::ok;
+#if BPW_STATS
+    ReadStats* stats_ = nullptr;
+#endif
+};
+
+}  // namespace bpw
@@ -0,0 +1,155 @@
+// Work-stealing thread pool.
+//
+// Each worker owns a deque: it pushes and pops its own work at the back and,
+// when idle, steals from the front of the other workers' deques. Tasks
+// submitted from outside the pool are spread round-robin. parallel_for()
+// blocks until all of its iterations are done, and the calling thread runs
+// queued tasks while it waits, so it is safe to call from inside a task.
+//
+// On NUMA machines the workers can be pinned (ThreadPoolOptions::pinning).
+// Workers are then spread over the nodes in proportion to their CPUs, in
+// node order, and parallel_for() hands each worker a contiguous block of
+// iterations instead of dealing them out round-robin. Neighbouring
+// iterations, usually neighbouring parts of the input, therefore run on the
+// same node, and idle workers steal from their own node before crossing to
+// another. Buffers a worker allocates and touches first stay on its node
+// (bpw/numa.hpp).
+//
+// Implemented in src/thread_pool.cpp.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bpw {
+
+enum class Pinning : uint8_t {
+    none,  // workers float; the pool behaves as one node
+    node,  // each worker may run on any CPU of its node
+    cpu,   // each worker is bound to one CPU
+};
+
+struct ThreadPoolOptions {
+    // 0 uses one worker per CPU (std::thread::hardware_concurrency() when
+    // not pinned).
+    unsigned threads = 0;
+    // Best effort: a worker that cannot be pinned runs unpinned.
+    Pinning pinning = Pinning::none;
+};
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads == 0 uses std::thread::hardware_concurrency().
+    explicit ThreadPool(unsigned threads = 0);
+    explicit ThreadPool(const ThreadPoolOptions& opts);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    // Runs every queued task, then joins the workers.
+    ~ThreadPool();
+
+    unsigned size() const noexcept { return static_cast<unsigned>(queues_.size()); }
+
+    // Nodes the workers are spread over; 1 unless pinned.
+    unsigned nodes() const noexcept { return nodes_; }
+    // Kernel NUMA node of worker w, or -1 if the pool is not pinned.
+    int worker_node(unsigned w) const noexcept { return w < worker_node_.size() ? worker_node_[w] : -1; }
+    // Index of the calling thread among this pool's workers, or -1.
+    int current_worker() const noexcept;
+
+    void submit(Task task);
+    // Queue a task on worker w's own deque (other workers may still steal it).
+    void submit_to(unsigned w, Task task);
+
+    // Run fn(i) for every i in [0, n) and wait for completion. If fn
+    // throws, the first exception is rethrown once every iteration is done.
+    template <class F>
+    void parallel_for(size_t n, F&& fn) {
+        // Shared with the tasks: the last one may still be signalling after
+        // the waiter has seen the count reach zero and returned.
+        auto latch = std::make_shared<Latch>(n);
+        for (size_t i = 0; i < n; ++i) {
+            auto task = [&fn, latch, i] {
+                struct Arrive {
+                    Latch& l;
+                    ~Arrive() { l.arrive(); }
+                } arrive{*latch};
+                try {
+                    fn(i);
+                } catch (...) {
+                    latch->fail(std::current_exception());
+                }
+            };
+            if (nodes_ > 1) submit_to(static_cast<unsigned>(i * size() / n), std::move(task));
+            else submit(std::move(task));
+        }
+        while (!latch->done()) {
+            if (!run_one()) latch->wait();
+        }
+        if (latch->error) std::rethrow_exception(latch->error);
+    }
+
+    // Run one queued task on the calling thread; false if none was found.
+    bool run_one();
+
+private:
+    // Completion count of one parallel_for().
+    struct Latch {
+        explicit Latch(size_t n) noexcept : remaining(n) {}
+
+        bool done() const noexcept { return remaining.load(std::memory_order_acquire) == 0; }
+        void arrive() noexcept {
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            std::lock_guard<std::mutex> lk(m);
+            cv.notify_all();
+        }
+        void wait() {
+            std::unique_lock<std::mutex> lk(m);
+            cv.wait(lk, [this] { return done(); });
+        }
+        void fail(std::exception_ptr e) noexcept {
+            std::lock_guard<std::mutex> lk(m);
+            if (!error) error = std::move(e);
+        }
+
+        std::atomic<size_t> remaining;
+        std::mutex m;
+        std::condition_variable cv;
+        std::exception_ptr error;  // first exception thrown by fn
+    };
+
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    void start(unsigned threads, Pinning pinning);
+    void worker_loop(unsigned index);
+    void push(unsigned index, Task task);
+    bool pop(unsigned index, Task& out);
+    bool steal(unsigned thief, Task& out);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    std::vector<int> worker_node_;                 // empty unless pinned
+    std::vector<std::vector<unsigned>> affinity_;  // CPUs per worker, if pinned
+    std::vector<std::vector<unsigned>> victims_;   // steal order per worker
+    unsigned nodes_ = 1;
+    std::atomic<size_t> queued_{0};
+    std::atomic<unsigned> next_{0};
+    std::mutex sleep_m_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+};
+
+}  // namespace bpw
@@ -0,0 +1,268 @@
+// Field-by-field decoding and encoding with one bounds check per record.
+//
+// Reader checks every read, which is right for input of unknown shape but
+// costs a compare and branch per field in hand-written decoders of
+// fixed-size or length-prefixed records. take_unchecked() and
+// next_unchecked() validate the whole record once and return an
+// UncheckedReader over it. Its reads return values directly and check
+// nothing:
+//
+//   bpw::UncheckedReader rec;
+//   while (bpw::next_unchecked(in, framing, Trade::min_size, rec) == bpw::Status::ok) {
+//       t.timestamp = rec.read_be<uint64_t>();
+//       t.price = rec.read_be<int32_t>();
+//       ...
+//   }
+//
+// Corrupt input is still rejected: a frame whose length runs past the
+// buffer, or that is shorter than the fixed part the decoder reads
+// unconditionally (min_size), fails before any field is touched. The
+// caller's side of the contract is to read at most min_size bytes without
+// consulting remaining() / has() first; variable-length parts must be
+// checked with has() against the length they declare.
+//
+// Encoding works the other way round: the size is computed first, the
+// Writer makes room once, and UncheckedWriter stores into that space with
+// no capacity checks or growth. Write the encoder once as a generic lambda;
+// serialized_size() runs it over a SizeCounter, which only adds up the
+// bytes, and write_exact() runs it again over an UncheckedWriter:
+//
+//   auto enc = [&](auto& w) {
+//       w.write_be(uint16_t{msg.type});
+//       w.write_varint(msg.body.size());
+//       w.write_bytes(msg.body.data(), msg.body.size());
+//   };
+//   if (bpw::write_exact(out, enc) != bpw::Status::ok) ...
+//
+// For a batch, sum serialized_size() over the messages, reserve() once and
+// call write_exact(out, size, enc) per message with the size already known.
+// Fixed layouts need no counting pass: Layout::serialized_size() is a
+// compile-time constant and Layout::write_many() encodes a whole batch into
+// one prepared block.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "bpw/endian.hpp"
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+#include "bpw/varint.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+class UncheckedReader {
+public:
+    constexpr UncheckedReader() noexcept = default;
+
+    constexpr const uint8_t* data() const noexcept { return cur_; }
+    constexpr size_t size() const noexcept { return static_cast<size_t>(end_ - begin_); }
+    constexpr size_t position() const noexcept { return static_cast<size_t>(cur_ - begin_); }
+    constexpr size_t remaining() const noexcept { return static_cast<size_t>(end_ - cur_); }
+    constexpr bool has(size_t n) const noexcept { return n <= remaining(); }
+
+    // Unchecked reads: the caller guarantees the bytes are inside the record.
+    template <class T>
+    T read_le() noexcept {
+        static_assert(std::is_integral_v<T>, "read_le requires an integer type");
+        T v = load_le<T>(cur_);
+        cur_ += sizeof(T);
+        return v;
+    }
+
+    template <class T>
+    T read_be() noexcept {
+        static_assert(std::is_integral_v<T>, "read_be requires an integer type");
+        T v = load_be<T>(cur_);
+        cur_ += sizeof(T);
+        return v;
+    }
+
+    template <Endian E, class T>
+    T read() noexcept {
+        if constexpr (E == Endian::little) return read_le<T>();
+        else return read_be<T>();
+    }
+
+    uint8_t read_u8() noexcept { return *cur_++; }
+
+    std::span<const uint8_t> read_bytes(size_t n) noexcept {
+        std::span<const uint8_t> s{cur_, n};
+        cur_ += n;
+        return s;
+    }
+
+    void skip(size_t n) noexcept { cur_ += n; }
+
+    // Fields at a fixed offset from the start of the record, without moving.
+    template <class T>
+    T le_at(size_t offset) const noexcept {
+        return load_le<T>(begin_ + offset);
+    }
+    template <class T>
+    T be_at(size_t offset) const noexcept {
+        return load_be<T>(begin_ + offset);
+    }
+
+    // Checked view of the unread part, for variable-length tails.
+    Reader rest() const noexcept { return Reader(cur_, remaining()); }
+
+private:
+    friend Status take_unchecked(Reader& in, size_t n, UncheckedReader& out) noexcept;
+
+    constexpr UncheckedReader(const uint8_t* p, size_t n) noexcept : begin_(p), cur_(p), end_(p + n) {}
+
+    const uint8_t* begin_ = nullptr;
+    const uint8_t* cur_ = nullptr;
+    const uint8_t* end_ = nullptr;
+};
+
+// Claim the next n bytes of `in` for unchecked decoding: one bounds check,
+// then `in` moves past them.
+[[nodiscard]] inline Status take_unchecked(Reader& in, size_t n, UncheckedReader& out) noexcept {
+    if (!in.has(n)) return in.bounds_error();
+    out = UncheckedReader(in.data(), n);
+    return in.skip(n);
+}
+
+// Split the next frame off `in` and claim it for unchecked decoding. Frames
+// shorter than min_size are malformed; `in` is left at the bad frame.
+[[nodiscard]] inline Status next_unchecked(Reader& in, const Framing& framing, size_t min_size,
+                                           UncheckedReader& out) noexcept {
+    if (!in.has(framing.header_size)) return in.bounds_error();
+    size_t n;
+    if (Status s = framing.frame_size(in.data(), n); s != Status::ok) return s;
+    if (n < min_size) return Status::malformed;
+    return take_unchecked(in, n, out);
+}
+
+// Stores into space the caller has already sized; nothing is checked. The
+// write methods mirror SizeCounter's so one generic encoder drives both.
+class UncheckedWriter {
+public:
+    constexpr UncheckedWriter() noexcept = default;
+    constexpr UncheckedWriter(uint8_t* p, size_t n) noexcept : begin_(p), cur_(p), end_(p + n) {}
+
+    constexpr size_t size() const noexcept { return static_cast<size_t>(end_ - begin_); }
+    constexpr size_t position() const noexcept { return static_cast<size_t>(cur_ - begin_); }
+    constexpr size_t remaining() const noexcept { return static_cast<size_t>(end_ - cur_); }
+
+    template <class T>
+    void write_le(T v) noexcept {
+        static_assert(std::is_integral_v<T>, "write_le requires an integer type");
+        store_le<T>(cur_, v);
+        cur_ += sizeof(T);
+    }
+
+    template <class T>
+    void write_be(T v) noexcept {
+        static_assert(std::is_integral_v<T>, "write_be requires an integer type");
+        store_be<T>(cur_, v);
+        cur_ += sizeof(T);
+    }
+
+    template <Endian E, class T>
+    void write(T v) noexcept {
+        if constexpr (E == Endian::little) write_le(v);
+        else write_be(v);
+    }
+
+    void write_u8(uint8_t v) noexcept { *cur_++ = v; }
+
+    void write_bytes(const void* src, size_t n) noexcept {
+        if (n) std::memcpy(cur_, src, n);
+        cur_ += n;
+    }
+    void write_bytes(std::span<const uint8_t> src) noexcept { write_bytes(src.data(), src.size()); }
+
+    // Exactly varint_size(v) bytes. encode_varint() stores a whole word for
+    // values up to 8 bytes, so near the end of the space go through a
+    // temporary.
+    void write_varint(uint64_t v) noexcept {
+        if (remaining() >= sizeof(uint64_t)) {
+            cur_ += encode_varint(cur_, v);
+        } else {
+            uint8_t tmp[max_varint_size];
+            write_bytes(tmp, encode_varint(tmp, v));
+        }
+    }
+    void write_svarint(int64_t v) noexcept { write_varint(zigzag_encode(v)); }
+
+    // A fixed-layout record: w.write_record(TradeLayout{}, t).
+    template <class L>
+    void write_record(L, const typename L::record_type& r) noexcept {
+        L::encode(cur_, r);
+        cur_ += L::size;
+    }
+
+private:
+    uint8_t* begin_ = nullptr;
+    uint8_t* cur_ = nullptr;
+    uint8_t* end_ = nullptr;
+};
+
+// Counts the bytes an encoder would write.
+class SizeCounter {
+public:
+    constexpr size_t size() const noexcept { return n_; }
+
+    template <class T>
+    constexpr void write_le(T) noexcept {
+        n_ += sizeof(T);
+    }
+    template <class T>
+    constexpr void write_be(T) noexcept {
+        n_ += sizeof(T);
+    }
+    template <Endian, class T>
+    constexpr void write(T) noexcept {
+        n_ += sizeof(T);
+    }
+    constexpr void write_u8(uint8_t) noexcept { ++n_; }
+    constexpr void write_bytes(const void*, size_t n) noexcept { n_ += n; }
+    constexpr void write_bytes(std::span<const uint8_t> src) noexcept { n_ += src.size(); }
+    constexpr void write_varint(uint64_t v) noexcept { n_ += varint_size(v); }
+    constexpr void write_svarint(int64_t v) noexcept { n_ += varint_size(zigzag_encode(v)); }
+    template <class L>
+    constexpr void write_record(L, const typename L::record_type&) noexcept {
+        n_ += L::size;
+    }
+
+private:
+    size_t n_ = 0;
+};
+
+// Bytes fn(w) writes, by running it over a SizeCounter.
+template <class F>
+[[nodiscard]] constexpr size_t serialized_size(F&& fn) noexcept {
+    SizeCounter c;
+    fn(c);
+    return c.size();
+}
+
+// Append exactly n bytes produced by fn(UncheckedWriter&): one capacity
+// check, then a straight pass. fn must write at most n bytes; if it writes
+// fewer, nothing is committed and the result is invalid_argument.
+template <class F>
+[[nodiscard]] Status write_exact(Writer& out, size_t n, F&& fn) noexcept {
+    uint8_t* p = out.prepare(n);
+    if (!p) return out.failure();
+    UncheckedWriter w(p, n);
+    fn(w);
+    if (w.position() != n) return Status::invalid_argument;
+    out.commit(n);
+    return Status::ok;
+}
+
+// Size fn's output with serialized_size(), then write it with one check.
+template <class F>
+[[nodiscard]] Status write_exact(Writer& out, F&& fn) noexcept {
+    return write_exact(out, serialized_size(fn), fn);
+}
+
+}  // namespace bpw
@@ -0,0 +1,91 @@
+// Minimal io_uring submission queue for handing SegmentWriter chains to the
+// kernel asynchronously.
+//
+// Talks to the kernel through the raw io_uring system calls, so no liburing
+// is needed. Only vectored writes are supported. The iovec array and every
+// buffer it references (the SegmentWriter and any write_ref() payloads) must
+// stay alive until the matching completion has been reaped.
+//
+// Linux only; create() reports Status::unsupported elsewhere or when the
+// kernel refuses io_uring. Implemented in src/uring.cpp.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include <sys/uio.h>
+
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class Uring {
+public:
+    struct Completion {
+        uint64_t user_data;
+        int32_t result;  // bytes written, or -errno
+    };
+
+    // Offset meaning "the file's current position" (pipes, sockets).
+    static constexpr uint64_t current_position = ~uint64_t{0};
+
+    Uring() noexcept = default;
+    Uring(const Uring&) = delete;
+    Uring& operator=(const Uring&) = delete;
+    Uring(Uring&& o) noexcept;
+    Uring& operator=(Uring&& o) noexcept;
+    ~Uring();
+
+    [[nodiscard]] static Status create(unsigned entries, Uring& out);
+
+    bool is_open() const noexcept { return fd_ >= 0; }
+    // errno of the last failed system call.
+    int last_error() const noexcept { return errno_; }
+
+    // Queue a writev; nothing reaches the kernel until submit(). Returns
+    // out_of_bounds when the submission queue is full. More than IOV_MAX
+    // entries are written as several linked writevs at consecutive
+    // offsets, one completion each, all with `user_data`; if one fails or
+    // comes up short, the rest complete with -ECANCELED.
+    [[nodiscard]] Status queue_writev(int fd, std::span<const iovec> iov, uint64_t offset, uint64_t user_data) noexcept;
+
+    // Hand all queued entries to the kernel.
+    [[nodiscard]] Status submit() noexcept;
+
+    // Reap one completion if available, without blocking.
+    bool poll(Completion& out) noexcept;
+    // Block until a completion is available.
+    [[nodiscard]] Status wait(Completion& out) noexcept;
+
+    void close() noexcept;
+
+private:
+    // Kernel-shared ring memory and the pointers into it.
+    struct Ring {
+        void* sq_map = nullptr;
+        size_t sq_map_size = 0;
+        void* cq_map = nullptr;  // null when the kernel maps SQ and CQ together
+        size_t cq_map_size = 0;
+        void* sqes = nullptr;
+        size_t sqes_size = 0;
+
+        unsigned* sq_head = nullptr;
+        unsigned* sq_tail = nullptr;
+        unsigned* sq_array = nullptr;
+        unsigned sq_mask = 0;
+        unsigned sq_entries = 0;
+
+        unsigned* cq_head = nullptr;
+        unsigned* cq_tail = nullptr;
+        void* cqes = nullptr;
+        unsigned cq_mask = 0;
+    };
+
+    int fd_ = -1;
+    int errno_ = 0;
+    unsigned pending_ = 0;  // queued but not yet submitted
+    Ring ring_;
+};
+
+}  // namespace bpw
@@ -0,0 +1,192 @@
+// LEB128 varints, zigzag signed varints and Stream VByte arrays.
+//
+// Single values are decoded without a per-byte loop: one 64-bit load finds
+// the terminating byte with a count-trailing-zeros, and the 7-bit groups are
+// compacted with PEXT (when compiled for BMI2) or a three-step shift ladder.
+// Encoding is the same in reverse (PDEP or the inverse ladder). Only values
+// needing 9 or 10 bytes, or values in the last 8 bytes of the input, take
+// the byte-at-a-time path.
+//
+// Bulk decoders live in src/varint.cpp and use the ISA selected in
+// bpw/simd.hpp. LEB128 arrays are decoded 16 single-byte values at a time
+// when a whole vector has no continuation bits. Stream VByte (control bytes
+// followed by 1-4 byte little-endian values) is decoded four values per
+// shuffle; it is a separate format, for arrays whose encoding we control.
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "bpw/endian.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+#include "bpw/writer.hpp"
+
+namespace bpw {
+
+constexpr size_t max_varint_size = 10;
+
+constexpr uint64_t zigzag_encode(int64_t v) noexcept {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+constexpr int64_t zigzag_decode(uint64_t v) noexcept {
+    return static_cast<int64_t>((v >> 1) ^ (~(v & 1) + 1));
+}
+
+// Encoded size of v in bytes (1..10).
+constexpr size_t varint_size(uint64_t v) noexcept {
+    return static_cast<size_t>(std::bit_width(v | 1) + 6) / 7;
+}
+
+namespace detail {
+
+// Pack the low 7 bits of each of the 8 bytes of x into 56 bits.
+inline uint64_t varint_compress(uint64_t x) noexcept {
+#if defined(__BMI2__)
+    return _pext_u64(x, 0x7f7f7f7f7f7f7f7full);
+#else
+    x &= 0x7f7f7f7f7f7f7f7full;
+    x = ((x & 0x7f007f007f007f00ull) >> 1) | (x & 0x007f007f007f007full);
+    x = ((x & 0x3fff00003fff0000ull) >> 2) | (x & 0x00003fff00003fffull);
+    x = ((x & 0x0fffffff00000000ull) >> 4) | (x & 0x000000000fffffffull);
+    return x;
+#endif
+}
+
+// Inverse of varint_compress for v < 2^56.
+inline uint64_t varint_spread(uint64_t v) noexcept {
+#if defined(__BMI2__)
+    return _pdep_u64(v, 0x7f7f7f7f7f7f7f7full);
+#else
+    uint64_t x = v;
+    x = ((x & 0x00fffffff0000000ull) << 4) | (x & 0x000000000fffffffull);
+    x = ((x & 0x0fffc0000fffc000ull) << 2) | (x & 0x00003fff00003fffull);
+    x = ((x & 0x3f803f803f803f80ull) << 1) | (x & 0x007f007f007f007full);
+    return x;
+#endif
+}
+
+inline Status decode_varint_slow(const uint8_t*& p, const uint8_t* end, uint64_t& out) noexcept {
+    uint64_t v = 0;
+    for (unsigned i = 0; i < max_varint_size; ++i) {
+        if (p + i >= end) return Status::out_of_bounds;
+        uint8_t b = p[i];
+        // The 10th byte may only carry the top bit of a 64-bit value.
+        if (i == max_varint_size - 1 && b > 1) return Status::malformed;
+        v |= static_cast<uint64_t>(b & 0x7f) << (7 * i);
+        if (!(b & 0x80)) {
+            p += i + 1;
+            out = v;
+            return Status::ok;
+        }
+    }
+    return Status::malformed;
+}
+
+}  // namespace detail
+
+// Decode one LEB128 value at p and advance p past it.
+[[nodiscard]] inline Status decode_varint(const uint8_t*& p, const uint8_t* end, uint64_t& out) noexcept {
+    if (end - p >= 8) {
+        uint64_t w = load_le<uint64_t>(p);
+        uint64_t stop = ~w & 0x8080808080808080ull;
+        if (stop) {
+            unsigned len = (static_cast<unsigned>(std::countr_zero(stop)) >> 3) + 1;
+            out = detail::varint_compress(w & (~uint64_t{0} >> (64 - 8 * len)));
+            p += len;
+            return Status::ok;
+        }
+    }
+    return detail::decode_varint_slow(p, end, out);
+}
+
+// Encode v at p, which must have max_varint_size writable bytes. Returns
+// the number of bytes used.
+inline size_t encode_varint(uint8_t* p, uint64_t v) noexcept {
+    size_t len = varint_size(v);
+    if (len <= 8) {
+        // Continuation bits on all bytes but the last.
+        uint64_t cont = 0x8080808080808080ull & ((uint64_t{1} << (8 * (len - 1))) - 1);
+        store_le<uint64_t>(p, detail::varint_spread(v) | cont);
+        return len;
+    }
+    for (size_t i = 0; i < len - 1; ++i) p[i] = static_cast<uint8_t>(v >> (7 * i)) | 0x80;
+    p[len - 1] = static_cast<uint8_t>(v >> (7 * (len - 1)));
+    return len;
+}
+
+namespace detail {
+
+// Consume a value decode_varint() ended at p, counting stats.
+inline Status finish_varint(Reader& in, const uint8_t* p, Status s) noexcept {
+    if (s != Status::ok) return s == Status::out_of_bounds ? in.bounds_error() : s;
+    if constexpr (stats_enabled) {
+        if (p - in.data() > 8 || in.remaining() < 8) in.count_slow_path();
+    }
+    return in.skip(static_cast<size_t>(p - in.data()));
+}
+
+}  // namespace detail
+
+[[nodiscard]] inline Status read_varint(Reader& in, uint64_t& out) noexcept {
+    const uint8_t* p = in.data();
+    Status s = decode_varint(p, in.end(), out);
+    return detail::finish_varint(in, p, s);
+}
+
+[[nodiscard]] inline Status read_varint(Reader& in, uint32_t& out) noexcept {
+    uint64_t v;
+    const uint8_t* p = in.data();
+    Status s = decode_varint(p, in.end(), v);
+    if (s != Status::ok) return detail::finish_varint(in, p, s);
+    if (v > UINT32_MAX) return Status::malformed;
+    out = static_cast<uint32_t>(v);
+    return detail::finish_varint(in, p, s);
+}
+
+[[nodiscard]] inline Status read_svarint(Reader& in, int64_t& out) noexcept {
+    uint64_t v;
+    if (Status s = read_varint(in, v); s != Status::ok) return s;
+    out = zigzag_decode(v);
+    return Status::ok;
+}
+
+[[nodiscard]] inline Status write_varint(Writer& out, uint64_t v) noexcept {
+    uint8_t* p = out.prepare(max_varint_size);
+    if (!p) {
+        // A fixed buffer may still have room for the exact size.
+        out.count_slow_path();
+        size_t n = varint_size(v);
+        uint8_t tmp[max_varint_size];
+        encode_varint(tmp, v);
+        return out.write_bytes(tmp, n);
+    }
+    out.commit(encode_varint(p, v));
+    return Status::ok;
+}
+
+[[nodiscard]] inline Status write_svarint(Writer& out, int64_t v) noexcept {
+    return write_varint(out, zigzag_encode(v));
+}
+
+// Bulk LEB128: decode `count` values from `in` (src/varint.cpp). Values
+// that do not fit the output type are rejected as malformed.
+[[nodiscard]] Status read_varints(Reader& in, uint32_t* out, size_t count) noexcept;
+[[nodiscard]] Status read_varints(Reader& in, uint64_t* out, size_t count) noexcept;
+[[nodiscard]] Status write_varints(Writer& out, const uint32_t* src, size_t count) noexcept;
+[[nodiscard]] Status write_varints(Writer& out, const uint64_t* src, size_t count) noexcept;
+
+// Stream VByte: ceil(count / 4) control bytes (2 bits per value: byte
+// length - 1, low bits first) followed by the little-endian value bytes.
+constexpr size_t streamvbyte_max_size(size_t count) noexcept { return (count + 3) / 4 + 4 * count; }
+[[nodiscard]] Status write_streamvbyte(Writer& out, const uint32_t* src, size_t count) noexcept;
+[[nodiscard]] Status read_streamvbyte(Reader& in, uint32_t* out, size_t count) noexcept;
+
+}  // namespace bpw
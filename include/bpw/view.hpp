@@ -0,0 +1,65 @@
+// Lazy, on-demand access to an encoded fixed-layout record.
+//
+// A View checks once, when it is created, that the whole record lies inside
+// the input. After that, get<&Record::member>() decodes only the requested
+// field, straight from the input bytes. Nothing is decoded up front, so
+// routing on one header field costs one load. Fields are decoded again on
+// every access: a fixed-width load is cheaper than checking a cache.
+//
+//   bpw::View<HeaderLayout> v;
+//   if (bpw::View<HeaderLayout>::make(reader, v) != bpw::Status::ok) return;
+//   switch (v.get<&Header::type>()) { ... }
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "bpw/layout.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+template <class L>
+class View {
+public:
+    using layout = L;
+    using record_type = typename L::record_type;
+
+    constexpr View() noexcept = default;
+    // Unchecked: p must reference at least L::size bytes.
+    explicit constexpr View(const uint8_t* p) noexcept : p_(p) {}
+
+    // View the next record of `in` and consume it.
+    [[nodiscard]] static Status make(Reader& in, View& out) noexcept {
+        if (!in.has(L::size)) return in.bounds_error();
+        out = View(in.data());
+        in.count_records();
+        return in.skip(L::size);
+    }
+
+    template <auto Member>
+    auto get() const noexcept {
+        static_assert(L::template has_member<Member>, "member is not part of this layout");
+        return L::template field<L::template index_of<Member>>::get(p_);
+    }
+
+    // Decode one field into `out` (also works for array members).
+    template <auto Member, class T>
+    void get_into(T& out) const noexcept {
+        static_assert(L::template has_member<Member>, "member is not part of this layout");
+        L::template field<L::template index_of<Member>>::decode_value(p_, out);
+    }
+
+    // Decode every field.
+    void materialize(record_type& out) const noexcept { L::decode(p_, out); }
+
+    std::span<const uint8_t> bytes() const noexcept { return {p_, L::size}; }
+    explicit operator bool() const noexcept { return p_ != nullptr; }
+
+private:
+    const uint8_t* p_ = nullptr;
+};
+
+}  // namespace bpw
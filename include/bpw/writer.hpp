@@ -0,0 +1,172 @@
+// Growable byte writer.
+//
+// Writer either owns a heap buffer that grows geometrically or wraps a fixed
+// caller-owned buffer that never grows. Pass a capacity hint (or call
+// reserve()) with the expected encoded size and one encode performs at most
+// one allocation.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "bpw/endian.hpp"
+#include "bpw/stats.hpp"
+#include "bpw/status.hpp"
+
+namespace bpw {
+
+class Writer {
+public:
+    Writer() noexcept = default;
+    explicit Writer(size_t capacity_hint) noexcept { (void)reserve(capacity_hint); }
+    // Non-owning writer over buf; writes beyond capacity fail with
+    // Status::out_of_bounds instead of growing.
+    Writer(uint8_t* buf, size_t capacity) noexcept
+        : data_(buf), cap_(capacity), owned_(false) {}
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+    Writer(Writer&& o) noexcept
+        : data_(std::exchange(o.data_, nullptr)),
+          size_(std::exchange(o.size_, 0)),
+          cap_(std::exchange(o.cap_, 0)),
+          owned_(std::exchange(o.owned_, true)) {
+        set_stats(o.stats());
+    }
+    Writer& operator=(Writer&& o) noexcept {
+        if (this != &o) {
+            free_buffer();
+            data_ = std::exchange(o.data_, nullptr);
+            size_ = std::exchange(o.size_, 0);
+            cap_ = std::exchange(o.cap_, 0);
+            owned_ = std::exchange(o.owned_, true);
+            set_stats(o.stats());
+        }
+        return *this;
+    }
+    ~Writer() { free_buffer(); }
+
+    uint8_t* data() noexcept { return data_; }
+    const uint8_t* data() const noexcept { return data_; }
+    size_t size() const noexcept { return size_; }
+    size_t capacity() const noexcept { return cap_; }
+    bool owns_buffer() const noexcept { return owned_; }
+    std::span<const uint8_t> bytes() const noexcept { return {data_, size_}; }
+
+    // Counters (bpw/stats.hpp); no-ops unless built with BPW_STATS.
+    void set_stats([[maybe_unused]] WriteStats* s) noexcept {
+#if BPW_STATS
+        stats_ = s;
+#endif
+    }
+    WriteStats* stats() const noexcept {
+#if BPW_STATS
+        return stats_;
+#else
+        return nullptr;
+#endif
+    }
+    void count_records([[maybe_unused]] uint64_t n = 1) const noexcept { BPW_COUNT(stats_, records, n); }
+    void count_slow_path() const noexcept { BPW_COUNT(stats_, slow_paths, 1); }
+
+    // Status for a write that could not get space: out_of_memory for an
+    // owned buffer, out_of_bounds for a full fixed one. Counted as a bounds
+    // failure.
+    [[nodiscard]] Status failure() const noexcept {
+        BPW_COUNT(stats_, bounds_failures, 1);
+        return owned_ ? Status::out_of_memory : Status::out_of_bounds;
+    }
+
+    // Drop the contents but keep the allocation for reuse.
+    void clear() noexcept { size_ = 0; }
+
+    // Make room for at least n bytes in total.
+    [[nodiscard]] Status reserve(size_t n) noexcept {
+        if (n <= cap_) return Status::ok;
+        if (!owned_) return Status::out_of_bounds;
+        void* p = std::realloc(data_, n);
+        if (!p) return Status::out_of_memory;
+        data_ = static_cast<uint8_t*>(p);
+        cap_ = n;
+        BPW_COUNT(stats_, reallocations, 1);
+        return Status::ok;
+    }
+
+    // Writable space for n bytes past the end, without changing size().
+    // Returns nullptr if the space cannot be provided. Follow with commit().
+    uint8_t* prepare(size_t n) noexcept {
+        if ((n > cap_ - size_ || !data_) && grow(n) != Status::ok) return nullptr;
+        return data_ + size_;
+    }
+    void commit(size_t n) noexcept {
+        size_ += n;
+        BPW_COUNT(stats_, bytes, n);
+    }
+
+    [[nodiscard]] Status write_bytes(const void* src, size_t n) noexcept {
+        uint8_t* p = prepare(n);
+        if (!p) return failure();
+        if (n) std::memcpy(p, src, n);
+        commit(n);
+        return Status::ok;
+    }
+    [[nodiscard]] Status write_bytes(std::span<const uint8_t> src) noexcept {
+        return write_bytes(src.data(), src.size());
+    }
+
+    template <class T>
+    [[nodiscard]] Status write_le(T v) noexcept {
+        static_assert(std::is_integral_v<T>, "write_le requires an integer type");
+        uint8_t* p = prepare(sizeof(T));
+        if (!p) return failure();
+        store_le<T>(p, v);
+        commit(sizeof(T));
+        return Status::ok;
+    }
+
+    template <class T>
+    [[nodiscard]] Status write_be(T v) noexcept {
+        static_assert(std::is_integral_v<T>, "write_be requires an integer type");
+        uint8_t* p = prepare(sizeof(T));
+        if (!p) return failure();
+        store_be<T>(p, v);
+        commit(sizeof(T));
+        return Status::ok;
+    }
+
+    template <Endian E, class T>
+    [[nodiscard]] Status write(T v) noexcept {
+        if constexpr (E == Endian::little) return write_le(v);
+        else return write_be(v);
+    }
+
+    [[nodiscard]] Status write_u8(uint8_t v) noexcept { return write_le(v); }
+
+private:
+    Status grow(size_t n) noexcept {
+        if (n > SIZE_MAX - size_) return Status::out_of_memory;
+        size_t need = size_ + n;
+        size_t target = cap_ < 64 ? 64 : cap_;
+        while (target < need) target = target > SIZE_MAX / 2 ? need : target * 2;
+        return reserve(target);
+    }
+
+    void free_buffer() noexcept {
+        if (owned_) std::free(data_);
+    }
+
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    size_t cap_ = 0;
+    bool owned_ = true;
+#if BPW_STATS
+    WriteStats* stats_ = nullptr;
+#endif
+};
+
+}  // namespace bpw
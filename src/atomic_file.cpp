@@ -0,0 +1,67 @@
+#include "atomic_file.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bpw::detail {
+
+namespace {
+
+Status write_all(int fd, const uint8_t* p, size_t left) noexcept {
+    while (left) {
+        ssize_t w = ::write(fd, p, left);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return Status::io_error;
+        p += w;
+        left -= static_cast<size_t>(w);
+    }
+    return Status::ok;
+}
+
+// Make a rename in `dir` durable. Filesystems that cannot sync a
+// directory report EINVAL; there is nothing more to do on those.
+Status sync_dir(const std::string& dir) noexcept {
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return Status::io_error;
+    int rc = ::fsync(fd);
+    bool ok = rc == 0 || errno == EINVAL;
+    ::close(fd);
+    return ok ? Status::ok : Status::io_error;
+}
+
+}  // namespace
+
+Status write_file_atomic(const char* path, std::span<const uint8_t> bytes) noexcept {
+    std::string tmp, dir;
+    try {
+        tmp = std::string(path) + ".tmp.XXXXXX";
+        const char* slash = std::strrchr(path, '/');
+        dir = !slash ? std::string(".") : slash == path ? std::string("/") : std::string(path, slash);
+    } catch (const std::bad_alloc&) {
+        return Status::out_of_memory;
+    }
+    // mkstemp() picks a name no other thread or process is using and
+    // creates the file 0600; widen it to what a plain create would give.
+    int fd = ::mkstemp(tmp.data());
+    if (fd < 0) return Status::io_error;
+    Status s = ::fcntl(fd, F_SETFD, FD_CLOEXEC) == 0 && ::fchmod(fd, 0644) == 0 ? Status::ok : Status::io_error;
+    if (s == Status::ok) s = write_all(fd, bytes.data(), bytes.size());
+    if (s == Status::ok && ::fsync(fd) != 0) s = Status::io_error;
+    if (::close(fd) != 0 && s == Status::ok) s = Status::io_error;
+    if (s == Status::ok && std::rename(tmp.c_str(), path) != 0) s = Status::io_error;
+    if (s != Status::ok) {
+        ::unlink(tmp.c_str());
+        return s;
+    }
+    return sync_dir(dir);
+}
+
+}  // namespace bpw::detail
@@ -0,0 +1,21 @@
+// Crash-safe whole-file replacement, shared by the save() functions
+// (OffsetIndex, LayoutCache). Internal to the library; not installed.
+//
+// Implemented in src/atomic_file.cpp.
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "bpw/status.hpp"
+
+namespace bpw::detail {
+
+// Replace `path` with `bytes`. The data goes to a uniquely named temporary
+// file in the same directory, is synced, and is renamed over `path`; the
+// directory is then synced so the rename itself survives a crash. Readers
+// see either the old file or the new one, never a partial write, and
+// concurrent writers (threads or processes) never share a temporary.
+[[nodiscard]] Status write_file_atomic(const char* path, std::span<const uint8_t> bytes) noexcept;
+
+}  // namespace bpw::detail
@@ -0,0 +1,521 @@
+#include "bpw/compression.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "bpw/crc32c.hpp"
+#include "bpw/endian.hpp"
+
+#ifndef BPW_WITH_LZ4
+#if __has_include(<lz4.h>)
+#define BPW_WITH_LZ4 1
+#else
+#define BPW_WITH_LZ4 0
+#endif
+#endif
+
+#ifndef BPW_WITH_ZSTD
+#if __has_include(<zstd.h>)
+#define BPW_WITH_ZSTD 1
+#else
+#define BPW_WITH_ZSTD 0
+#endif
+#endif
+
+#if BPW_WITH_LZ4
+#include <lz4.h>
+#endif
+#if BPW_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace bpw {
+
+namespace {
+
+#if BPW_WITH_ZSTD
+// One compression and one decompression context per thread, reused across
+// blocks instead of being set up for every call.
+struct ZstdContexts {
+    ZSTD_CCtx* c = nullptr;
+    ZSTD_DCtx* d = nullptr;
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(c);
+        ZSTD_freeDCtx(d);
+    }
+};
+
+thread_local ZstdContexts zstd_contexts;
+#endif
+
+// Write every byte of iov[0..n), retrying short writes.
+Status write_all(int fd, iovec* iov, int n, int& err) noexcept {
+    while (n) {
+        ssize_t w = ::writev(fd, iov, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            err = errno;
+            return Status::io_error;
+        }
+        if (w == 0) {
+            err = EIO;
+            return Status::io_error;
+        }
+        auto left = static_cast<size_t>(w);
+        while (n && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            ++iov;
+            --n;
+        }
+        if (n) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+    return Status::ok;
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------- codecs
+
+bool codec_available(Codec c) noexcept {
+    switch (c) {
+    case Codec::none: return true;
+    case Codec::lz4: return BPW_WITH_LZ4;
+    case Codec::zstd: return BPW_WITH_ZSTD;
+    }
+    return false;
+}
+
+size_t compress_bound(Codec c, size_t n) noexcept {
+    switch (c) {
+    case Codec::none: return n;
+    case Codec::lz4:
+#if BPW_WITH_LZ4
+        return n > LZ4_MAX_INPUT_SIZE ? 0 : static_cast<size_t>(LZ4_compressBound(static_cast<int>(n)));
+#else
+        return 0;
+#endif
+    case Codec::zstd:
+#if BPW_WITH_ZSTD
+        return ZSTD_compressBound(n);
+#else
+        return 0;
+#endif
+    }
+    return 0;
+}
+
+Status compress_block(Codec c, [[maybe_unused]] int level, std::span<const uint8_t> in, uint8_t* out,
+                      size_t capacity, size_t& written) noexcept {
+    written = 0;
+    switch (c) {
+    case Codec::none:
+        if (capacity < in.size()) return Status::out_of_bounds;
+        if (!in.empty()) std::memcpy(out, in.data(), in.size());
+        written = in.size();
+        return Status::ok;
+    case Codec::lz4: {
+#if BPW_WITH_LZ4
+        if (in.size() > LZ4_MAX_INPUT_SIZE) return Status::invalid_argument;
+        int cap = capacity > INT_MAX ? INT_MAX : static_cast<int>(capacity);
+        int n = LZ4_compress_fast(reinterpret_cast<const char*>(in.data()), reinterpret_cast<char*>(out),
+                                  static_cast<int>(in.size()), cap, level > 0 ? level : 1);
+        if (n <= 0) return Status::out_of_bounds;
+        written = static_cast<size_t>(n);
+        return Status::ok;
+#else
+        return Status::unsupported;
+#endif
+    }
+    case Codec::zstd: {
+#if BPW_WITH_ZSTD
+        ZstdContexts& z = zstd_contexts;
+        if (!z.c && !(z.c = ZSTD_createCCtx())) return Status::out_of_memory;
+        size_t n = ZSTD_compressCCtx(z.c, out, capacity, in.data(), in.size(), level);
+        if (ZSTD_isError(n)) return Status::out_of_bounds;
+        written = n;
+        return Status::ok;
+#else
+        return Status::unsupported;
+#endif
+    }
+    }
+    return Status::invalid_argument;
+}
+
+Status decompress_block(Codec c, std::span<const uint8_t> in, uint8_t* out, size_t raw_size) noexcept {
+    switch (c) {
+    case Codec::none:
+        if (in.size() != raw_size) return Status::malformed;
+        if (raw_size) std::memcpy(out, in.data(), raw_size);
+        return Status::ok;
+    case Codec::lz4: {
+#if BPW_WITH_LZ4
+        if (in.size() > INT_MAX || raw_size > INT_MAX) return Status::malformed;
+        int n = LZ4_decompress_safe(reinterpret_cast<const char*>(in.data()), reinterpret_cast<char*>(out),
+                                    static_cast<int>(in.size()), static_cast<int>(raw_size));
+        return n >= 0 && static_cast<size_t>(n) == raw_size ? Status::ok : Status::malformed;
+#else
+        return Status::unsupported;
+#endif
+    }
+    case Codec::zstd: {
+#if BPW_WITH_ZSTD
+        ZstdContexts& z = zstd_contexts;
+        if (!z.d && !(z.d = ZSTD_createDCtx())) return Status::out_of_memory;
+        size_t n = ZSTD_decompressDCtx(z.d, out, raw_size, in.data(), in.size());
+        return !ZSTD_isError(n) && n == raw_size ? Status::ok : Status::malformed;
+#else
+        return Status::unsupported;
+#endif
+    }
+    }
+    return Status::malformed;
+}
+
+// ---------------------------------------------------------------- block header
+
+void BlockHeader::encode(uint8_t* p) const noexcept {
+    store_le<uint32_t>(p, magic);
+    p[4] = static_cast<uint8_t>(codec);
+    p[5] = p[6] = p[7] = 0;
+    store_le<uint32_t>(p + 8, raw_size);
+    store_le<uint32_t>(p + 12, stored_size);
+    store_le<uint32_t>(p + 16, crc);
+}
+
+Status BlockHeader::decode(const uint8_t* p, BlockHeader& out) noexcept {
+    if (load_le<uint32_t>(p) != magic || p[5] || p[6] || p[7]) return Status::malformed;
+    if (p[4] > static_cast<uint8_t>(Codec::zstd)) return Status::malformed;
+    out.codec = static_cast<Codec>(p[4]);
+    out.raw_size = load_le<uint32_t>(p + 8);
+    out.stored_size = load_le<uint32_t>(p + 12);
+    out.crc = load_le<uint32_t>(p + 16);
+    return Status::ok;
+}
+
+// ---------------------------------------------------------------- writer
+
+CompressedWriter::CompressedWriter(int fd, const CompressionOptions& opts) : opts_(opts), fd_(fd) {
+    if (!codec_available(opts_.codec)) {
+        status_ = Status::unsupported;
+        return;
+    }
+    if (fd_ < 0 || opts_.block_size == 0 || opts_.block_size > UINT32_MAX) {
+        status_ = Status::invalid_argument;
+        return;
+    }
+    if (block_.reserve(opts_.block_size) != Status::ok) {
+        status_ = Status::out_of_memory;
+        return;
+    }
+    if (opts_.background) {
+        try {
+            worker_ = std::thread([this] { worker_loop(); });
+        } catch (const std::system_error&) {
+            opts_.background = false;
+        }
+    }
+}
+
+CompressedWriter::~CompressedWriter() { (void)finish(); }
+
+Status CompressedWriter::status() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return status_;
+}
+
+int CompressedWriter::last_error() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return errno_;
+}
+
+uint64_t CompressedWriter::blocks_written() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return blocks_;
+}
+
+uint64_t CompressedWriter::raw_bytes() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return raw_;
+}
+
+uint64_t CompressedWriter::stored_bytes() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return stored_;
+}
+
+Status CompressedWriter::seal() {
+    if (finished_) return Status::invalid_argument;
+    if (block_.size() > UINT32_MAX) {
+        std::lock_guard<std::mutex> lk(m_);
+        if (status_ == Status::ok) status_ = Status::invalid_argument;
+    }
+    if (block_.size() == 0) return status();
+
+    if (!opts_.background) {
+        if (Status s = status(); s != Status::ok) return s;
+        Status s = write_block(block_, scratch_);
+        block_.clear();
+        return s;
+    }
+
+    // Hand the block to the worker and keep filling the buffer it finished
+    // with last time.
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait(lk, [this] { return !has_pending_; });
+    if (status_ != Status::ok) return status_;
+    std::swap(block_, pending_);
+    has_pending_ = true;
+    lk.unlock();
+    cv_.notify_all();
+    block_.clear();
+    return Status::ok;
+}
+
+Status CompressedWriter::flush() {
+    if (finished_) return status();
+    if (Status s = seal(); s != Status::ok) return s;
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait(lk, [this] { return !has_pending_; });
+    return status_;
+}
+
+Status CompressedWriter::finish() {
+    if (finished_) return status();
+    Status s = flush();
+    finished_ = true;
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+    return s;
+}
+
+Status CompressedWriter::write_block(Writer& raw, Writer& scratch) {
+    const size_t n = raw.size();
+    const bool compress = opts_.codec != Codec::none;
+    scratch.clear();
+    uint8_t* out = scratch.prepare(BlockHeader::size + (compress ? compress_bound(opts_.codec, n) : 0));
+    Status s = out ? Status::ok : Status::out_of_memory;
+
+    int err = 0;
+    size_t stored = n;
+    if (s == Status::ok) {
+        BlockHeader h;
+        h.codec = Codec::none;
+        h.raw_size = static_cast<uint32_t>(n);
+        h.crc = crc32c(raw.data(), n);
+        iovec iov[2] = {{out, BlockHeader::size}, {raw.data(), n}};
+        int iovcnt = 2;
+        size_t packed = 0;
+        if (compress &&
+            compress_block(opts_.codec, opts_.level, {raw.data(), n}, out + BlockHeader::size,
+                           scratch.capacity() - BlockHeader::size, packed) == Status::ok &&
+            packed < n) {
+            h.codec = opts_.codec;
+            stored = packed;
+            iov[0].iov_len += packed;
+            iovcnt = 1;
+        }
+        h.stored_size = static_cast<uint32_t>(stored);
+        h.encode(out);
+        s = write_all(fd_, iov, iovcnt, err);
+    }
+
+    std::lock_guard<std::mutex> lk(m_);
+    if (s == Status::ok) {
+        ++blocks_;
+        raw_ += n;
+        stored_ += BlockHeader::size + stored;
+    } else if (status_ == Status::ok) {
+        status_ = s;
+        errno_ = err;
+    }
+    return s;
+}
+
+void CompressedWriter::worker_loop() {
+    std::unique_lock<std::mutex> lk(m_);
+    for (;;) {
+        cv_.wait(lk, [this] { return has_pending_ || stop_; });
+        if (!has_pending_) return;
+        lk.unlock();
+        // A failed block latches status_; later blocks are still drained
+        // but seal() stops handing them over.
+        (void)write_block(pending_, scratch_);
+        pending_.clear();
+        lk.lock();
+        has_pending_ = false;
+        cv_.notify_all();
+    }
+}
+
+// ---------------------------------------------------------------- reader
+
+CompressedReader::CompressedReader(FileSource& src, const CompressionOptions& opts) : opts_(opts), src_(&src) {
+    if (!src.is_open()) {
+        status_ = Status::invalid_argument;
+        return;
+    }
+    // A mapped file is one contiguous chunk, so blocks are decompressed
+    // straight out of the mapping and never staged.
+    Reader all;
+    if (src.mapped() && src.reader(all) == Status::ok) {
+        chunk_ = {all.data(), all.remaining()};
+        whole_ = true;
+    }
+    if (opts_.background) {
+        try {
+            worker_ = std::thread([this] { worker_loop(); });
+        } catch (const std::system_error&) {
+            opts_.background = false;
+        }
+    }
+}
+
+CompressedReader::~CompressedReader() {
+    if (worker_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+}
+
+Status CompressedReader::status() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return status_;
+}
+
+Status CompressedReader::next_chunk() {
+    chunk_pos_ = 0;
+    if (whole_) {
+        chunk_ = {};
+        return Status::ok;
+    }
+    return src_->next_chunk(chunk_);
+}
+
+// Point p at the next n input bytes: inside the current chunk when they fit,
+// otherwise gathered into stage_. Valid until the next pull().
+Status CompressedReader::pull(size_t n, const uint8_t*& p) {
+    if (chunk_.size() - chunk_pos_ >= n) {
+        p = chunk_.data() + chunk_pos_;
+        chunk_pos_ += n;
+        if (whole_) src_->advise(chunk_pos_);
+        return Status::ok;
+    }
+    stage_.clear();
+    while (stage_.size() < n) {
+        if (chunk_pos_ == chunk_.size()) {
+            if (Status s = next_chunk(); s != Status::ok) return s;
+            if (chunk_.empty()) return Status::out_of_bounds;
+        }
+        size_t k = chunk_.size() - chunk_pos_;
+        if (k > n - stage_.size()) k = n - stage_.size();
+        if (Status s = stage_.write_bytes(chunk_.data() + chunk_pos_, k); s != Status::ok) return s;
+        chunk_pos_ += k;
+    }
+    p = stage_.data();
+    return Status::ok;
+}
+
+Status CompressedReader::load_block(Slot& slot) {
+    slot.data.clear();
+    slot.end = false;
+    if (chunk_pos_ == chunk_.size()) {
+        if (Status s = next_chunk(); s != Status::ok) return s;
+        if (chunk_.empty()) {
+            slot.end = true;
+            return Status::ok;
+        }
+    }
+
+    const uint8_t* p;
+    BlockHeader h;
+    if (Status s = pull(BlockHeader::size, p); s != Status::ok) return s;
+    if (Status s = BlockHeader::decode(p, h); s != Status::ok) return s;
+    if (h.raw_size == 0 || h.raw_size > opts_.max_block_size) return Status::malformed;
+    if (!codec_available(h.codec)) return Status::unsupported;
+    // Checked before pulling the payload, so that a corrupt stored size
+    // cannot make an unmapped source stage more than a valid block needs.
+    if (h.codec == Codec::none ? h.stored_size != h.raw_size : h.stored_size > compress_bound(h.codec, h.raw_size))
+        return Status::malformed;
+
+    if (Status s = pull(h.stored_size, p); s != Status::ok) return s;
+    uint8_t* dst = slot.data.prepare(h.raw_size);
+    if (!dst) return Status::out_of_memory;
+    if (Status s = decompress_block(h.codec, {p, h.stored_size}, dst, h.raw_size); s != Status::ok) return s;
+    if (crc32c(dst, h.raw_size) != h.crc) return Status::malformed;
+    slot.data.commit(h.raw_size);
+    return Status::ok;
+}
+
+void CompressedReader::worker_loop() {
+    std::unique_lock<std::mutex> lk(m_);
+    for (;;) {
+        // A slot is free when it is neither decoded-and-waiting nor held by
+        // the caller.
+        cv_.wait(lk, [this] { return stop_ || ready_ + holding_ < 2; });
+        if (stop_) return;
+        Slot& slot = slots_[produce_];
+        lk.unlock();
+        slot.status = load_block(slot);
+        bool last = slot.end || slot.status != Status::ok;
+        lk.lock();
+        produce_ ^= 1;
+        ++ready_;
+        cv_.notify_all();
+        if (last) return;
+    }
+}
+
+Status CompressedReader::next_block(std::span<const uint8_t>& out) {
+    out = {};
+    if (done_) return status();
+
+    Slot* slot;
+    if (!worker_.joinable()) {
+        if (status_ == Status::ok) slots_[0].status = load_block(slots_[0]);
+        slot = &slots_[0];
+    } else {
+        std::unique_lock<std::mutex> lk(m_);
+        if (holding_) {
+            holding_ = false;
+            consume_ ^= 1;
+            cv_.notify_all();
+        }
+        cv_.wait(lk, [this] { return ready_ > 0; });
+        --ready_;
+        holding_ = true;
+        slot = &slots_[consume_];
+    }
+
+    if (slot->status != Status::ok || slot->end) {
+        std::lock_guard<std::mutex> lk(m_);
+        if (status_ == Status::ok) status_ = slot->status;
+        done_ = true;
+        return status_;
+    }
+    ++blocks_;
+    out = {slot->data.data(), slot->data.size()};
+    return Status::ok;
+}
+
+}  // namespace bpw
@@ -0,0 +1,105 @@
+#include "bpw/context.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+namespace bpw {
+
+namespace {
+
+std::atomic<uint64_t> next_pool_id{1};
+
+// This thread's most recently released context, tagged with its pool.
+struct LocalSlot {
+    uint64_t pool_id = 0;
+    std::unique_ptr<Context> ctx;
+};
+
+thread_local LocalSlot tls_slot;
+
+void prepare_writer(Writer& w, size_t capacity, bool prefault) noexcept {
+    if (w.reserve(capacity) == Status::ok && prefault && w.capacity()) std::memset(w.data(), 0, w.capacity());
+}
+
+}  // namespace
+
+Context::Context(const ContextOptions& opts) noexcept : opts_(opts), arena_(opts.arena_block_size) {
+    prepare_buffers();
+}
+
+void Context::prepare_buffers() noexcept {
+    prepare_writer(output_, opts_.output_capacity, opts_.prefault);
+    prepare_writer(scratch_, opts_.scratch_capacity, opts_.prefault);
+    if (opts_.prefault && opts_.arena_block_size > 1) {
+        // One block-sized allocation gets the first block allocated and
+        // touched; reset() keeps it.
+        size_t n = opts_.arena_block_size - 1;
+        if (void* p = arena_.allocate(n, 1)) std::memset(p, 0, n);
+        arena_.reset();
+    }
+}
+
+void Context::reset() noexcept {
+    ++uses_;
+    const size_t limit = opts_.max_retained_bytes;
+    if (output_.capacity() > limit) {
+        output_ = Writer();
+        prepare_writer(output_, opts_.output_capacity, opts_.prefault);
+    }
+    if (scratch_.capacity() > limit) {
+        scratch_ = Writer();
+        prepare_writer(scratch_, opts_.scratch_capacity, opts_.prefault);
+    }
+    output_.clear();
+    scratch_.clear();
+    if (arena_.bytes_reserved() > limit) arena_.release();
+    else arena_.reset();
+}
+
+ContextPool::ContextPool(const ContextOptions& opts, size_t max_idle) noexcept
+    : opts_(opts), max_idle_(max_idle), id_(next_pool_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+ContextPool::~ContextPool() {
+    if (tls_slot.pool_id == id_) {
+        tls_slot.ctx.reset();
+        tls_slot.pool_id = 0;
+    }
+}
+
+ContextPool::Lease ContextPool::acquire() noexcept {
+    if (tls_slot.pool_id == id_ && tls_slot.ctx) return Lease(this, tls_slot.ctx.release());
+    {
+        std::lock_guard<std::mutex> lk(m_);
+        if (!free_.empty()) {
+            Context* ctx = free_.back().release();
+            free_.pop_back();
+            return Lease(this, ctx);
+        }
+    }
+    return Lease(this, new (std::nothrow) Context(opts_));
+}
+
+void ContextPool::give_back(Context* ctx) noexcept {
+    ctx->reset();
+    std::unique_ptr<Context> owned(ctx);
+    // Keep the thread cache for the pool used most recently on this thread.
+    if (!tls_slot.ctx || tls_slot.pool_id != id_) {
+        tls_slot.ctx = std::move(owned);
+        tls_slot.pool_id = id_;
+        return;
+    }
+    std::lock_guard<std::mutex> lk(m_);
+    if (free_.size() >= max_idle_) return;
+    try {
+        free_.push_back(std::move(owned));
+    } catch (const std::bad_alloc&) {
+    }
+}
+
+size_t ContextPool::idle() const noexcept {
+    std::lock_guard<std::mutex> lk(m_);
+    return free_.size();
+}
+
+}  // namespace bpw
@@ -0,0 +1,199 @@
+#include "bpw/crc32c.hpp"
+
+#include <cstring>
+
+#include "bpw/endian.hpp"
+
+#if defined(__x86_64__)
+#define BPW_CRC_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define BPW_CRC_ARM 1
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+#endif
+
+namespace bpw {
+
+namespace {
+
+constexpr uint32_t poly = 0x82f63b78;  // reflected Castagnoli polynomial
+
+// ---------------------------------------------------------------- tables
+
+struct SliceTables {
+    uint32_t t[8][256];
+};
+
+constexpr SliceTables make_slice_tables() {
+    SliceTables s{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) c = c & 1 ? (c >> 1) ^ poly : c >> 1;
+        s.t[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = s.t[0][n];
+        for (int k = 1; k < 8; ++k) {
+            c = s.t[0][c & 0xff] ^ (c >> 8);
+            s.t[k][n] = c;
+        }
+    }
+    return s;
+}
+
+constexpr SliceTables slice = make_slice_tables();
+
+uint32_t crc_scalar(const uint8_t* p, size_t n, uint32_t crc) noexcept {
+    crc = ~crc;
+    for (; n && (reinterpret_cast<uintptr_t>(p) & 7); --n) crc = slice.t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t w = load_le<uint64_t>(p) ^ crc;
+        crc = slice.t[7][w & 0xff] ^ slice.t[6][(w >> 8) & 0xff] ^ slice.t[5][(w >> 16) & 0xff] ^
+              slice.t[4][(w >> 24) & 0xff] ^ slice.t[3][(w >> 32) & 0xff] ^ slice.t[2][(w >> 40) & 0xff] ^
+              slice.t[1][(w >> 48) & 0xff] ^ slice.t[0][w >> 56];
+    }
+    for (; n; --n) crc = slice.t[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// ---------------------------------------------------------------- hardware
+
+#if BPW_CRC_X86 || BPW_CRC_ARM
+
+// The hardware path runs three independent CRCs over adjacent blocks and
+// joins them by shifting the earlier CRCs over the later blocks' lengths.
+// A shift by a fixed length is linear over GF(2), so it is tabulated as four
+// byte-indexed tables per block length.
+constexpr size_t long_block = 8192;
+constexpr size_t short_block = 256;
+
+struct ShiftTable {
+    uint32_t t[4][256];
+};
+
+constexpr uint32_t gf2_times(const uint32_t* mat, uint32_t vec) {
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, ++mat)
+        if (vec & 1) sum ^= *mat;
+    return sum;
+}
+
+constexpr void gf2_square(uint32_t* square, const uint32_t* mat) {
+    for (int n = 0; n < 32; ++n) square[n] = gf2_times(mat, mat[n]);
+}
+
+// Operator appending `len` zero bytes (len a power of two) to a CRC.
+constexpr ShiftTable make_shift_table(size_t len) {
+    uint32_t odd[32] = {};
+    uint32_t even[32] = {};
+    odd[0] = poly;  // one zero bit
+    for (int n = 1; n < 32; ++n) odd[n] = uint32_t{1} << (n - 1);
+    gf2_square(even, odd);  // two zero bits
+    gf2_square(odd, even);  // four zero bits
+    const uint32_t* op = odd;
+    // Each square doubles the shift: 8 bits first, then once per bit of len.
+    for (;;) {
+        gf2_square(even, odd);
+        op = even;
+        len >>= 1;
+        if (!len) break;
+        gf2_square(odd, even);
+        op = odd;
+        len >>= 1;
+        if (!len) break;
+    }
+    ShiftTable s{};
+    for (uint32_t n = 0; n < 256; ++n) {
+        s.t[0][n] = gf2_times(op, n);
+        s.t[1][n] = gf2_times(op, n << 8);
+        s.t[2][n] = gf2_times(op, n << 16);
+        s.t[3][n] = gf2_times(op, n << 24);
+    }
+    return s;
+}
+
+constexpr ShiftTable shift_long = make_shift_table(long_block);
+constexpr ShiftTable shift_short = make_shift_table(short_block);
+
+inline uint32_t shift(const ShiftTable& z, uint32_t crc) noexcept {
+    return z.t[0][crc & 0xff] ^ z.t[1][(crc >> 8) & 0xff] ^ z.t[2][(crc >> 16) & 0xff] ^ z.t[3][crc >> 24];
+}
+
+#if BPW_CRC_X86
+#define BPW_CRC_TARGET __attribute__((target("sse4.2")))
+BPW_CRC_TARGET inline uint64_t crc_u64(uint64_t c, uint64_t v) noexcept { return _mm_crc32_u64(c, v); }
+BPW_CRC_TARGET inline uint32_t crc_u8(uint32_t c, uint8_t v) noexcept { return _mm_crc32_u8(c, v); }
+#else
+#define BPW_CRC_TARGET __attribute__((target("+crc")))
+BPW_CRC_TARGET inline uint64_t crc_u64(uint64_t c, uint64_t v) noexcept {
+    return __crc32cd(static_cast<uint32_t>(c), v);
+}
+BPW_CRC_TARGET inline uint32_t crc_u8(uint32_t c, uint8_t v) noexcept { return __crc32cb(c, v); }
+#endif
+
+template <size_t Block>
+BPW_CRC_TARGET inline void crc_three_way(const uint8_t*& p, size_t& n, uint64_t& crc0,
+                                         const ShiftTable& z) noexcept {
+    while (n >= 3 * Block) {
+        uint64_t crc1 = 0, crc2 = 0;
+        for (const uint8_t* end = p + Block; p < end; p += 8) {
+            crc0 = crc_u64(crc0, load_le<uint64_t>(p));
+            crc1 = crc_u64(crc1, load_le<uint64_t>(p + Block));
+            crc2 = crc_u64(crc2, load_le<uint64_t>(p + 2 * Block));
+        }
+        crc0 = shift(z, static_cast<uint32_t>(crc0)) ^ crc1;
+        crc0 = shift(z, static_cast<uint32_t>(crc0)) ^ crc2;
+        p += 2 * Block;
+        n -= 3 * Block;
+    }
+}
+
+BPW_CRC_TARGET uint32_t crc_hw(const uint8_t* p, size_t n, uint32_t crc) noexcept {
+    uint64_t c = ~crc;
+    for (; n && (reinterpret_cast<uintptr_t>(p) & 7); --n) c = crc_u8(static_cast<uint32_t>(c), *p++);
+    crc_three_way<long_block>(p, n, c, shift_long);
+    crc_three_way<short_block>(p, n, c, shift_short);
+    for (; n >= 8; n -= 8, p += 8) c = crc_u64(c, load_le<uint64_t>(p));
+    for (; n; --n) c = crc_u8(static_cast<uint32_t>(c), *p++);
+    return ~static_cast<uint32_t>(c);
+}
+
+bool cpu_has_crc() noexcept {
+#if BPW_CRC_X86
+    return __builtin_cpu_supports("sse4.2");
+#elif defined(__linux__) && defined(HWCAP_CRC32)
+    return getauxval(AT_HWCAP) & HWCAP_CRC32;
+#else
+    return false;
+#endif
+}
+
+#endif  // BPW_CRC_X86 || BPW_CRC_ARM
+
+using CrcFn = uint32_t (*)(const uint8_t*, size_t, uint32_t) noexcept;
+
+CrcFn select() noexcept {
+#if BPW_CRC_X86 || BPW_CRC_ARM
+    if (cpu_has_crc()) return crc_hw;
+#endif
+    return crc_scalar;
+}
+
+CrcFn active() noexcept {
+    static const CrcFn fn = select();
+    return fn;
+}
+
+}  // namespace
+
+uint32_t crc32c(const void* data, size_t n, uint32_t crc) noexcept {
+    return active()(static_cast<const uint8_t*>(data), n, crc);
+}
+
+bool crc32c_hardware() noexcept { return active() != crc_scalar; }
+
+}  // namespace bpw
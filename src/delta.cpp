@@ -0,0 +1,111 @@
+#include "bpw/delta.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "bpw/bit_reader.hpp"
+#include "bpw/bit_writer.hpp"
+#include "bpw/simd.hpp"
+
+namespace bpw {
+
+namespace {
+
+template <class T>
+Status write_delta_impl(Writer& out, const T* src, size_t count) noexcept {
+    if (count == 0) return Status::ok;
+    if (Status s = write_varint(out, src[0]); s != Status::ok) return s;
+
+    uint64_t delta[delta_block_size];
+    for (size_t i = 1; i < count; i += delta_block_size) {
+        const size_t n = std::min(delta_block_size, count - i);
+        // Wrapping differences, referenced to the smallest as signed.
+        int64_t ref = INT64_MAX;
+        for (size_t j = 0; j < n; ++j) {
+            delta[j] = uint64_t{src[i + j]} - uint64_t{src[i + j - 1]};
+            ref = std::min(ref, static_cast<int64_t>(delta[j]));
+        }
+        uint64_t any = 0;
+        for (size_t j = 0; j < n; ++j) {
+            delta[j] -= static_cast<uint64_t>(ref);
+            any |= delta[j];
+        }
+        const auto width = static_cast<unsigned>(std::bit_width(any));
+
+        if (Status s = write_svarint(out, ref); s != Status::ok) return s;
+        if (Status s = out.write_u8(static_cast<uint8_t>(width)); s != Status::ok) return s;
+        if (width == 0) continue;
+        BitWriter bw(out, simd::packed_size(width, n));
+        for (size_t j = 0; j < n; ++j) bw.write_bits64(delta[j], width);
+        if (Status s = bw.finish(); s != Status::ok) return s;
+    }
+    return Status::ok;
+}
+
+template <class T>
+Status store(uint64_t v, T& out) noexcept {
+    if constexpr (sizeof(T) < 8) {
+        if (v > static_cast<uint64_t>(T(~T{0}))) return Status::malformed;
+    }
+    out = static_cast<T>(v);
+    return Status::ok;
+}
+
+template <class T>
+Status read_delta_impl(Reader& in, T* out, size_t count) noexcept {
+    if (count == 0) return Status::ok;
+    uint64_t prev;
+    if (Status s = read_varint(in, prev); s != Status::ok) return s;
+    if (Status s = store(prev, out[0]); s != Status::ok) return s;
+
+    uint32_t packed[delta_block_size];
+    for (size_t i = 1; i < count; i += delta_block_size) {
+        const size_t n = std::min(delta_block_size, count - i);
+        int64_t sref;
+        uint8_t width;
+        if (Status s = read_svarint(in, sref); s != Status::ok) return s;
+        if (Status s = in.read_u8(width); s != Status::ok) return s;
+        if (width > 64) return Status::malformed;
+        const auto ref = static_cast<uint64_t>(sref);
+        const size_t bytes = simd::packed_size(width, n);
+        if (!in.has(bytes)) return in.bounds_error();
+
+        T* dst = out + i;
+        if (width == 0) {
+            for (size_t j = 0; j < n; ++j) {
+                prev += ref;
+                if (Status s = store(prev, dst[j]); s != Status::ok) return s;
+            }
+        } else if (width <= 32) {
+            simd::unpack_bits(in.data(), width, n, packed);
+            for (size_t j = 0; j < n; ++j) {
+                prev += ref + packed[j];
+                if (Status s = store(prev, dst[j]); s != Status::ok) return s;
+            }
+        } else {
+            BitReader br(in.data(), bytes);
+            for (size_t j = 0; j < n; ++j) {
+                prev += ref + br.read_bits64(width);
+                if (Status s = store(prev, dst[j]); s != Status::ok) return s;
+            }
+        }
+        if (Status s = in.skip(bytes); s != Status::ok) return s;
+    }
+    return Status::ok;
+}
+
+}  // namespace
+
+Status write_delta(Writer& out, const uint64_t* src, size_t count) noexcept {
+    return write_delta_impl(out, src, count);
+}
+
+Status write_delta(Writer& out, const uint32_t* src, size_t count) noexcept {
+    return write_delta_impl(out, src, count);
+}
+
+Status read_delta(Reader& in, uint64_t* out, size_t count) noexcept { return read_delta_impl(in, out, count); }
+
+Status read_delta(Reader& in, uint32_t* out, size_t count) noexcept { return read_delta_impl(in, out, count); }
+
+}  // namespace bpw
@@ -0,0 +1,179 @@
+#include "bpw/file_source.hpp"
+
+#include <cerrno>
+#include <new>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace bpw {
+
+namespace {
+
+size_t page_size() noexcept {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t page_floor(size_t n) noexcept { return n & ~(page_size() - 1); }
+
+}  // namespace
+
+FileSource::FileSource(FileSource&& o) noexcept
+    : fd_(std::exchange(o.fd_, -1)),
+      map_(std::exchange(o.map_, nullptr)),
+      size_(std::exchange(o.size_, 0)),
+      pos_(std::exchange(o.pos_, 0)),
+      advised_to_(std::exchange(o.advised_to_, 0)),
+      dropped_to_(std::exchange(o.dropped_to_, 0)),
+      regular_(std::exchange(o.regular_, false)),
+      errno_(std::exchange(o.errno_, 0)),
+      opts_(o.opts_),
+      buf_(std::move(o.buf_)) {}
+
+FileSource& FileSource::operator=(FileSource&& o) noexcept {
+    if (this != &o) {
+        close();
+        fd_ = std::exchange(o.fd_, -1);
+        map_ = std::exchange(o.map_, nullptr);
+        size_ = std::exchange(o.size_, 0);
+        pos_ = std::exchange(o.pos_, 0);
+        advised_to_ = std::exchange(o.advised_to_, 0);
+        dropped_to_ = std::exchange(o.dropped_to_, 0);
+        regular_ = std::exchange(o.regular_, false);
+        errno_ = std::exchange(o.errno_, 0);
+        opts_ = o.opts_;
+        buf_ = std::move(o.buf_);
+    }
+    return *this;
+}
+
+FileSource::~FileSource() { close(); }
+
+void FileSource::close() noexcept {
+    if (map_) munmap(const_cast<uint8_t*>(map_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    map_ = nullptr;
+    size_ = pos_ = advised_to_ = dropped_to_ = 0;
+    buf_.reset();
+}
+
+Status FileSource::open(const char* path, FileSource& out, const Options& opts) {
+    int fd;
+    do {
+        fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+        out.close();
+        out.errno_ = errno;
+        return Status::io_error;
+    }
+    return adopt(fd, out, opts);
+}
+
+Status FileSource::adopt(int fd, FileSource& out, const Options& opts) {
+    out.close();
+    Status s = out.init(fd, opts);
+    if (s != Status::ok) {
+        int err = out.errno_;
+        out.close();
+        out.errno_ = err;
+    }
+    return s;
+}
+
+Status FileSource::init(int fd, const Options& opts) {
+    fd_ = fd;
+    opts_ = opts;
+    if (opts_.chunk_size == 0) return Status::invalid_argument;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        errno_ = errno;
+        return Status::io_error;
+    }
+    regular_ = S_ISREG(st.st_mode);
+    if (regular_) size_ = static_cast<size_t>(st.st_size);
+
+    if (regular_ && size_ > 0 && !opts_.disable_mmap) {
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            map_ = static_cast<const uint8_t*>(p);
+            madvise(p, size_, MADV_SEQUENTIAL);
+            advise(0);
+            return Status::ok;
+        }
+        // Some file systems refuse mmap; read through the buffer instead.
+    }
+
+    buf_.reset(new (std::nothrow) uint8_t[opts_.chunk_size]);
+    if (!buf_) return Status::out_of_memory;
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (regular_) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    return Status::ok;
+}
+
+Status FileSource::reader(Reader& out) const noexcept {
+    if (!map_) return Status::unsupported;
+    out = Reader(map_, size_);
+    return Status::ok;
+}
+
+void FileSource::advise(size_t pos) noexcept { advise(pos, pos); }
+
+void FileSource::advise(size_t ahead_of, size_t parsed) noexcept {
+    if (!map_) return;
+    if (ahead_of > size_) ahead_of = size_;
+    uint8_t* base = const_cast<uint8_t*>(map_);
+
+    if (advised_to_ < size_ && ahead_of + opts_.readahead / 2 >= advised_to_) {
+        size_t start = page_floor(advised_to_ > ahead_of ? advised_to_ : ahead_of);
+        size_t end = opts_.readahead < size_ - ahead_of ? ahead_of + opts_.readahead : size_;
+        if (end > start) madvise(base + start, end - start, MADV_WILLNEED);
+        advised_to_ = end;
+    }
+
+    if (opts_.drop_behind) {
+        size_t upto = page_floor(parsed < ahead_of ? parsed : ahead_of);
+        if (upto >= dropped_to_ + opts_.readahead) {
+            madvise(base + dropped_to_, upto - dropped_to_, MADV_DONTNEED);
+            dropped_to_ = upto;
+        }
+    }
+}
+
+Status FileSource::next_chunk(std::span<const uint8_t>& out) {
+    if (fd_ < 0) return Status::invalid_argument;
+
+    if (map_) {
+        size_t n = size_ - pos_ < opts_.chunk_size ? size_ - pos_ : opts_.chunk_size;
+        out = {map_ + pos_, n};
+        pos_ += n;
+        // The caller has not parsed this chunk yet: only what came before
+        // it may be dropped.
+        advise(pos_, pos_ - n);
+        return Status::ok;
+    }
+
+    ssize_t got;
+    do {
+        // pread keeps regular files position independent; pipes cannot seek.
+        got = regular_ ? pread(fd_, buf_.get(), opts_.chunk_size, static_cast<off_t>(pos_))
+                       : read(fd_, buf_.get(), opts_.chunk_size);
+    } while (got < 0 && errno == EINTR);
+    if (got < 0) {
+        errno_ = errno;
+        out = {};
+        return Status::io_error;
+    }
+    out = {buf_.get(), static_cast<size_t>(got)};
+    pos_ += static_cast<size_t>(got);
+    return Status::ok;
+}
+
+}  // namespace bpw
@@ -0,0 +1,185 @@
+#include "bpw/layout_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "atomic_file.hpp"
+#include "bpw/crc32c.hpp"
+#include "bpw/file_source.hpp"
+
+namespace bpw {
+
+namespace {
+
+constexpr uint8_t magic[8] = {'B', 'P', 'W', 'L', 'A', 'Y', 'C', '1'};
+
+std::vector<RuntimeField> canonical(std::span<const RuntimeField> fields) {
+    std::vector<RuntimeField> sorted(fields.begin(), fields.end());
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const RuntimeField& a, const RuntimeField& b) { return a.offset < b.offset; });
+    return sorted;
+}
+
+uint64_t hash_sorted(std::span<const RuntimeField> sorted, size_t target_size) noexcept {
+    // FNV-1a taken a word at a time, with a final avalanche so that the
+    // low bits used for bucketing depend on every input bit.
+    uint64_t h = 0xcbf29ce484222325ull;
+    auto mix = [&h](uint64_t v) { h = (h ^ v) * 0x100000001b3ull; };
+    mix(target_size);
+    mix(sorted.size());
+    for (const RuntimeField& f : sorted) {
+        mix(static_cast<uint64_t>(f.kind) | static_cast<uint64_t>(f.endian) << 8);
+        mix(f.offset);
+        mix(f.width);
+        mix(f.target_offset);
+        mix(f.target_size);
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return h;
+}
+
+bool same_schema(const RuntimeLayout& l, std::span<const RuntimeField> sorted, size_t target_size) noexcept {
+    std::span<const RuntimeField> f = l.fields();
+    if (l.target_size() != target_size || f.size() != sorted.size()) return false;
+    for (size_t i = 0; i < f.size(); ++i) {
+        const RuntimeField& a = f[i];
+        const RuntimeField& b = sorted[i];
+        if (a.kind != b.kind || a.offset != b.offset || a.width != b.width || a.endian != b.endian ||
+            a.target_offset != b.target_offset || a.target_size != b.target_size)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+uint64_t schema_hash(std::span<const RuntimeField> fields, size_t target_size) {
+    return hash_sorted(canonical(fields), target_size);
+}
+
+const RuntimeLayout* LayoutCache::find(uint64_t hash, std::span<const RuntimeField> sorted,
+                                       size_t target_size) const {
+    auto [it, end] = layouts_.equal_range(hash);
+    for (; it != end; ++it)
+        if (same_schema(*it->second, sorted, target_size)) return it->second.get();
+    return nullptr;
+}
+
+Status LayoutCache::get(std::span<const RuntimeField> fields, size_t target_size, const RuntimeLayout*& out) {
+    try {
+        // Schemas usually arrive in wire order already; only copy when not.
+        std::vector<RuntimeField> copy;
+        std::span<const RuntimeField> sorted = fields;
+        if (!std::is_sorted(fields.begin(), fields.end(),
+                            [](const RuntimeField& a, const RuntimeField& b) { return a.offset < b.offset; })) {
+            copy = canonical(fields);
+            sorted = copy;
+        }
+        const uint64_t hash = hash_sorted(sorted, target_size);
+        // Compiling under the lock keeps a schema requested by several
+        // threads at once from being compiled more than once.
+        std::lock_guard<std::mutex> lk(m_);
+        if (const RuntimeLayout* hit = find(hash, sorted, target_size)) {
+            out = hit;
+            return Status::ok;
+        }
+        auto layout = std::make_unique<RuntimeLayout>();
+        if (Status s = RuntimeLayout::compile(sorted, target_size, *layout); s != Status::ok) return s;
+        ++compilations_;
+        out = layout.get();
+        layouts_.emplace(hash, std::move(layout));
+    } catch (const std::bad_alloc&) {
+        return Status::out_of_memory;
+    }
+    return Status::ok;
+}
+
+size_t LayoutCache::size() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return layouts_.size();
+}
+
+size_t LayoutCache::compilations() const {
+    std::lock_guard<std::mutex> lk(m_);
+    return compilations_;
+}
+
+Status LayoutCache::serialize(Writer& out) const {
+    std::lock_guard<std::mutex> lk(m_);
+    Status s = out.write_bytes(magic, sizeof(magic));
+    if (s == Status::ok) s = out.write_le<uint32_t>(version);
+    if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(layouts_.size()));
+    for (auto it = layouts_.begin(); s == Status::ok && it != layouts_.end(); ++it) {
+        s = out.write_le<uint64_t>(it->first);
+        // Size and checksum are patched in once the program is written.
+        const size_t head = out.size();
+        if (s == Status::ok) s = out.write_le<uint64_t>(0);
+        if (s == Status::ok) s = it->second->save(out);
+        if (s == Status::ok) {
+            const size_t n = out.size() - head - 8;
+            if (n > UINT32_MAX) return Status::invalid_argument;
+            store_le<uint32_t>(out.data() + head, static_cast<uint32_t>(n));
+            store_le<uint32_t>(out.data() + head + 4, crc32c(out.data() + head + 8, n));
+        }
+    }
+    return s;
+}
+
+Status LayoutCache::deserialize(Reader in) {
+    std::span<const uint8_t> m;
+    uint32_t ver, count;
+    if (in.read_bytes(sizeof(magic), m) != Status::ok || std::memcmp(m.data(), magic, sizeof(magic)) != 0)
+        return Status::malformed;
+    if (in.read_le(ver) != Status::ok || ver != version) return Status::unsupported;
+    if (in.read_le(count) != Status::ok) return Status::malformed;
+    // Each entry needs at least its 16-byte header.
+    if (count > in.remaining() / 16) return Status::malformed;
+
+    try {
+        std::vector<std::pair<uint64_t, std::unique_ptr<RuntimeLayout>>> loaded;
+        loaded.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            uint64_t hash;
+            uint32_t size, crc;
+            Reader program;
+            if (in.read_le(hash) != Status::ok || in.read_le(size) != Status::ok || in.read_le(crc) != Status::ok ||
+                in.sub_reader(size, program) != Status::ok)
+                return Status::malformed;
+            if (crc32c(program.data(), program.remaining()) != crc) return Status::malformed;
+            auto layout = std::make_unique<RuntimeLayout>();
+            if (Status s = RuntimeLayout::load(program, *layout); s != Status::ok) return s;
+            if (!program.empty() || hash_sorted(layout->fields(), layout->target_size()) != hash)
+                return Status::malformed;
+            loaded.emplace_back(hash, std::move(layout));
+        }
+        if (!in.empty()) return Status::malformed;
+
+        std::lock_guard<std::mutex> lk(m_);
+        for (auto& [hash, layout] : loaded) {
+            if (!find(hash, layout->fields(), layout->target_size())) layouts_.emplace(hash, std::move(layout));
+        }
+    } catch (const std::bad_alloc&) {
+        return Status::out_of_memory;
+    }
+    return Status::ok;
+}
+
+Status LayoutCache::save(const char* path) const {
+    Writer buf;
+    if (Status s = serialize(buf); s != Status::ok) return s;
+    return detail::write_file_atomic(path, {buf.data(), buf.size()});
+}
+
+Status LayoutCache::load(const char* path) {
+    FileSource file;
+    if (Status s = FileSource::open(path, file); s != Status::ok) return s;
+    Reader in;
+    if (file.reader(in) != Status::ok) return Status::malformed;  // empty or unmappable
+    return deserialize(in);
+}
+
+}  // namespace bpw
@@ -0,0 +1,168 @@
+#include "bpw/numa.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/mempolicy.h>)
+#define BPW_HAVE_NUMA 1
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+namespace bpw {
+
+namespace {
+
+size_t page_size() noexcept {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+#if BPW_HAVE_NUMA
+
+// Parse a sysfs list such as "0-3,8,10-11".
+bool parse_list(const char* path, std::vector<unsigned>& out) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) return false;
+    char buf[4096];
+    size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+    std::fclose(f);
+    buf[n] = '\0';
+    out.clear();
+    for (const char* p = buf; *p && *p != '\n';) {
+        char* end;
+        unsigned long lo = std::strtoul(p, &end, 10);
+        if (end == p) return false;
+        unsigned long hi = lo;
+        p = end;
+        if (*p == '-') {
+            hi = std::strtoul(p + 1, &end, 10);
+            if (end == p + 1 || hi < lo) return false;
+            p = end;
+        }
+        for (unsigned long v = lo; v <= hi; ++v) out.push_back(static_cast<unsigned>(v));
+        if (*p == ',') ++p;
+    }
+    return true;
+}
+
+long sys_mbind(void* p, size_t n, int mode, const unsigned long* mask, unsigned long maxnode,
+               unsigned flags) noexcept {
+    return syscall(__NR_mbind, p, n, mode, mask, maxnode, flags);
+}
+
+#endif
+
+}  // namespace
+
+Status NumaTopology::detect(NumaTopology& out) {
+    out = NumaTopology();
+    try {
+        std::vector<unsigned> allowed;
+#if BPW_HAVE_NUMA
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (unsigned c = 0; c < CPU_SETSIZE; ++c)
+                if (CPU_ISSET(c, &set)) allowed.push_back(c);
+        }
+        std::vector<unsigned> nodes, cpus;
+        if (!allowed.empty() && parse_list("/sys/devices/system/node/online", nodes)) {
+            for (unsigned id : nodes) {
+                char path[64];
+                std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", id);
+                if (!parse_list(path, cpus)) continue;
+                std::vector<unsigned> mine;
+                for (unsigned c : cpus)
+                    if (c < CPU_SETSIZE && CPU_ISSET(c, &set)) mine.push_back(c);
+                out.ids_.push_back(id);
+                out.cpus_.push_back(std::move(mine));
+            }
+            if (!out.ids_.empty()) return Status::ok;
+        }
+#endif
+        if (allowed.empty()) {
+            unsigned n = std::thread::hardware_concurrency();
+            for (unsigned c = 0; c < (n ? n : 1); ++c) allowed.push_back(c);
+        }
+        out.ids_.assign(1, 0);
+        out.cpus_.assign(1, std::move(allowed));
+        return Status::ok;
+    } catch (const std::bad_alloc&) {
+        out = NumaTopology();
+        return Status::out_of_memory;
+    }
+}
+
+Status pin_current_thread(std::span<const unsigned> cpus) noexcept {
+#if BPW_HAVE_NUMA
+    if (cpus.empty()) return Status::invalid_argument;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned c : cpus) {
+        if (c >= CPU_SETSIZE) return Status::invalid_argument;
+        CPU_SET(c, &set);
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? Status::ok : Status::io_error;
+#else
+    (void)cpus;
+    return Status::unsupported;
+#endif
+}
+
+int current_numa_node() noexcept {
+#if BPW_HAVE_NUMA && defined(__NR_getcpu)
+    unsigned cpu = 0, node = 0;
+    if (syscall(__NR_getcpu, &cpu, &node, nullptr) == 0) return static_cast<int>(node);
+#endif
+    return -1;
+}
+
+Status bind_to_node(void* p, size_t n, unsigned node_id) noexcept {
+#if BPW_HAVE_NUMA
+    constexpr unsigned bits = 8 * sizeof(unsigned long);
+    constexpr unsigned max_nodes = 1024;
+    if (node_id >= max_nodes) return Status::invalid_argument;
+    if (n == 0) return Status::ok;
+    const auto start = reinterpret_cast<uintptr_t>(p) & ~(page_size() - 1);
+    const size_t len = reinterpret_cast<uintptr_t>(p) + n - start;
+    unsigned long mask[max_nodes / bits] = {};
+    mask[node_id / bits] = 1ul << (node_id % bits);
+    if (sys_mbind(reinterpret_cast<void*>(start), len, MPOL_PREFERRED, mask, max_nodes + 1, MPOL_MF_MOVE) == 0)
+        return Status::ok;
+    return errno == ENOSYS || errno == EPERM ? Status::unsupported : Status::io_error;
+#else
+    (void)p;
+    (void)n;
+    (void)node_id;
+    return Status::unsupported;
+#endif
+}
+
+Status NumaBuffer::allocate(size_t n, NumaBuffer& out, int node_id) noexcept {
+    out.release();
+    if (n == 0) return Status::ok;
+    if (n > SIZE_MAX - page_size()) return Status::out_of_memory;
+    const size_t len = (n + page_size() - 1) & ~(page_size() - 1);
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) return Status::out_of_memory;
+    if (node_id >= 0) (void)bind_to_node(p, len, static_cast<unsigned>(node_id));
+    out.data_ = static_cast<uint8_t*>(p);
+    out.size_ = n;
+    return Status::ok;
+}
+
+void NumaBuffer::release() noexcept {
+    if (data_) munmap(data_, (size_ + page_size() - 1) & ~(page_size() - 1));
+    data_ = nullptr;
+    size_ = 0;
+}
+
+}  // namespace bpw
@@ -0,0 +1,104 @@
+#include "bpw/offset_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "atomic_file.hpp"
+#include "bpw/bulk.hpp"
+#include "bpw/file_source.hpp"
+
+namespace bpw {
+
+namespace {
+
+constexpr uint8_t magic[8] = {'B', 'P', 'W', 'I', 'D', 'X', '0', '1'};
+constexpr size_t header_size = 8 + 4 + 4 + 8 * 4;
+
+}  // namespace
+
+void OffsetIndex::sort_keys() { std::stable_sort(keys_.begin(), keys_.end()); }
+
+Status OffsetIndex::seek(Reader in, const Framing& framing, uint64_t record, Reader& out) const noexcept {
+    if (record >= record_count_) return Status::out_of_bounds;
+    if (in.remaining() != source_size_) return Status::invalid_argument;
+    uint64_t cp = record / stride_;
+    if (cp >= checkpoints_.size()) return Status::malformed;
+    if (Status s = in.skip(checkpoints_[cp]); s != Status::ok) return Status::malformed;
+    for (uint64_t k = cp * stride_; k < record; ++k) {
+        Reader skipped;
+        if (Status s = framing.next(in, skipped); s != Status::ok) return s;
+    }
+    out = Reader(in.data(), in.remaining());
+    return Status::ok;
+}
+
+Status OffsetIndex::find_key(uint64_t key, uint64_t& record) const noexcept {
+    auto it = std::lower_bound(keys_.begin(), keys_.end(), std::pair<uint64_t, uint64_t>{key, 0});
+    if (it == keys_.end() || it->first != key) return Status::out_of_bounds;
+    record = it->second;
+    return Status::ok;
+}
+
+Status OffsetIndex::serialize(Writer& out) const noexcept {
+    size_t total = header_size + checkpoints_.size() * 8 + keys_.size() * 16;
+    if (Status s = out.reserve(out.size() + total); s != Status::ok) return s;
+    Status s = out.write_bytes(magic, sizeof(magic));
+    if (s == Status::ok) s = out.write_le<uint32_t>(version);
+    if (s == Status::ok) s = out.write_le<uint32_t>(stride_);
+    if (s == Status::ok) s = out.write_le<uint64_t>(record_count_);
+    if (s == Status::ok) s = out.write_le<uint64_t>(source_size_);
+    if (s == Status::ok) s = out.write_le<uint64_t>(checkpoints_.size());
+    if (s == Status::ok) s = out.write_le<uint64_t>(keys_.size());
+    if (s == Status::ok) s = write_array<Endian::little>(out, checkpoints_.data(), checkpoints_.size());
+    for (size_t i = 0; s == Status::ok && i < keys_.size(); ++i) {
+        s = out.write_le<uint64_t>(keys_[i].first);
+        if (s == Status::ok) s = out.write_le<uint64_t>(keys_[i].second);
+    }
+    return s;
+}
+
+Status OffsetIndex::deserialize(Reader in, OffsetIndex& out) {
+    out = OffsetIndex();
+    std::span<const uint8_t> m;
+    uint32_t ver, stride;
+    uint64_t records, source, ncp, nkeys;
+    if (in.read_bytes(sizeof(magic), m) != Status::ok || std::memcmp(m.data(), magic, sizeof(magic)) != 0)
+        return Status::malformed;
+    if (in.read_le(ver) != Status::ok || ver != version) return Status::unsupported;
+    if (in.read_le(stride) != Status::ok || stride == 0) return Status::malformed;
+    if (in.read_le(records) != Status::ok || in.read_le(source) != Status::ok || in.read_le(ncp) != Status::ok ||
+        in.read_le(nkeys) != Status::ok)
+        return Status::malformed;
+    // Reject counts the remaining bytes cannot hold before allocating.
+    if (ncp > in.remaining() / 8 || nkeys > (in.remaining() - ncp * 8) / 16) return Status::malformed;
+    if (ncp != (records + stride - 1) / stride) return Status::malformed;
+
+    out.stride_ = stride;
+    out.record_count_ = records;
+    out.source_size_ = source;
+    out.checkpoints_.resize(ncp);
+    if (read_array<Endian::little>(in, out.checkpoints_.data(), ncp) != Status::ok) return Status::malformed;
+    out.keys_.resize(nkeys);
+    for (auto& kv : out.keys_) {
+        if (in.read_le(kv.first) != Status::ok || in.read_le(kv.second) != Status::ok) return Status::malformed;
+        if (kv.second >= records) return Status::malformed;
+    }
+    if (!std::is_sorted(out.keys_.begin(), out.keys_.end())) return Status::malformed;
+    return in.empty() ? Status::ok : Status::malformed;
+}
+
+Status OffsetIndex::save(const char* path) const {
+    Writer buf;
+    if (Status s = serialize(buf); s != Status::ok) return s;
+    return detail::write_file_atomic(path, {buf.data(), buf.size()});
+}
+
+Status OffsetIndex::load(const char* path, OffsetIndex& out) {
+    FileSource file;
+    if (Status s = FileSource::open(path, file); s != Status::ok) return s;
+    Reader in;
+    if (file.reader(in) != Status::ok) return Status::malformed;  // empty or unmappable
+    return deserialize(in, out);
+}
+
+}  // namespace bpw
@@ -0,0 +1,52 @@
+#include "bpw/parallel.hpp"
+
+#include <algorithm>
+#include <functional>
+
+namespace bpw {
+
+Status plan_ranges(Reader in, const Framing& framing, size_t target_bytes, std::vector<Range>& out) {
+    out.clear();
+    if (!framing.valid() || target_bytes == 0) return Status::invalid_argument;
+    const size_t base = in.position();
+    Range cur{0, 0, 0, 0};
+    size_t record = 0;
+    while (!in.empty()) {
+        Reader rec;
+        if (Status s = framing.next(in, rec); s != Status::ok) return s;
+        cur.size += rec.size();
+        ++cur.record_count;
+        ++record;
+        if (cur.size >= target_bytes) {
+            out.push_back(cur);
+            cur = Range{in.position() - base, 0, record, 0};
+        }
+    }
+    if (cur.size) out.push_back(cur);
+    return Status::ok;
+}
+
+Status plan_sync_ranges(Reader in, std::span<const uint8_t> marker, size_t target_bytes, std::vector<Range>& out) {
+    out.clear();
+    if (marker.empty() || target_bytes == 0) return Status::invalid_argument;
+    const uint8_t* begin = in.data();
+    const uint8_t* end = begin + in.remaining();
+    const std::boyer_moore_horspool_searcher search(marker.begin(), marker.end());
+
+    size_t start = 0;
+    const size_t total = in.remaining();
+    while (start < total) {
+        size_t cut = total - start > target_bytes ? start + target_bytes : total;
+        size_t next = total;
+        if (cut < total) {
+            // The next range starts at the first marker at or after the cut.
+            auto hit = std::search(begin + cut, end, search);
+            next = static_cast<size_t>(hit - begin);
+        }
+        out.push_back(Range{start, next - start, 0, 0});
+        start = next;
+    }
+    return Status::ok;
+}
+
+}  // namespace bpw
@@ -0,0 +1,125 @@
+#include "bpw/record_table.hpp"
+
+#include <new>
+
+#include "bpw/layout.hpp"
+
+namespace bpw {
+
+namespace {
+
+// Offsets are written through a raw cursor and the vector grows in large
+// steps, so the scan loop has no push_back bookkeeping.
+class OffsetSink {
+public:
+    explicit OffsetSink(std::vector<size_t>& v) : v_(v) {}
+
+    bool put(size_t off) {
+        if (n_ == v_.size()) {
+            try {
+                v_.resize(n_ < 1024 ? 1024 : n_ * 2);
+            } catch (const std::bad_alloc&) {
+                return false;
+            }
+        }
+        v_[n_++] = off;
+        return true;
+    }
+    void finish() { v_.resize(n_); }
+
+private:
+    std::vector<size_t>& v_;
+    size_t n_ = 0;
+};
+
+// Length-prefixed scan for one length width and byte order. Mirrors
+// Framing::frame_size / Framing::next.
+template <size_t W, Endian E>
+Status scan_lengths(const uint8_t* base, size_t total, const Framing& f, OffsetSink& sink) {
+    const size_t header = f.header_size;
+    const size_t at = f.length_offset;
+    const int64_t adjust = f.length_adjust;
+    const uint64_t max_size = f.max_size;
+    size_t pos = 0;
+    if (!sink.put(0)) return Status::out_of_memory;
+    while (pos < total) {
+        if (total - pos < header) return Status::out_of_bounds;
+        uint64_t len = detail::load_uint<W, E>(base + pos + at);
+        if (adjust >= 0) {
+            if (len > UINT64_MAX - static_cast<uint64_t>(adjust)) return Status::malformed;
+            len += static_cast<uint64_t>(adjust);
+        } else {
+            if (len < static_cast<uint64_t>(-adjust)) return Status::malformed;
+            len -= static_cast<uint64_t>(-adjust);
+        }
+        if (len < header || len == 0 || len > max_size) return Status::malformed;
+        if (len > total - pos) return Status::out_of_bounds;
+        pos += static_cast<size_t>(len);
+        if (!sink.put(pos)) return Status::out_of_memory;
+    }
+    return Status::ok;
+}
+
+template <size_t W>
+Status scan_width(const uint8_t* base, size_t total, const Framing& f, OffsetSink& sink) {
+    return f.length_endian == Endian::big ? scan_lengths<W, Endian::big>(base, total, f, sink)
+                                          : scan_lengths<W, Endian::little>(base, total, f, sink);
+}
+
+}  // namespace
+
+Status RecordTable::build(Reader in, const Framing& framing, RecordTable& out) {
+    out = RecordTable();
+    if (!framing.valid()) return Status::invalid_argument;
+    const uint8_t* base = in.data();
+    const size_t total = in.remaining();
+
+    if (framing.fixed_size) {
+        const size_t size = framing.fixed_size;
+        if (total % size) return in.bounds_error();
+        const size_t n = total / size;
+        try {
+            out.offsets_.resize(n + 1);
+        } catch (const std::bad_alloc&) {
+            return Status::out_of_memory;
+        }
+        size_t* o = out.offsets_.data();
+        for (size_t i = 0; i <= n; ++i) o[i] = i * size;
+        return Status::ok;
+    }
+
+    OffsetSink sink(out.offsets_);
+    Status s;
+    switch (framing.length_width) {
+    case 1: s = scan_width<1>(base, total, framing, sink); break;
+    case 2: s = scan_width<2>(base, total, framing, sink); break;
+    case 4: s = scan_width<4>(base, total, framing, sink); break;
+    default: s = scan_width<8>(base, total, framing, sink); break;
+    }
+    if (s != Status::ok) {
+        out = RecordTable();
+        if (s == Status::out_of_bounds) return in.bounds_error();
+        return s;
+    }
+    sink.finish();
+    return Status::ok;
+}
+
+Status RecordTable::ranges(size_t target_bytes, std::vector<Range>& out) const {
+    out.clear();
+    if (target_bytes == 0) return Status::invalid_argument;
+    const size_t n = size();
+    Range cur{0, 0, 0, 0};
+    for (size_t i = 0; i < n; ++i) {
+        ++cur.record_count;
+        cur.size = offsets_[i + 1] - cur.offset;
+        if (cur.size >= target_bytes) {
+            out.push_back(cur);
+            cur = Range{offsets_[i + 1], 0, i + 1, 0};
+        }
+    }
+    if (cur.size) out.push_back(cur);
+    return Status::ok;
+}
+
+}  // namespace bpw
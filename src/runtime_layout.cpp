@@ -0,0 +1,400 @@
+#include "bpw/runtime_layout.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "bpw/layout.hpp"
+
+namespace bpw {
+
+namespace {
+
+using detail::RuntimeHandler;
+using detail::RuntimeOp;
+
+constexpr Endian native_endian = std::endian::native == std::endian::little ? Endian::little : Endian::big;
+
+// Handlers finish by calling the next op's handler in tail position, which
+// the compiler turns into a jump; the terminating op simply returns.
+#define BPW_RUNTIME_NEXT(op, src, dst) (op)[1].fn((op) + 1, (src), (dst))
+
+void op_end(const RuntimeOp*, const uint8_t*, uint8_t*) noexcept {}
+
+template <unsigned D>
+inline void store_native(uint8_t* p, uint64_t v) noexcept {
+    if constexpr (D == 1) *p = static_cast<uint8_t>(v);
+    else if constexpr (D == 2) { uint16_t x = static_cast<uint16_t>(v); std::memcpy(p, &x, 2); }
+    else if constexpr (D == 4) { uint32_t x = static_cast<uint32_t>(v); std::memcpy(p, &x, 4); }
+    else std::memcpy(p, &v, 8);
+}
+
+template <unsigned D>
+inline uint64_t load_native(const uint8_t* p) noexcept {
+    if constexpr (D == 1) return *p;
+    else if constexpr (D == 2) { uint16_t x; std::memcpy(&x, p, 2); return x; }
+    else if constexpr (D == 4) { uint32_t x; std::memcpy(&x, p, 4); return x; }
+    else { uint64_t x; std::memcpy(&x, p, 8); return x; }
+}
+
+// ---------------------------------------------------------------- decode
+
+template <unsigned W, Endian E, bool Signed, unsigned D>
+void decode_int(const RuntimeOp* op, const uint8_t* wire, uint8_t* target) noexcept {
+    uint64_t v = detail::load_uint<W, E>(wire + op->wire);
+    if constexpr (Signed && W < 8) {
+        constexpr uint64_t sign = uint64_t{1} << (8 * W - 1);
+        v = (v ^ sign) - sign;
+    }
+    store_native<D>(target + op->target, v);
+    BPW_RUNTIME_NEXT(op, wire, target);
+}
+
+template <unsigned W, Endian E>
+void decode_bool(const RuntimeOp* op, const uint8_t* wire, uint8_t* target) noexcept {
+    target[op->target] = detail::load_uint<W, E>(wire + op->wire) != 0;
+    BPW_RUNTIME_NEXT(op, wire, target);
+}
+
+void decode_copy(const RuntimeOp* op, const uint8_t* wire, uint8_t* target) noexcept {
+    std::memcpy(target + op->target, wire + op->wire, op->len);
+    BPW_RUNTIME_NEXT(op, wire, target);
+}
+
+// ---------------------------------------------------------------- encode
+// Encode handlers receive the target object as `src` and the wire record
+// as `dst`.
+
+template <unsigned W, Endian E, unsigned D>
+void encode_int(const RuntimeOp* op, const uint8_t* target, uint8_t* wire) noexcept {
+    detail::store_uint<W, E>(wire + op->wire, load_native<D>(target + op->target));
+    BPW_RUNTIME_NEXT(op, target, wire);
+}
+
+template <unsigned W, Endian E>
+void encode_bool(const RuntimeOp* op, const uint8_t* target, uint8_t* wire) noexcept {
+    detail::store_uint<W, E>(wire + op->wire, target[op->target] != 0);
+    BPW_RUNTIME_NEXT(op, target, wire);
+}
+
+void encode_copy(const RuntimeOp* op, const uint8_t* target, uint8_t* wire) noexcept {
+    std::memcpy(wire + op->wire, target + op->target, op->len);
+    BPW_RUNTIME_NEXT(op, target, wire);
+}
+
+// Zero a gap between wire fields.
+void encode_fill(const RuntimeOp* op, const uint8_t* target, uint8_t* wire) noexcept {
+    std::memset(wire + op->wire, 0, op->len);
+    BPW_RUNTIME_NEXT(op, target, wire);
+}
+
+#undef BPW_RUNTIME_NEXT
+
+// ---------------------------------------------------------------- handler tables
+
+constexpr unsigned size_log2(size_t d) { return d == 1 ? 0 : d == 2 ? 1 : d == 4 ? 2 : 3; }
+constexpr Endian endian_at(size_t e) { return e ? Endian::big : Endian::little; }
+
+// Index: ((width - 1) * 2 + big) * 2 + signed) * 4 + log2(target size).
+template <size_t... I>
+constexpr auto make_decode_int_table(std::index_sequence<I...>) {
+    return std::array<RuntimeHandler, sizeof...(I)>{
+        &decode_int<I / 16 + 1, endian_at(I / 8 % 2), (I / 4 % 2) != 0, (1u << (I % 4))>...};
+}
+constexpr auto decode_int_table = make_decode_int_table(std::make_index_sequence<128>());
+
+// Index: ((width - 1) * 2 + big) * 4 + log2(target size).
+template <size_t... I>
+constexpr auto make_encode_int_table(std::index_sequence<I...>) {
+    return std::array<RuntimeHandler, sizeof...(I)>{&encode_int<I / 8 + 1, endian_at(I / 4 % 2), (1u << (I % 4))>...};
+}
+constexpr auto encode_int_table = make_encode_int_table(std::make_index_sequence<64>());
+
+// Index: (width - 1) * 2 + big.
+template <size_t... I>
+constexpr auto make_bool_tables(std::index_sequence<I...>) {
+    return std::pair{std::array<RuntimeHandler, sizeof...(I)>{&decode_bool<I / 2 + 1, endian_at(I % 2)>...},
+                     std::array<RuntimeHandler, sizeof...(I)>{&encode_bool<I / 2 + 1, endian_at(I % 2)>...}};
+}
+constexpr auto bool_tables = make_bool_tables(std::make_index_sequence<16>());
+
+// ---------------------------------------------------------------- handler ids
+// Saved programs name handlers by their position in this list. Changing any
+// table above or the order here changes the ids: bump program_version.
+
+constexpr uint32_t program_version = 1;
+
+constexpr size_t id_decode_int = 4;
+constexpr size_t id_encode_int = id_decode_int + decode_int_table.size();
+constexpr size_t id_decode_bool = id_encode_int + encode_int_table.size();
+constexpr size_t id_encode_bool = id_decode_bool + bool_tables.first.size();
+constexpr size_t handler_count = id_encode_bool + bool_tables.second.size();
+
+constexpr auto make_handler_ids() {
+    std::array<RuntimeHandler, handler_count> h{&op_end, &decode_copy, &encode_copy, &encode_fill};
+    for (size_t i = 0; i < decode_int_table.size(); ++i) h[id_decode_int + i] = decode_int_table[i];
+    for (size_t i = 0; i < encode_int_table.size(); ++i) h[id_encode_int + i] = encode_int_table[i];
+    for (size_t i = 0; i < bool_tables.first.size(); ++i) h[id_decode_bool + i] = bool_tables.first[i];
+    for (size_t i = 0; i < bool_tables.second.size(); ++i) h[id_encode_bool + i] = bool_tables.second[i];
+    return h;
+}
+constexpr auto handler_ids = make_handler_ids();
+
+size_t handler_id(RuntimeHandler fn) noexcept {
+    return static_cast<size_t>(std::find(handler_ids.begin(), handler_ids.end(), fn) - handler_ids.begin());
+}
+
+// Whether op `id` may appear in a decode (or encode) program and stays
+// within a record of `size` bytes and a target of `target_size` bytes.
+// Compiled programs visit the wire in order and touch each byte at most
+// once, so the op must also start at or after `wire_end`, the end of the
+// previous op, which it then advances. That keeps a loaded program's cost
+// per record linear in the record size, however many ops it lists.
+bool op_in_bounds(size_t id, const RuntimeOp& op, bool decode, size_t size, size_t target_size,
+                  size_t& wire_end) noexcept {
+    size_t w = 0, d = 0;
+    if (id == 1 || id == 2) {
+        if ((id == 1) != decode) return false;
+        w = d = op.len;
+    } else if (id == 3) {
+        if (decode) return false;
+        w = op.len;
+    } else if (id >= id_decode_int && id < id_encode_int) {
+        if (!decode) return false;
+        size_t i = id - id_decode_int;
+        w = i / 16 + 1;
+        d = size_t{1} << (i % 4);
+    } else if (id >= id_encode_int && id < id_decode_bool) {
+        if (decode) return false;
+        size_t i = id - id_encode_int;
+        w = i / 8 + 1;
+        d = size_t{1} << (i % 4);
+    } else if (id >= id_decode_bool && id < handler_count) {
+        if ((id < id_encode_bool) != decode) return false;
+        w = (id - (id < id_encode_bool ? id_decode_bool : id_encode_bool)) / 2 + 1;
+        d = 1;
+    } else {
+        return false;
+    }
+    if (w == 0 || op.wire < wire_end || op.wire > size || w > size - op.wire) return false;
+    if (op.target > target_size || d > target_size - op.target) return false;
+    wire_end = op.wire + w;
+    return true;
+}
+
+// ---------------------------------------------------------------- compilation
+
+bool valid(const RuntimeField& f, size_t target_size) {
+    const size_t w = f.width, d = f.target_size;
+    if (f.target_offset > target_size || d > target_size - f.target_offset) return false;
+    switch (f.kind) {
+    case FieldKind::unsigned_int:
+    case FieldKind::signed_int: return w >= 1 && w <= 8 && (d == 1 || d == 2 || d == 4 || d == 8) && w <= d;
+    case FieldKind::floating: return (w == 4 || w == 8) && d == w;
+    case FieldKind::boolean: return w >= 1 && w <= 8 && d == 1;
+    case FieldKind::bytes: return w >= 1 && d == w;
+    }
+    return false;
+}
+
+// The wire bytes are the target bytes: a plain copy.
+bool copyable(const RuntimeField& f) {
+    switch (f.kind) {
+    case FieldKind::bytes: return true;
+    case FieldKind::unsigned_int:
+    case FieldKind::signed_int:
+    case FieldKind::floating: return f.width == f.target_size && (f.width == 1 || f.endian == native_endian);
+    case FieldKind::boolean: return false;
+    }
+    return false;
+}
+
+size_t int_slot(const RuntimeField& f) {
+    return (f.width - 1) * 2 + (f.endian == Endian::big);
+}
+
+// Append a copy op, extending the previous one when both sides continue it.
+void push_copy(std::vector<RuntimeOp>& ops, RuntimeHandler copy, uint32_t wire, uint32_t target, uint32_t len) {
+    if (!ops.empty()) {
+        RuntimeOp& last = ops.back();
+        if (last.fn == copy && last.wire + last.len == wire && last.target + last.len == target) {
+            last.len += len;
+            return;
+        }
+    }
+    ops.push_back({copy, wire, target, len});
+}
+
+Status save_program(Writer& out, const std::vector<RuntimeOp>& ops) noexcept {
+    Status s = out.write_le(static_cast<uint32_t>(ops.size()));
+    for (size_t i = 0; s == Status::ok && i < ops.size(); ++i) {
+        s = out.write_le(static_cast<uint16_t>(handler_id(ops[i].fn)));
+        if (s == Status::ok) s = out.write_le(ops[i].wire);
+        if (s == Status::ok) s = out.write_le(ops[i].target);
+        if (s == Status::ok) s = out.write_le(ops[i].len);
+    }
+    return s;
+}
+
+Status load_program(Reader& in, bool decode, size_t size, size_t target_size, std::vector<RuntimeOp>& ops) {
+    uint32_t n;
+    if (Status s = in.read_le(n); s != Status::ok) return s;
+    constexpr size_t op_bytes = 14;
+    if (n == 0 || n > in.remaining() / op_bytes) return Status::malformed;
+    ops.resize(n);
+    size_t wire_end = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint16_t id;
+        RuntimeOp& op = ops[i];
+        if (in.read_le(id) != Status::ok || in.read_le(op.wire) != Status::ok || in.read_le(op.target) != Status::ok ||
+            in.read_le(op.len) != Status::ok)
+            return Status::malformed;
+        // Exactly one terminating op, at the end.
+        if ((id == 0) != (i + 1 == n)) return Status::malformed;
+        if (id != 0 && !op_in_bounds(id, op, decode, size, target_size, wire_end)) return Status::malformed;
+        op.fn = handler_ids[id];
+    }
+    return Status::ok;
+}
+
+}  // namespace
+
+Status RuntimeLayout::compile(std::span<const RuntimeField> fields, size_t target_size, RuntimeLayout& out) {
+    if (fields.empty() || target_size > UINT32_MAX) return Status::invalid_argument;
+    try {
+        std::vector<RuntimeField> sorted(fields.begin(), fields.end());
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [](const RuntimeField& a, const RuntimeField& b) { return a.offset < b.offset; });
+
+        size_t end = 0;
+        for (const RuntimeField& f : sorted) {
+            if (!valid(f, target_size) || f.offset < end || f.offset > UINT32_MAX - f.width)
+                return Status::invalid_argument;
+            end = f.offset + f.width;
+        }
+
+        std::vector<RuntimeOp> dec, enc;
+        size_t wire_end = 0;
+        for (const RuntimeField& f : sorted) {
+            auto wire = static_cast<uint32_t>(f.offset);
+            auto target = static_cast<uint32_t>(f.target_offset);
+            auto len = static_cast<uint32_t>(f.width);
+            if (f.offset > wire_end)
+                enc.push_back({&encode_fill, static_cast<uint32_t>(wire_end), 0,
+                               static_cast<uint32_t>(f.offset - wire_end)});
+            wire_end = f.offset + f.width;
+
+            if (copyable(f)) {
+                push_copy(dec, &decode_copy, wire, target, len);
+                push_copy(enc, &encode_copy, wire, target, len);
+            } else if (f.kind == FieldKind::boolean) {
+                dec.push_back({bool_tables.first[int_slot(f)], wire, target, len});
+                enc.push_back({bool_tables.second[int_slot(f)], wire, target, len});
+            } else {
+                size_t d = size_log2(f.target_size);
+                bool sign = f.kind == FieldKind::signed_int;
+                dec.push_back({decode_int_table[(int_slot(f) * 2 + sign) * 4 + d], wire, target, len});
+                enc.push_back({encode_int_table[int_slot(f) * 4 + d], wire, target, len});
+            }
+        }
+        dec.push_back({&op_end, 0, 0, 0});
+        enc.push_back({&op_end, 0, 0, 0});
+
+        out.fields_ = std::move(sorted);
+        out.decode_ = std::move(dec);
+        out.encode_ = std::move(enc);
+        out.size_ = end;
+        out.target_size_ = target_size;
+    } catch (const std::bad_alloc&) {
+        return Status::out_of_memory;
+    }
+    return Status::ok;
+}
+
+Status RuntimeLayout::parse_many(Reader& in, size_t count, void* targets, size_t stride) const noexcept {
+    if (empty()) return Status::invalid_argument;
+    if (count > in.remaining() / size_) return in.bounds_error();
+    const uint8_t* wire = in.data();
+    auto* target = static_cast<uint8_t*>(targets);
+    const RuntimeOp* ops = decode_.data();
+    for (size_t i = 0; i < count; ++i, wire += size_, target += stride) run(ops, wire, target);
+    in.count_records(count);
+    return in.skip(count * size_);
+}
+
+Status RuntimeLayout::write_many(Writer& out, size_t count, const void* targets, size_t stride) const noexcept {
+    if (empty() || count > SIZE_MAX / size_) return Status::invalid_argument;
+    const size_t n = count * size_;
+    uint8_t* wire = out.prepare(n);
+    if (!wire) return out.failure();
+    auto* target = static_cast<const uint8_t*>(targets);
+    const RuntimeOp* ops = encode_.data();
+    for (size_t i = 0; i < count; ++i, wire += size_, target += stride) run(ops, target, wire);
+    out.commit(n);
+    out.count_records(count);
+    return Status::ok;
+}
+
+Status RuntimeLayout::save(Writer& out) const noexcept {
+    if (fields_.empty()) return Status::invalid_argument;
+    Status s = out.write_le(program_version);
+    if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(size_));
+    if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(target_size_));
+    if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(fields_.size()));
+    for (size_t i = 0; s == Status::ok && i < fields_.size(); ++i) {
+        const RuntimeField& f = fields_[i];
+        s = out.write_u8(static_cast<uint8_t>(f.kind));
+        if (s == Status::ok) s = out.write_u8(static_cast<uint8_t>(f.endian));
+        if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(f.offset));
+        if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(f.width));
+        if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(f.target_offset));
+        if (s == Status::ok) s = out.write_le(static_cast<uint32_t>(f.target_size));
+    }
+    if (s == Status::ok) s = save_program(out, decode_);
+    if (s == Status::ok) s = save_program(out, encode_);
+    return s;
+}
+
+Status RuntimeLayout::load(Reader& in, RuntimeLayout& out) {
+    uint32_t version, size, target_size, nfields;
+    if (Status s = in.read_le(version); s != Status::ok) return s;
+    if (version != program_version) return Status::unsupported;
+    if (in.read_le(size) != Status::ok || in.read_le(target_size) != Status::ok || in.read_le(nfields) != Status::ok)
+        return Status::malformed;
+    constexpr size_t field_bytes = 18;
+    if (nfields == 0 || nfields > in.remaining() / field_bytes) return Status::malformed;
+    try {
+        RuntimeLayout l;
+        l.fields_.resize(nfields);
+        size_t end = 0;
+        for (RuntimeField& f : l.fields_) {
+            uint8_t kind, endian;
+            uint32_t offset, width, target_offset, tsize;
+            if (in.read_u8(kind) != Status::ok || in.read_u8(endian) != Status::ok ||
+                in.read_le(offset) != Status::ok || in.read_le(width) != Status::ok ||
+                in.read_le(target_offset) != Status::ok || in.read_le(tsize) != Status::ok)
+                return Status::malformed;
+            if (kind > static_cast<uint8_t>(FieldKind::bytes) || endian > 1) return Status::malformed;
+            f = RuntimeField{static_cast<FieldKind>(kind), offset, width, static_cast<Endian>(endian), target_offset,
+                             tsize};
+            // Sorted and disjoint, ending at the record size, as compile() leaves them.
+            if (!valid(f, target_size) || offset < end || offset > size || width > size - offset)
+                return Status::malformed;
+            end = size_t{offset} + width;
+        }
+        if (end != size) return Status::malformed;
+        l.size_ = size;
+        l.target_size_ = target_size;
+        if (Status s = load_program(in, true, size, target_size, l.decode_); s != Status::ok) return s;
+        if (Status s = load_program(in, false, size, target_size, l.encode_); s != Status::ok) return s;
+        out = std::move(l);
+    } catch (const std::bad_alloc&) {
+        return Status::out_of_memory;
+    }
+    return Status::ok;
+}
+
+}  // namespace bpw
@@ -0,0 +1,47 @@
+#include "bpw/segment_writer.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <iterator>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace bpw {
+
+Status SegmentWriter::write_to(int fd, int* err) const {
+#ifdef IOV_MAX
+    constexpr size_t max_iov = IOV_MAX;
+#else
+    constexpr size_t max_iov = 1024;
+#endif
+    size_t first = 0;   // first iovec not fully written
+    size_t done = 0;    // bytes of iov_[first] already written
+    iovec batch[max_iov < 1024 ? max_iov : 1024];
+
+    while (first < iov_.size()) {
+        size_t n = 0;
+        for (size_t i = first; i < iov_.size() && n < std::size(batch); ++i, ++n) batch[n] = iov_[i];
+        batch[0].iov_base = static_cast<uint8_t*>(batch[0].iov_base) + done;
+        batch[0].iov_len -= done;
+
+        ssize_t w = ::writev(fd, batch, static_cast<int>(n));
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (err) *err = errno;
+            return Status::io_error;
+        }
+        if (w == 0) {
+            if (err) *err = EIO;
+            return Status::io_error;
+        }
+
+        // Advance past what the kernel took.
+        size_t left = static_cast<size_t>(w) + done;
+        while (first < iov_.size() && left >= iov_[first].iov_len) left -= iov_[first++].iov_len;
+        done = left;
+    }
+    return Status::ok;
+}
+
+}  // namespace bpw
@@ -0,0 +1,412 @@
+#include "bpw/simd.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#include "bpw/bit_reader.hpp"
+#include "bpw/endian.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BPW_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define BPW_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace bpw::simd {
+
+namespace {
+
+using SwapFn = void (*)(const uint8_t*, uint8_t*, size_t) noexcept;
+using UnpackFn = void (*)(const uint8_t*, unsigned, size_t, uint32_t*) noexcept;
+
+struct Kernels {
+    SwapFn bswap16;
+    SwapFn bswap32;
+    SwapFn bswap64;
+    UnpackFn unpack_bits;
+};
+
+// ---------------------------------------------------------------- scalar
+
+template <class T>
+void bswap_scalar(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        T v;
+        std::memcpy(&v, src + i * sizeof(T), sizeof(T));
+        v = byteswap(v);
+        std::memcpy(dst + i * sizeof(T), &v, sizeof(T));
+    }
+}
+
+void unpack_bits_scalar(const uint8_t* src, unsigned width, size_t count, uint32_t* dst) noexcept {
+    BitReader br(src, packed_size(width, count));
+    for (size_t i = 0; i < count; ++i) dst[i] = br.read_bits(width);
+}
+
+constexpr Kernels scalar_kernels = {
+    bswap_scalar<uint16_t>, bswap_scalar<uint32_t>, bswap_scalar<uint64_t>, unpack_bits_scalar,
+};
+
+// ---------------------------------------------------------------- x86
+
+#if BPW_SIMD_X86
+
+// Byte-reversal shuffles for 2/4/8-byte lanes within a 16-byte vector.
+alignas(16) constexpr uint8_t rev16_mask[16] = {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14};
+alignas(16) constexpr uint8_t rev32_mask[16] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+alignas(16) constexpr uint8_t rev64_mask[16] = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+template <class T>
+constexpr const uint8_t* rev_mask() {
+    if constexpr (sizeof(T) == 2) return rev16_mask;
+    else if constexpr (sizeof(T) == 4) return rev32_mask;
+    else return rev64_mask;
+}
+
+template <class T>
+__attribute__((target("ssse3"))) void bswap_ssse3(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(rev_mask<T>()));
+    size_t bytes = count * sizeof(T);
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 16), _mm_shuffle_epi8(b, mask));
+    }
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(a, mask));
+    }
+    bswap_scalar<T>(src + i, dst + i, (bytes - i) / sizeof(T));
+}
+
+template <class T>
+__attribute__((target("avx2"))) void bswap_avx2(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    const __m256i mask = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(rev_mask<T>())));
+    size_t bytes = count * sizeof(T);
+    size_t i = 0;
+    for (; i + 64 <= bytes; i += 64) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 32), _mm256_shuffle_epi8(b, mask));
+    }
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(a, mask));
+    }
+    bswap_scalar<T>(src + i, dst + i, (bytes - i) / sizeof(T));
+}
+
+// Eight values per step. Each block of 8 values starts on a byte boundary
+// (8 * width bits), so the per-lane byte offsets and shifts are constants:
+// gather the big-endian word holding each value, byte-swap it, shift the
+// value to the top and then down into place.
+__attribute__((target("avx2"))) void unpack_bits_avx2(const uint8_t* src, unsigned width, size_t count,
+                                                      uint32_t* dst) noexcept {
+    const size_t nbytes = packed_size(width, count);
+    const size_t block_bytes = width;  // 8 values * width bits / 8
+    alignas(32) int32_t off[8];
+    alignas(32) uint32_t shl[8];
+    for (unsigned j = 0; j < 8; ++j) {
+        off[j] = static_cast<int32_t>((j * width) >> 3);
+        shl[j] = (j * width) & 7;
+    }
+    const __m256i voff = _mm256_load_si256(reinterpret_cast<const __m256i*>(off));
+    const __m256i vshl = _mm256_load_si256(reinterpret_cast<const __m256i*>(shl));
+    size_t i = 0;
+    const uint8_t* p = src;
+
+    if (width <= 25) {
+        // shift (<= 7) + width fits in one 32-bit word.
+        const __m256i rev = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(rev32_mask)));
+        const __m128i shr = _mm_cvtsi32_si128(static_cast<int>(32 - width));
+        const size_t reach = static_cast<size_t>(off[7]) + 4;
+        for (; i + 8 <= count && static_cast<size_t>(p - src) + reach <= nbytes; i += 8, p += block_bytes) {
+            __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(p), voff, 1);
+            v = _mm256_shuffle_epi8(v, rev);
+            v = _mm256_sllv_epi32(v, vshl);
+            v = _mm256_srl_epi32(v, shr);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+    } else {
+        // Needs up to 39 bits: gather 64-bit words, four lanes at a time.
+        const __m256i rev = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(rev64_mask)));
+        const __m128i shr = _mm_cvtsi32_si128(static_cast<int>(64 - width));
+        const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        const __m128i off_lo = _mm256_castsi256_si128(voff);
+        const __m128i off_hi = _mm256_extracti128_si256(voff, 1);
+        const __m256i shl_lo = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(vshl));
+        const __m256i shl_hi = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(vshl, 1));
+        const size_t reach = static_cast<size_t>(off[7]) + 8;
+        for (; i + 8 <= count && static_cast<size_t>(p - src) + reach <= nbytes; i += 8, p += block_bytes) {
+            const auto* base = reinterpret_cast<const long long*>(p);
+            __m256i lo = _mm256_i32gather_epi64(base, off_lo, 1);
+            __m256i hi = _mm256_i32gather_epi64(base, off_hi, 1);
+            lo = _mm256_srl_epi64(_mm256_sllv_epi64(_mm256_shuffle_epi8(lo, rev), shl_lo), shr);
+            hi = _mm256_srl_epi64(_mm256_sllv_epi64(_mm256_shuffle_epi8(hi, rev), shl_hi), shr);
+            __m128i a = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(lo, even));
+            __m128i b = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(hi, even));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_set_m128i(b, a));
+        }
+    }
+    // i is a multiple of 8, so the tail also starts on a byte boundary.
+    unpack_bits_scalar(p, width, count - i, dst + i);
+}
+
+// Low 32 bits of a * b per lane; SSE4.1's pmulld from two SSE2 pmuludq.
+__attribute__((target("ssse3"))) inline __m128i mullo_epi32_sse2(__m128i a, __m128i b) noexcept {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// The AVX2 scheme without gathers or variable shifts: pshufb does the
+// gather and the byte swap from a 16-byte load, and the per-lane left
+// shift is a multiply by 1 << shift.
+__attribute__((target("ssse3"))) void unpack_bits_ssse3(const uint8_t* src, unsigned width, size_t count,
+                                                        uint32_t* dst) noexcept {
+    const size_t nbytes = packed_size(width, count);
+    const size_t block_bytes = width;
+    unsigned off[8], shl[8];
+    for (unsigned j = 0; j < 8; ++j) {
+        off[j] = (j * width) >> 3;
+        shl[j] = (j * width) & 7;
+    }
+    alignas(16) uint8_t gather[4][16];
+    std::memset(gather, 0x80, sizeof(gather));  // high bit set: zero the byte
+    size_t i = 0;
+    const uint8_t* p = src;
+
+    if (width <= 25) {
+        // Four 32-bit lanes per load: values 0-3 from p, 4-7 from p + off[4].
+        alignas(16) uint32_t mul[2][4];
+        for (unsigned j = 0; j < 8; ++j) {
+            const unsigned h = j / 4, k = j % 4, r = off[j] - off[4 * h];
+            for (unsigned b = 0; b < 4; ++b) gather[h][4 * k + b] = static_cast<uint8_t>(r + 3 - b);
+            mul[h][k] = 1u << shl[j];
+        }
+        const __m128i g0 = _mm_load_si128(reinterpret_cast<const __m128i*>(gather[0]));
+        const __m128i g1 = _mm_load_si128(reinterpret_cast<const __m128i*>(gather[1]));
+        const __m128i m0 = _mm_load_si128(reinterpret_cast<const __m128i*>(mul[0]));
+        const __m128i m1 = _mm_load_si128(reinterpret_cast<const __m128i*>(mul[1]));
+        const __m128i shr = _mm_cvtsi32_si128(static_cast<int>(32 - width));
+        const size_t reach = size_t{off[4]} + 16;
+        for (; i + 8 <= count && static_cast<size_t>(p - src) + reach <= nbytes; i += 8, p += block_bytes) {
+            __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), g0);
+            __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + off[4])), g1);
+            lo = _mm_srl_epi32(mullo_epi32_sse2(lo, m0), shr);
+            hi = _mm_srl_epi32(mullo_epi32_sse2(hi, m1), shr);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), hi);
+        }
+    } else {
+        // Up to 39 bits: two 64-bit lanes per load, each holding the 40-bit
+        // big-endian window at the value's first byte as b1..b4 in the low
+        // half and b0 in the high half. pmuludq only multiplies low halves,
+        // so the window is shifted in two parts and added back together.
+        alignas(16) uint64_t mul[4][2];
+        for (unsigned j = 0; j < 8; ++j) {
+            const unsigned q = j / 2, k = j % 2, r = off[j] - off[2 * q];
+            for (unsigned b = 0; b < 4; ++b) gather[q][8 * k + b] = static_cast<uint8_t>(r + 4 - b);
+            gather[q][8 * k + 4] = static_cast<uint8_t>(r);
+            mul[q][k] = uint64_t{1} << shl[j];
+        }
+        const __m128i shr = _mm_cvtsi32_si128(static_cast<int>(40 - width));
+        const __m128i mask = _mm_set1_epi64x(static_cast<long long>((uint64_t{1} << width) - 1));
+        const size_t reach = size_t{off[6]} + 16;
+        for (; i + 8 <= count && static_cast<size_t>(p - src) + reach <= nbytes; i += 8, p += block_bytes) {
+            __m128i t[4];
+            for (unsigned q = 0; q < 4; ++q) {
+                const __m128i g = _mm_load_si128(reinterpret_cast<const __m128i*>(gather[q]));
+                const __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(mul[q]));
+                __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + off[2 * q])), g);
+                __m128i w = _mm_add_epi64(_mm_mul_epu32(v, m),
+                                          _mm_slli_epi64(_mm_mul_epu32(_mm_srli_epi64(v, 32), m), 32));
+                t[q] = _mm_shuffle_epi32(_mm_and_si128(_mm_srl_epi64(w, shr), mask), _MM_SHUFFLE(0, 0, 2, 0));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(t[0], t[1]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpacklo_epi64(t[2], t[3]));
+        }
+    }
+    unpack_bits_scalar(p, width, count - i, dst + i);
+}
+
+constexpr Kernels ssse3_kernels = {
+    bswap_ssse3<uint16_t>, bswap_ssse3<uint32_t>, bswap_ssse3<uint64_t>, unpack_bits_ssse3,
+};
+constexpr Kernels avx2_kernels = {
+    bswap_avx2<uint16_t>, bswap_avx2<uint32_t>, bswap_avx2<uint64_t>, unpack_bits_avx2,
+};
+
+#endif  // BPW_SIMD_X86
+
+// ---------------------------------------------------------------- NEON
+
+#if BPW_SIMD_NEON
+
+template <class T>
+void bswap_neon(const uint8_t* src, uint8_t* dst, size_t count) noexcept {
+    size_t bytes = count * sizeof(T);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        uint8x16_t v = vld1q_u8(src + i);
+        if constexpr (sizeof(T) == 2) v = vrev16q_u8(v);
+        else if constexpr (sizeof(T) == 4) v = vrev32q_u8(v);
+        else v = vrev64q_u8(v);
+        vst1q_u8(dst + i, v);
+    }
+    bswap_scalar<T>(src + i, dst + i, (bytes - i) / sizeof(T));
+}
+
+// vqtbl1q_u8 gathers and byte-swaps each value's big-endian word from a
+// 16-byte load; USHL takes per-lane shift counts, negative for right, so
+// one shift moves every value down into place before masking.
+void unpack_bits_neon(const uint8_t* src, unsigned width, size_t count, uint32_t* dst) noexcept {
+    const size_t nbytes = packed_size(width, count);
+    const size_t block_bytes = width;
+    unsigned off[8], shl[8];
+    for (unsigned j = 0; j < 8; ++j) {
+        off[j] = (j * width) >> 3;
+        shl[j] = (j * width) & 7;
+    }
+    uint8_t gather[4][16];
+    std::memset(gather, 0xff, sizeof(gather));  // out of range: zero the byte
+    size_t i = 0;
+    const uint8_t* p = src;
+
+    if (width <= 25) {
+        // Four 32-bit lanes per load: values 0-3 from p, 4-7 from p + off[4].
+        int32_t shift[2][4];
+        for (unsigned j = 0; j < 8; ++j) {
+            const unsigned h = j / 4, k = j % 4, r = off[j] - off[4 * h];
+            for (unsigned b = 0; b < 4; ++b) gather[h][4 * k + b] = static_cast<uint8_t>(r + 3 - b);
+            shift[h][k] = -static_cast<int32_t>(32 - width - shl[j]);
+        }
+        const uint8x16_t g0 = vld1q_u8(gather[0]), g1 = vld1q_u8(gather[1]);
+        const int32x4_t s0 = vld1q_s32(shift[0]), s1 = vld1q_s32(shift[1]);
+        const uint32x4_t mask = vdupq_n_u32(static_cast<uint32_t>((uint64_t{1} << width) - 1));
+        const size_t reach = size_t{off[4]} + 16;
+        for (; i + 8 <= count && static_cast<size_t>(p - src) + reach <= nbytes; i += 8, p += block_bytes) {
+            uint32x4_t lo = vreinterpretq_u32_u8(vqtbl1q_u8(vld1q_u8(p), g0));
+            uint32x4_t hi = vreinterpretq_u32_u8(vqtbl1q_u8(vld1q_u8(p + off[4]), g1));
+            vst1q_u32(dst + i, vandq_u32(vshlq_u32(lo, s0), mask));
+            vst1q_u32(dst + i + 4, vandq_u32(vshlq_u32(hi, s1), mask));
+        }
+    } else {
+        // Up to 39 bits: two 64-bit lanes per load, narrowed after shifting.
+        int64_t shift[4][2];
+        for (unsigned j = 0; j < 8; ++j) {
+            const unsigned q = j / 2, k = j % 2, r = off[j] - off[2 * q];
+            for (unsigned b = 0; b < 8; ++b) gather[q][8 * k + b] = static_cast<uint8_t>(r + 7 - b);
+            shift[q][k] = -static_cast<int64_t>(64 - width - shl[j]);
+        }
+        const uint64x2_t mask = vdupq_n_u64((uint64_t{1} << width) - 1);
+        const size_t reach = size_t{off[6]} + 16;
+        for (; i + 8 <= count && static_cast<size_t>(p - src) + reach <= nbytes; i += 8, p += block_bytes) {
+            uint32x2_t t[4];
+            for (unsigned q = 0; q < 4; ++q) {
+                uint64x2_t v = vreinterpretq_u64_u8(vqtbl1q_u8(vld1q_u8(p + off[2 * q]), vld1q_u8(gather[q])));
+                t[q] = vmovn_u64(vandq_u64(vshlq_u64(v, vld1q_s64(shift[q])), mask));
+            }
+            vst1q_u32(dst + i, vcombine_u32(t[0], t[1]));
+            vst1q_u32(dst + i + 4, vcombine_u32(t[2], t[3]));
+        }
+    }
+    unpack_bits_scalar(p, width, count - i, dst + i);
+}
+
+constexpr Kernels neon_kernels = {
+    bswap_neon<uint16_t>, bswap_neon<uint32_t>, bswap_neon<uint64_t>, unpack_bits_neon,
+};
+
+#endif  // BPW_SIMD_NEON
+
+// ---------------------------------------------------------------- dispatch
+
+const Kernels& kernels_for(Isa isa) noexcept {
+    switch (isa) {
+#if BPW_SIMD_X86
+    case Isa::avx2:  return avx2_kernels;
+    case Isa::ssse3: return ssse3_kernels;
+#endif
+#if BPW_SIMD_NEON
+    case Isa::neon:  return neon_kernels;
+#endif
+    default:         return scalar_kernels;
+    }
+}
+
+Isa detect() noexcept {
+#if BPW_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return Isa::avx2;
+    if (__builtin_cpu_supports("ssse3")) return Isa::ssse3;
+    return Isa::scalar;
+#elif BPW_SIMD_NEON
+    return Isa::neon;  // mandatory on AArch64
+#else
+    return Isa::scalar;
+#endif
+}
+
+struct Dispatch {
+    Isa detected = detect();
+    std::atomic<const Kernels*> active{&kernels_for(detected)};
+    std::atomic<Isa> active_isa{detected};
+};
+
+Dispatch& dispatch() noexcept {
+    static Dispatch d;
+    return d;
+}
+
+const Kernels& active() noexcept { return *dispatch().active.load(std::memory_order_relaxed); }
+
+// Whether kernels for `want` can run on a CPU detected as `have`.
+bool supported(Isa want, Isa have) noexcept {
+    if (want == Isa::scalar) return true;
+    if (want == Isa::neon) return have == Isa::neon;
+    if (have == Isa::avx2) return want == Isa::avx2 || want == Isa::ssse3;
+    return want == have;
+}
+
+}  // namespace
+
+const char* to_string(Isa isa) noexcept {
+    switch (isa) {
+    case Isa::scalar: return "scalar";
+    case Isa::ssse3:  return "ssse3";
+    case Isa::avx2:   return "avx2";
+    case Isa::neon:   return "neon";
+    }
+    return "unknown";
+}
+
+Isa detected_isa() noexcept { return dispatch().detected; }
+
+Isa active_isa() noexcept { return dispatch().active_isa.load(std::memory_order_relaxed); }
+
+void force_isa(Isa isa) noexcept {
+    Dispatch& d = dispatch();
+    if (!supported(isa, d.detected)) isa = d.detected;
+    d.active.store(&kernels_for(isa), std::memory_order_relaxed);
+    d.active_isa.store(isa, std::memory_order_relaxed);
+}
+
+void bswap16(const uint8_t* src, uint8_t* dst, size_t count) noexcept { active().bswap16(src, dst, count); }
+void bswap32(const uint8_t* src, uint8_t* dst, size_t count) noexcept { active().bswap32(src, dst, count); }
+void bswap64(const uint8_t* src, uint8_t* dst, size_t count) noexcept { active().bswap64(src, dst, count); }
+
+void unpack_bits(const uint8_t* src, unsigned width, size_t count, uint32_t* dst) noexcept {
+    active().unpack_bits(src, width, count, dst);
+}
+
+}  // namespace bpw::simd
@@ -0,0 +1,155 @@
+#include "bpw/thread_pool.hpp"
+
+#include <utility>
+
+#include "bpw/numa.hpp"
+
+namespace bpw {
+
+namespace {
+
+// Index of the pool worker running on this thread, if any.
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local unsigned tls_index = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(unsigned threads) { start(threads, Pinning::none); }
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& opts) { start(opts.threads, opts.pinning); }
+
+void ThreadPool::start(unsigned threads, Pinning pinning) {
+    NumaTopology topo;
+    if (pinning != Pinning::none && NumaTopology::detect(topo) != Status::ok) pinning = Pinning::none;
+
+    // Nodes that have CPUs we may use, and how many.
+    std::vector<unsigned> usable;
+    size_t cpus = 0;
+    if (pinning != Pinning::none) {
+        for (unsigned n = 0; n < topo.nodes(); ++n) {
+            if (topo.cpus(n).empty()) continue;
+            usable.push_back(n);
+            cpus += topo.cpus(n).size();
+        }
+        if (usable.empty()) pinning = Pinning::none;
+    }
+    if (threads == 0)
+        threads = pinning != Pinning::none ? static_cast<unsigned>(cpus) : std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    queues_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) queues_.push_back(std::make_unique<Queue>());
+
+    std::vector<unsigned> node_of(threads, 0);
+    if (pinning != Pinning::none) {
+        // Worker i takes CPU slot i * cpus / threads, counting the usable
+        // CPUs node by node, so workers fill the nodes in order and in
+        // proportion to their size.
+        worker_node_.resize(threads);
+        affinity_.resize(threads);
+        for (unsigned i = 0; i < threads; ++i) {
+            size_t slot = static_cast<size_t>(i) * cpus / threads;
+            unsigned k = 0;
+            while (slot >= topo.cpus(usable[k]).size()) slot -= topo.cpus(usable[k++]).size();
+            const unsigned node = usable[k];
+            node_of[i] = k;
+            worker_node_[i] = static_cast<int>(topo.node_id(node));
+            if (pinning == Pinning::cpu) affinity_[i].assign(1, topo.cpus(node)[slot]);
+            else affinity_[i].assign(topo.cpus(node).begin(), topo.cpus(node).end());
+        }
+        for (unsigned i = 1; i < threads; ++i) nodes_ += node_of[i] != node_of[i - 1];
+    }
+
+    // Steal from the same node first, nearest index first, then elsewhere;
+    // the thief's own deque comes last, as for callers outside the pool.
+    victims_.resize(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (unsigned k = 1; k < threads; ++k) {
+                unsigned v = (i + k) % threads;
+                if ((node_of[v] == node_of[i]) == (pass == 0)) victims_[i].push_back(v);
+            }
+        }
+        victims_[i].push_back(i);
+    }
+
+    threads_.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) threads_.emplace_back([this, i] { worker_loop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(sleep_m_);
+        stop_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& t : threads_) t.join();
+}
+
+int ThreadPool::current_worker() const noexcept { return tls_pool == this ? static_cast<int>(tls_index) : -1; }
+
+void ThreadPool::submit(Task task) {
+    push(tls_pool == this ? tls_index : next_.fetch_add(1, std::memory_order_relaxed) % size(), std::move(task));
+}
+
+void ThreadPool::submit_to(unsigned w, Task task) { push(w % size(), std::move(task)); }
+
+void ThreadPool::push(unsigned index, Task task) {
+    {
+        std::lock_guard<std::mutex> lk(queues_[index]->m);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    // Taking the lock orders this against a worker that is about to sleep.
+    { std::lock_guard<std::mutex> lk(sleep_m_); }
+    sleep_cv_.notify_one();
+}
+
+bool ThreadPool::pop(unsigned index, Task& out) {
+    Queue& q = *queues_[index];
+    std::lock_guard<std::mutex> lk(q.m);
+    if (q.tasks.empty()) return false;
+    out = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ThreadPool::steal(unsigned thief, Task& out) {
+    for (unsigned v : victims_[thief]) {
+        Queue& q = *queues_[v];
+        std::lock_guard<std::mutex> lk(q.m);
+        if (q.tasks.empty()) continue;
+        out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::run_one() {
+    Task task;
+    bool found = tls_pool == this ? pop(tls_index, task) || steal(tls_index, task) : steal(0, task);
+    if (!found) return false;
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+    tls_pool = this;
+    tls_index = index;
+    if (!affinity_.empty()) (void)pin_current_thread(affinity_[index]);
+    for (;;) {
+        Task task;
+        if (pop(index, task) || steal(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(sleep_m_);
+        sleep_cv_.wait(lk, [this] { return stop_ || queued_.load(std::memory_order_acquire) != 0; });
+        if (stop_ && queued_.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+}  // namespace bpw
@@ -0,0 +1,229 @@
+#include "bpw/uring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <utility>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BPW_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bpw {
+
+#if BPW_HAVE_IO_URING
+
+namespace {
+
+unsigned load_acquire(const unsigned* p) noexcept {
+    return std::atomic_ref<const unsigned>(*p).load(std::memory_order_acquire);
+}
+
+void store_release(unsigned* p, unsigned v) noexcept {
+    std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+int sys_setup(unsigned entries, io_uring_params* p) noexcept {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_enter(int fd, unsigned submit, unsigned min_complete, unsigned flags) noexcept {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+Status Uring::create(unsigned entries, Uring& out) {
+    out.close();
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+    int fd = sys_setup(entries, &p);
+    if (fd < 0) {
+        out.errno_ = errno;
+        return errno == ENOSYS || errno == EPERM ? Status::unsupported : Status::io_error;
+    }
+    out.fd_ = fd;
+
+    out.ring_.sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    out.ring_.cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+        if (out.ring_.cq_map_size > out.ring_.sq_map_size) out.ring_.sq_map_size = out.ring_.cq_map_size;
+        out.ring_.cq_map_size = 0;
+    }
+
+    void* sq = mmap(nullptr, out.ring_.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                    IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        out.errno_ = errno;
+        out.close();
+        return Status::io_error;
+    }
+    out.ring_.sq_map = sq;
+
+    void* cq = sq;
+    if (!single) {
+        cq = mmap(nullptr, out.ring_.cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                  IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED) {
+            out.errno_ = errno;
+            out.close();
+            return Status::io_error;
+        }
+        out.ring_.cq_map = cq;
+    }
+
+    out.ring_.sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, out.ring_.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                      IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        out.errno_ = errno;
+        out.close();
+        return Status::io_error;
+    }
+    out.ring_.sqes = sqes;
+
+    auto* sqb = static_cast<uint8_t*>(sq);
+    auto* cqb = static_cast<uint8_t*>(cq);
+    out.ring_.sq_head = reinterpret_cast<unsigned*>(sqb + p.sq_off.head);
+    out.ring_.sq_tail = reinterpret_cast<unsigned*>(sqb + p.sq_off.tail);
+    out.ring_.sq_array = reinterpret_cast<unsigned*>(sqb + p.sq_off.array);
+    out.ring_.sq_mask = *reinterpret_cast<unsigned*>(sqb + p.sq_off.ring_mask);
+    out.ring_.sq_entries = p.sq_entries;
+    out.ring_.cq_head = reinterpret_cast<unsigned*>(cqb + p.cq_off.head);
+    out.ring_.cq_tail = reinterpret_cast<unsigned*>(cqb + p.cq_off.tail);
+    out.ring_.cqes = cqb + p.cq_off.cqes;
+    out.ring_.cq_mask = *reinterpret_cast<unsigned*>(cqb + p.cq_off.ring_mask);
+    return Status::ok;
+}
+
+Status Uring::queue_writev(int fd, std::span<const iovec> iov, uint64_t offset, uint64_t user_data) noexcept {
+#ifdef IOV_MAX
+    constexpr size_t max_iov = IOV_MAX;
+#else
+    constexpr size_t max_iov = 1024;
+#endif
+    if (fd_ < 0) return Status::invalid_argument;
+    // The kernel fails a writev of more than IOV_MAX entries, so long
+    // arrays take one linked SQE per IOV_MAX entries; all or none are queued.
+    const size_t count = iov.empty() ? 1 : (iov.size() + max_iov - 1) / max_iov;
+    unsigned tail = *ring_.sq_tail;
+    if (count > ring_.sq_entries - (tail - load_acquire(ring_.sq_head))) return Status::out_of_bounds;
+    for (size_t k = 0; k < count; ++k) {
+        std::span<const iovec> part = iov.subspan(k * max_iov, std::min(max_iov, iov.size() - k * max_iov));
+        unsigned idx = tail & ring_.sq_mask;
+        auto* sqe = static_cast<io_uring_sqe*>(ring_.sqes) + idx;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = fd;
+        sqe->off = offset;
+        sqe->addr = reinterpret_cast<uint64_t>(part.data());
+        sqe->len = static_cast<uint32_t>(part.size());
+        sqe->user_data = user_data;
+        // Keep the parts in order, which matters at current_position.
+        if (k + 1 < count) sqe->flags = IOSQE_IO_LINK;
+        ring_.sq_array[idx] = idx;
+        ++tail;
+        if (offset != current_position)
+            for (const iovec& v : part) offset += v.iov_len;
+    }
+    store_release(ring_.sq_tail, tail);
+    pending_ += static_cast<unsigned>(count);
+    return Status::ok;
+}
+
+Status Uring::submit() noexcept {
+    while (pending_) {
+        int n = sys_enter(fd_, pending_, 0, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            errno_ = errno;
+            return Status::io_error;
+        }
+        pending_ -= static_cast<unsigned>(n) < pending_ ? static_cast<unsigned>(n) : pending_;
+    }
+    return Status::ok;
+}
+
+bool Uring::poll(Completion& out) noexcept {
+    if (fd_ < 0) return false;
+    unsigned head = *ring_.cq_head;
+    if (head == load_acquire(ring_.cq_tail)) return false;
+    const auto* cqe = static_cast<const io_uring_cqe*>(ring_.cqes) + (head & ring_.cq_mask);
+    out.user_data = cqe->user_data;
+    out.result = cqe->res;
+    store_release(ring_.cq_head, head + 1);
+    return true;
+}
+
+Status Uring::wait(Completion& out) noexcept {
+    if (fd_ < 0) return Status::invalid_argument;
+    while (!poll(out)) {
+        int n = sys_enter(fd_, pending_, 1, IORING_ENTER_GETEVENTS);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            errno_ = errno;
+            return Status::io_error;
+        }
+        pending_ -= static_cast<unsigned>(n) < pending_ ? static_cast<unsigned>(n) : pending_;
+    }
+    return Status::ok;
+}
+
+void Uring::close() noexcept {
+    if (ring_.sqes) munmap(ring_.sqes, ring_.sqes_size);
+    if (ring_.cq_map) munmap(ring_.cq_map, ring_.cq_map_size);
+    if (ring_.sq_map) munmap(ring_.sq_map, ring_.sq_map_size);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    pending_ = 0;
+    ring_ = Ring{};
+}
+
+#else  // !BPW_HAVE_IO_URING
+
+Status Uring::create(unsigned, Uring& out) {
+    out.close();
+    return Status::unsupported;
+}
+
+Status Uring::queue_writev(int, std::span<const iovec>, uint64_t, uint64_t) noexcept {
+    return Status::unsupported;
+}
+
+Status Uring::submit() noexcept { return Status::unsupported; }
+
+bool Uring::poll(Completion&) noexcept { return false; }
+
+Status Uring::wait(Completion&) noexcept { return Status::unsupported; }
+
+void Uring::close() noexcept {}
+
+#endif  // BPW_HAVE_IO_URING
+
+Uring::Uring(Uring&& o) noexcept
+    : fd_(std::exchange(o.fd_, -1)),
+      errno_(std::exchange(o.errno_, 0)),
+      pending_(std::exchange(o.pending_, 0)),
+      ring_(std::exchange(o.ring_, Ring{})) {}
+
+Uring& Uring::operator=(Uring&& o) noexcept {
+    if (this != &o) {
+        close();
+        fd_ = std::exchange(o.fd_, -1);
+        errno_ = std::exchange(o.errno_, 0);
+        pending_ = std::exchange(o.pending_, 0);
+        ring_ = std::exchange(o.ring_, Ring{});
+    }
+    return *this;
+}
+
+Uring::~Uring() { close(); }
+
+}  // namespace bpw
@@ -0,0 +1,275 @@
+#include "bpw/varint.hpp"
+
+#include <cstring>
+
+#include "bpw/simd.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BPW_VARINT_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define BPW_VARINT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace bpw {
+
+namespace {
+
+// ---------------------------------------------------------------- LEB128
+
+template <class T>
+Status decode_one(const uint8_t*& p, const uint8_t* end, T& out) noexcept {
+    uint64_t v;
+    if (Status s = decode_varint(p, end, v); s != Status::ok) return s;
+    if constexpr (sizeof(T) < 8) {
+        if (v > static_cast<uint64_t>(T(~T{0}))) return Status::malformed;
+    }
+    out = static_cast<T>(v);
+    return Status::ok;
+}
+
+template <class T>
+Status read_varints_scalar(const uint8_t*& p, const uint8_t* end, T* out, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        if (Status s = decode_one(p, end, out[i]); s != Status::ok) return s;
+    }
+    return Status::ok;
+}
+
+#if BPW_VARINT_X86
+
+// Runs of values below 128 are copied 16 at a time. Otherwise the bytes
+// before the first continuation bit are single-byte values as well, and
+// only the value containing that bit goes through decode_varint(). Runs of
+// multi-byte values switch to the scalar decoder for a fixed number of
+// values, which predicts better than re-testing every window.
+template <class T>
+__attribute__((target("sse2"))) Status read_varints_sse2(const uint8_t*& p, const uint8_t* end, T* out,
+                                                         size_t count) noexcept {
+    constexpr unsigned scalar_run = 8;
+    size_t i = 0;
+    while (count - i >= 16 && end - p >= 16) {
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+        if (mask == 0) {
+            for (unsigned j = 0; j < 16; ++j) out[i + j] = p[j];
+            p += 16;
+            i += 16;
+            continue;
+        }
+        unsigned k = static_cast<unsigned>(__builtin_ctz(mask));
+        for (unsigned j = 0; j < k; ++j) out[i + j] = p[j];
+        p += k;
+        i += k;
+        if (Status s = decode_one(p, end, out[i]); s != Status::ok) return s;
+        ++i;
+        // Two multi-byte values in a row: the input is not dominated by
+        // small values, so stay scalar for a while.
+        if (k == 0 && p < end && (*p & 0x80) && count - i >= scalar_run) {
+            if (Status s = read_varints_scalar(p, end, out + i, scalar_run); s != Status::ok) return s;
+            i += scalar_run;
+        }
+    }
+    return read_varints_scalar(p, end, out + i, count - i);
+}
+
+#endif  // BPW_VARINT_X86
+
+#if BPW_VARINT_NEON
+
+template <class T>
+Status read_varints_neon(const uint8_t*& p, const uint8_t* end, T* out, size_t count) noexcept {
+    size_t i = 0;
+    while (count - i >= 16 && end - p >= 16) {
+        if (vmaxvq_u8(vld1q_u8(p)) < 0x80) {
+            for (unsigned j = 0; j < 16; ++j) out[i + j] = p[j];
+            p += 16;
+            i += 16;
+            continue;
+        }
+        if (Status s = decode_one(p, end, out[i]); s != Status::ok) return s;
+        ++i;
+    }
+    return read_varints_scalar(p, end, out + i, count - i);
+}
+
+#endif  // BPW_VARINT_NEON
+
+template <class T>
+Status read_varints_impl(Reader& in, T* out, size_t count) noexcept {
+    const uint8_t* p = in.data();
+    Status s;
+    switch (simd::active_isa()) {
+#if BPW_VARINT_X86
+    case simd::Isa::ssse3:
+    case simd::Isa::avx2: s = read_varints_sse2(p, in.end(), out, count); break;
+#endif
+#if BPW_VARINT_NEON
+    case simd::Isa::neon: s = read_varints_neon(p, in.end(), out, count); break;
+#endif
+    default: s = read_varints_scalar(p, in.end(), out, count); break;
+    }
+    if (s != Status::ok) return s == Status::out_of_bounds ? in.bounds_error() : s;
+    return in.skip(static_cast<size_t>(p - in.data()));
+}
+
+template <class T>
+Status write_varints_impl(Writer& out, const T* src, size_t count) noexcept {
+    constexpr size_t batch = 256;
+    constexpr size_t max_len = (sizeof(T) * 8 + 6) / 7;
+    while (count) {
+        size_t n = count < batch ? count : batch;
+        // encode_varint() may store a full 8-byte word for short values.
+        uint8_t* p = out.prepare(n * max_len + 8);
+        if (!p) {
+            for (size_t i = 0; i < n; ++i)
+                if (Status s = write_varint(out, src[i]); s != Status::ok) return s;
+        } else {
+            size_t used = 0;
+            for (size_t i = 0; i < n; ++i) used += encode_varint(p + used, src[i]);
+            out.commit(used);
+        }
+        src += n;
+        count -= n;
+    }
+    return Status::ok;
+}
+
+// ---------------------------------------------------------------- Stream VByte
+
+struct SvbTables {
+    uint8_t len[256];         // data bytes used by a control byte
+    uint8_t shuf[256][16];    // pshufb mask expanding them to four u32
+};
+
+constexpr SvbTables make_svb_tables() {
+    SvbTables t{};
+    for (unsigned c = 0; c < 256; ++c) {
+        unsigned off = 0;
+        for (unsigned k = 0; k < 4; ++k) {
+            unsigned l = ((c >> (2 * k)) & 3) + 1;
+            for (unsigned b = 0; b < 4; ++b)
+                t.shuf[c][4 * k + b] = b < l ? static_cast<uint8_t>(off + b) : 0x80;
+            off += l;
+        }
+        t.len[c] = static_cast<uint8_t>(off);
+    }
+    return t;
+}
+
+alignas(16) constexpr SvbTables svb = make_svb_tables();
+
+inline unsigned svb_code(uint32_t v) noexcept {
+    return (v > 0xff) + (v > 0xffff) + (v > 0xffffff);
+}
+
+inline uint32_t svb_load(const uint8_t* p, unsigned len) noexcept {
+    uint32_t v = 0;
+    for (unsigned b = 0; b < len; ++b) v |= static_cast<uint32_t>(p[b]) << (8 * b);
+    return v;
+}
+
+// Decode `count` values; groups are whole except possibly the last.
+void svb_decode_scalar(const uint8_t* ctrl, const uint8_t* data, uint32_t* out, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        unsigned len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        out[i] = svb_load(data, len);
+        data += len;
+    }
+}
+
+#if BPW_VARINT_X86
+
+__attribute__((target("ssse3"))) void svb_decode_ssse3(const uint8_t* ctrl, const uint8_t* data,
+                                                        const uint8_t* data_end, uint32_t* out,
+                                                        size_t count) noexcept {
+    size_t g = 0;
+    const size_t groups = count / 4;
+    // Each step reads 16 data bytes, so stop while that stays in bounds.
+    for (; g < groups && data_end - data >= 16; ++g) {
+        uint8_t c = ctrl[g];
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(svb.shuf[c]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * g), _mm_shuffle_epi8(v, m));
+        data += svb.len[c];
+    }
+    svb_decode_scalar(ctrl + g, data, out + 4 * g, count - 4 * g);
+}
+
+#endif  // BPW_VARINT_X86
+
+#if BPW_VARINT_NEON
+
+void svb_decode_neon(const uint8_t* ctrl, const uint8_t* data, const uint8_t* data_end, uint32_t* out,
+                     size_t count) noexcept {
+    size_t g = 0;
+    const size_t groups = count / 4;
+    for (; g < groups && data_end - data >= 16; ++g) {
+        uint8_t c = ctrl[g];
+        uint8x16_t v = vqtbl1q_u8(vld1q_u8(data), vld1q_u8(svb.shuf[c]));
+        vst1q_u32(out + 4 * g, vreinterpretq_u32_u8(v));
+        data += svb.len[c];
+    }
+    svb_decode_scalar(ctrl + g, data, out + 4 * g, count - 4 * g);
+}
+
+#endif  // BPW_VARINT_NEON
+
+}  // namespace
+
+Status read_varints(Reader& in, uint32_t* out, size_t count) noexcept { return read_varints_impl(in, out, count); }
+Status read_varints(Reader& in, uint64_t* out, size_t count) noexcept { return read_varints_impl(in, out, count); }
+
+Status write_varints(Writer& out, const uint32_t* src, size_t count) noexcept {
+    return write_varints_impl(out, src, count);
+}
+Status write_varints(Writer& out, const uint64_t* src, size_t count) noexcept {
+    return write_varints_impl(out, src, count);
+}
+
+Status write_streamvbyte(Writer& out, const uint32_t* src, size_t count) noexcept {
+    if (count > (SIZE_MAX - 8) / 5) return Status::invalid_argument;
+    const size_t nctrl = (count + 3) / 4;
+    // 4 spare bytes: every value is stored as a full 32-bit word.
+    uint8_t* p = out.prepare(streamvbyte_max_size(count) + 4);
+    if (!p) return out.failure();
+    uint8_t* ctrl = p;
+    uint8_t* data = p + nctrl;
+    std::memset(ctrl, 0, nctrl);
+    for (size_t i = 0; i < count; ++i) {
+        unsigned code = svb_code(src[i]);
+        ctrl[i / 4] |= static_cast<uint8_t>(code << (2 * (i % 4)));
+        store_le<uint32_t>(data, src[i]);
+        data += code + 1;
+    }
+    out.commit(static_cast<size_t>(data - p));
+    return Status::ok;
+}
+
+Status read_streamvbyte(Reader& in, uint32_t* out, size_t count) noexcept {
+    const size_t nctrl = (count + 3) / 4;
+    if (!in.has(nctrl)) return in.bounds_error();
+    const uint8_t* ctrl = in.data();
+
+    // Size the data section before touching it.
+    size_t data_len = 0;
+    for (size_t g = 0; g < count / 4; ++g) data_len += svb.len[ctrl[g]];
+    for (size_t i = count & ~size_t{3}; i < count; ++i) data_len += ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+    if (in.remaining() - nctrl < data_len) return in.bounds_error();
+
+    const uint8_t* data = ctrl + nctrl;
+    switch (simd::active_isa()) {
+#if BPW_VARINT_X86
+    case simd::Isa::ssse3:
+    case simd::Isa::avx2: svb_decode_ssse3(ctrl, data, data + data_len, out, count); break;
+#endif
+#if BPW_VARINT_NEON
+    case simd::Isa::neon: svb_decode_neon(ctrl, data, data + data_len, out, count); break;
+#endif
+    default: svb_decode_scalar(ctrl, data, out, count); break;
+    }
+    return in.skip(nctrl + data_len);
+}
+
+}  // namespace bpw
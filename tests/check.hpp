@@ -0,0 +1,46 @@
+// Minimal checks for the behaviour tests.
+//
+// Each test is a plain executable: main() runs its cases and returns
+// report(), which is non-zero if any CHECK failed. A failed CHECK prints
+// its location and keeps going, so one run shows every broken case.
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+#include "bpw/status.hpp"
+
+namespace bpw::test {
+
+inline int failures = 0;
+
+inline void fail(const char* file, int line, const char* what) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    ++failures;
+}
+
+inline int report(const char* name) {
+    if (failures) std::fprintf(stderr, "%s: %d check(s) failed\n", name, failures);
+    else std::printf("%s: ok\n", name);
+    return failures ? 1 : 0;
+}
+
+// Fresh directory under $TMPDIR (or /tmp) for tests that touch files.
+inline std::string temp_dir() {
+    const char* base = std::getenv("TMPDIR");
+    std::string dir = std::string(base && *base ? base : "/tmp") + "/bpw_test.XXXXXX";
+    if (!::mkdtemp(dir.data())) {
+        std::perror("mkdtemp");
+        std::exit(2);
+    }
+    return dir;
+}
+
+}  // namespace bpw::test
+
+#define CHECK(cond) ((cond) ? (void)0 : ::bpw::test::fail(__FILE__, __LINE__, #cond))
+#define CHECK_STATUS(expr, want) CHECK((expr) == ::bpw::Status::want)
+#define CHECK_OK(expr) CHECK_STATUS(expr, ok)
@@ -0,0 +1,201 @@
+// Known vectors for varints, Stream VByte, delta columns and CRC32C, and
+// every SIMD kernel cross-checked against the scalar one via force_isa().
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "bpw/bit_reader.hpp"
+#include "bpw/bulk.hpp"
+#include "bpw/crc32c.hpp"
+#include "bpw/delta.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/simd.hpp"
+#include "bpw/varint.hpp"
+#include "bpw/writer.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+using Bytes = std::vector<uint8_t>;
+
+Bytes bytes_of(const Writer& w) { return {w.data(), w.data() + w.size()}; }
+
+void varint_vectors() {
+    const std::pair<uint64_t, Bytes> cases[] = {
+        {0, {0x00}},
+        {1, {0x01}},
+        {127, {0x7F}},
+        {128, {0x80, 0x01}},
+        {300, {0xAC, 0x02}},
+        {16384, {0x80, 0x80, 0x01}},
+        {UINT64_MAX, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01}},
+    };
+    for (const auto& [value, encoded] : cases) {
+        Writer out;
+        CHECK_OK(write_varint(out, value));
+        CHECK(bytes_of(out) == encoded);
+        CHECK(varint_size(value) == encoded.size());
+        Reader in(encoded.data(), encoded.size());
+        uint64_t back = 0;
+        CHECK_OK(read_varint(in, back));
+        CHECK(back == value && in.empty());
+    }
+
+    CHECK(zigzag_encode(0) == 0 && zigzag_encode(-1) == 1 && zigzag_encode(1) == 2);
+    CHECK(zigzag_encode(INT64_MIN) == UINT64_MAX && zigzag_decode(UINT64_MAX) == INT64_MIN);
+    Writer s;
+    CHECK_OK(write_svarint(s, -65));
+    CHECK((bytes_of(s) == Bytes{0x81, 0x01}));
+
+    // Truncated, overlong and out-of-range encodings.
+    const Bytes truncated = {0x80, 0x80};
+    const Bytes overlong = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02};
+    const Bytes too_big_u32 = {0x80, 0x80, 0x80, 0x80, 0x10};
+    uint64_t v64;
+    uint32_t v32;
+    Reader t(truncated.data(), truncated.size());
+    CHECK(read_varint(t, v64) != Status::ok && t.position() == 0);
+    Reader o(overlong.data(), overlong.size());
+    CHECK_STATUS(read_varint(o, v64), malformed);
+    Reader b(too_big_u32.data(), too_big_u32.size());
+    CHECK_STATUS(read_varint(b, v32), malformed);
+}
+
+void streamvbyte_vectors() {
+    const uint32_t values[] = {1, 256, 65536, 16777216, 7};
+    Writer out;
+    CHECK_OK(write_streamvbyte(out, values, 5));
+    // Two control bytes (lengths 1, 2, 3, 4 then 1), then the values.
+    const Bytes want = {0xE4, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x07};
+    CHECK(bytes_of(out) == want);
+    CHECK(out.size() <= streamvbyte_max_size(5));
+
+    uint32_t back[5] = {};
+    Reader in(out.data(), out.size());
+    CHECK_OK(read_streamvbyte(in, back, 5));
+    CHECK(std::memcmp(back, values, sizeof(values)) == 0 && in.empty());
+    Reader cut(out.data(), out.size() - 1);
+    CHECK(read_streamvbyte(cut, back, 5) != Status::ok);
+}
+
+void delta_vectors() {
+    // A constant stride packs to width-0 blocks: first value, then the
+    // reference delta (svarint 1) and width 0.
+    const uint64_t seq[] = {5, 6, 7};
+    Writer out;
+    CHECK_OK(write_delta(out, seq, 3));
+    CHECK((bytes_of(out) == Bytes{0x05, 0x02, 0x00}));
+
+    std::mt19937_64 rng(3);
+    for (size_t count : {size_t{0}, size_t{1}, size_t{127}, size_t{128}, size_t{129}, size_t{1000}}) {
+        std::vector<uint64_t> values(count);
+        uint64_t t = 1'700'000'000'000;
+        for (auto& v : values) v = t += 1000 + rng() % 17;
+        if (count > 500) values[500] = 3;  // one wild jump, modulo 2^64
+        Writer w;
+        CHECK_OK(write_delta(w, values.data(), count));
+        CHECK(w.size() <= delta_max_size(count));
+        std::vector<uint64_t> back(count);
+        Reader in(w.data(), w.size());
+        CHECK_OK(read_delta(in, back.data(), count));
+        CHECK(back == values && in.empty());
+        if (w.size() > 1) {
+            Reader cut(w.data(), w.size() - 1);
+            CHECK(read_delta(cut, back.data(), count) != Status::ok);
+        }
+    }
+}
+
+void crc32c_vectors() {
+    // RFC 3720 (iSCSI) test vectors plus the classic check value.
+    uint8_t zeros[32] = {}, ones[32], inc[32];
+    std::memset(ones, 0xFF, sizeof(ones));
+    for (int i = 0; i < 32; ++i) inc[i] = static_cast<uint8_t>(i);
+    CHECK(crc32c(zeros, 32) == 0x8A9136AA);
+    CHECK(crc32c(ones, 32) == 0x62A8AB43);
+    CHECK(crc32c(inc, 32) == 0x46DD794E);
+    CHECK(crc32c("123456789", 9) == 0xE3069283);
+    CHECK(crc32c(nullptr, 0) == 0);
+
+    // Chaining matches one pass, at every split and across the lengths
+    // where the implementation switches strategy.
+    std::vector<uint8_t> big(20000);
+    std::mt19937 rng(11);
+    for (auto& b : big) b = static_cast<uint8_t>(rng());
+    const uint32_t whole = crc32c(big.data(), big.size());
+    bool chained = true;
+    for (size_t split : {size_t{0}, size_t{1}, size_t{7}, size_t{64}, size_t{4097}, size_t{19999}})
+        chained &= crc32c(big.data() + split, big.size() - split, crc32c(big.data(), split)) == whole;
+    CHECK(chained);
+}
+
+// Every kernel on every ISA this CPU runs, against the scalar kernel.
+void simd_cross_check() {
+    using simd::Isa;
+    std::mt19937_64 rng(5);
+    std::vector<uint8_t> raw(4099);
+    for (auto& b : raw) b = static_cast<uint8_t>(rng());
+
+    std::vector<uint32_t> small(1001);
+    for (size_t i = 0; i < small.size(); ++i) small[i] = static_cast<uint32_t>(rng() >> (rng() % 64));
+    Writer lebs, svb;
+    CHECK_OK(write_varints(lebs, small.data(), small.size()));
+    CHECK_OK(write_streamvbyte(svb, small.data(), small.size()));
+
+    for (Isa isa : {Isa::scalar, Isa::ssse3, Isa::avx2, Isa::neon}) {
+        simd::force_isa(isa);
+        if (simd::active_isa() != isa) continue;  // not on this CPU
+
+        for (size_t n : {size_t{0}, size_t{1}, size_t{15}, size_t{16}, size_t{33}, size_t{512}}) {
+            std::vector<uint8_t> got(8 * n), want(8 * n);
+            simd::bswap16(raw.data(), got.data(), n);
+            for (size_t i = 0; i < n; ++i) want[2 * i] = raw[2 * i + 1], want[2 * i + 1] = raw[2 * i];
+            CHECK(std::equal(want.begin(), want.begin() + 2 * n, got.begin()));
+            simd::bswap32(raw.data(), got.data(), n);
+            for (size_t i = 0; i < 4 * n; ++i) want[i] = raw[(i & ~size_t{3}) + 3 - (i & 3)];
+            CHECK(std::equal(want.begin(), want.begin() + 4 * n, got.begin()));
+            simd::bswap64(raw.data(), got.data(), n);
+            for (size_t i = 0; i < 8 * n; ++i) want[i] = raw[(i & ~size_t{7}) + 7 - (i & 7)];
+            CHECK(got == want);
+        }
+
+        bool unpack_same = true;
+        for (unsigned width = 1; width <= 32; ++width) {
+            for (size_t n : {size_t{0}, size_t{7}, size_t{8}, size_t{9}, size_t{31}, size_t{100}, size_t{1000}}) {
+                std::vector<uint32_t> got(n), want(n);
+                Reader in(raw.data(), simd::packed_size(width, n));
+                simd::unpack_bits(raw.data(), width, n, got.data());
+                BitReader br(in);
+                for (auto& v : want) v = br.read_bits(width);
+                unpack_same &= got == want;
+                std::vector<uint32_t> packed(n);
+                unpack_same &= read_packed(in, width, n, packed.data()) == Status::ok && packed == want;
+            }
+        }
+        CHECK(unpack_same);
+
+        std::vector<uint32_t> back(small.size());
+        Reader li(lebs.data(), lebs.size());
+        CHECK_OK(read_varints(li, back.data(), back.size()));
+        CHECK(back == small && li.empty());
+        Reader si(svb.data(), svb.size());
+        CHECK_OK(read_streamvbyte(si, back.data(), back.size()));
+        CHECK(back == small && si.empty());
+    }
+    simd::force_isa(simd::detected_isa());
+}
+
+}  // namespace
+
+int main() {
+    varint_vectors();
+    streamvbyte_vectors();
+    delta_vectors();
+    crc32c_vectors();
+    simd_cross_check();
+    return bpw::test::report("codec_test");
+}
@@ -0,0 +1,230 @@
+// CompressedWriter -> CompressedReader round trips for every codec that
+// was compiled in, the stored fallback for incompressible blocks, and
+// corrupt streams.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bpw/compression.hpp"
+#include "bpw/file_source.hpp"
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+constexpr Framing framing = Framing::length_prefixed(4, 0, 4, Endian::little, size_t{1} << 20);
+
+std::string dir;
+
+// Length-prefixed records; `random` payloads do not compress.
+Status write_stream(const std::string& path, const CompressionOptions& opts, bool random, size_t records,
+                    std::vector<uint8_t>& raw) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return Status::io_error;
+    std::mt19937 rng(9);
+    Status s = Status::ok;
+    {
+        CompressedWriter w(fd, opts);
+        for (size_t i = 0; i < records && s == Status::ok; ++i) {
+            const uint32_t n = static_cast<uint32_t>(rng() % 300);
+            const size_t start = w.block().size();
+            s = w.block().write_le(n);
+            for (uint32_t j = 0; j < n && s == Status::ok; ++j)
+                s = w.block().write_u8(static_cast<uint8_t>(random ? rng() : i));
+            if (s == Status::ok) raw.insert(raw.end(), w.block().data() + start, w.block().data() + w.block().size());
+            if (s == Status::ok) s = w.end_record();
+        }
+        if (s == Status::ok) s = w.finish();
+    }
+    ::close(fd);
+    return s;
+}
+
+// Concatenated blocks, checking that each one holds whole records.
+Status read_stream(FileSource& src, const CompressionOptions& opts, std::vector<uint8_t>& raw,
+                   bool& whole_records) {
+    CompressedReader r(src, opts);
+    whole_records = true;
+    for (;;) {
+        std::span<const uint8_t> block;
+        if (Status s = r.next_block(block); s != Status::ok) return s;
+        if (block.empty()) return Status::ok;
+        Reader in(block);
+        Reader rec;
+        while (!in.empty()) {
+            if (framing.next(in, rec) != Status::ok) {
+                whole_records = false;
+                break;
+            }
+        }
+        raw.insert(raw.end(), block.begin(), block.end());
+    }
+}
+
+Status read_file(const std::string& path, const CompressionOptions& opts, std::vector<uint8_t>& raw) {
+    FileSource src;
+    if (Status s = FileSource::open(path.c_str(), src); s != Status::ok) return s;
+    bool whole = false;
+    Status s = read_stream(src, opts, raw, whole);
+    return s == Status::ok && !whole ? Status::malformed : s;
+}
+
+std::vector<Codec> block_codecs(const std::string& path) {
+    std::vector<Codec> out;
+    FileSource src;
+    Reader in;
+    if (FileSource::open(path.c_str(), src) != Status::ok || src.reader(in) != Status::ok) return out;
+    BlockHeader h;
+    while (in.has(BlockHeader::size) && BlockHeader::decode(in.data(), h) == Status::ok) {
+        out.push_back(h.codec);
+        if (in.skip(BlockHeader::size + h.stored_size) != Status::ok) break;
+    }
+    return out;
+}
+
+void round_trips() {
+    for (Codec codec : {Codec::none, Codec::lz4, Codec::zstd}) {
+        CompressionOptions opts;
+        opts.codec = codec;
+        opts.block_size = 4096;
+        const std::string path = dir + "/round_trip.bpwz";
+        std::vector<uint8_t> raw;
+        if (!codec_available(codec)) {
+            CHECK_STATUS(write_stream(path, opts, false, 10, raw), unsupported);
+            continue;
+        }
+        for (bool background : {false, true}) {
+            opts.background = background;
+            raw.clear();
+            CHECK_OK(write_stream(path, opts, false, 2000, raw));
+            std::vector<uint8_t> back;
+            CHECK_OK(read_file(path, opts, back));
+            CHECK(back == raw);
+            CHECK(block_codecs(path).size() > 10);
+        }
+    }
+
+    // An empty stream has no blocks.
+    CompressionOptions opts;
+    opts.codec = Codec::none;
+    const std::string path = dir + "/empty.bpwz";
+    std::vector<uint8_t> raw, back;
+    CHECK_OK(write_stream(path, opts, false, 0, raw));
+    FileSource src;
+    CHECK_OK(FileSource::open(path.c_str(), src, FileSource::Options{}));
+    bool whole;
+    CHECK_OK(read_stream(src, opts, back, whole));
+    CHECK(back.empty());
+}
+
+void stored_fallback() {
+    for (Codec codec : {Codec::lz4, Codec::zstd}) {
+        if (!codec_available(codec)) continue;
+        CompressionOptions opts;
+        opts.codec = codec;
+        opts.block_size = 4096;
+        const std::string path = dir + "/random.bpwz";
+        std::vector<uint8_t> raw, back;
+        CHECK_OK(write_stream(path, opts, true, 500, raw));
+        const std::vector<Codec> codecs = block_codecs(path);
+        bool all_stored = !codecs.empty();
+        for (Codec c : codecs) all_stored &= c == Codec::none;
+        CHECK(all_stored);
+        CHECK_OK(read_file(path, opts, back));
+        CHECK(back == raw);
+    }
+
+    // compress_block() itself, for Codec::none.
+    const uint8_t data[] = {1, 2, 3, 4, 5};
+    uint8_t stored[16], restored[5];
+    size_t n = 0;
+    CHECK(compress_bound(Codec::none, 5) >= 5);
+    CHECK_OK(compress_block(Codec::none, 0, data, stored, sizeof(stored), n));
+    CHECK(n == 5);
+    CHECK_OK(decompress_block(Codec::none, {stored, n}, restored, 5));
+    CHECK(std::equal(data, data + 5, restored));
+    CHECK_STATUS(decompress_block(Codec::none, {stored, n}, restored, 4), malformed);
+}
+
+// Feed `bytes` through a pipe, so the reader cannot map the input.
+Status read_pipe(const std::vector<uint8_t>& bytes, const CompressionOptions& opts) {
+    int p[2];
+    if (::pipe(p) != 0) return Status::io_error;
+    // Small inputs fit in the pipe buffer, so nothing blocks.
+    const bool written = ::write(p[1], bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size());
+    ::close(p[1]);
+    FileSource src;
+    FileSource::Options fo;
+    fo.chunk_size = 64;
+    if (!written || FileSource::adopt(p[0], src, fo) != Status::ok) {
+        ::close(p[0]);
+        return Status::io_error;
+    }
+    std::vector<uint8_t> raw;
+    bool whole;
+    return read_stream(src, opts, raw, whole);
+}
+
+void corrupt_streams() {
+    CompressionOptions opts;
+    opts.codec = Codec::none;
+    opts.block_size = 512;
+    opts.background = false;
+    const std::string path = dir + "/corrupt.bpwz";
+    std::vector<uint8_t> raw;
+    CHECK_OK(write_stream(path, opts, false, 20, raw));
+
+    std::vector<uint8_t> file;
+    {
+        FileSource src;
+        Reader in;
+        CHECK_OK(FileSource::open(path.c_str(), src));
+        CHECK_OK(src.reader(in));
+        file.assign(in.data(), in.data() + in.remaining());
+    }
+    CHECK_OK(read_pipe(file, opts));
+
+    // Flipped payload byte: the checksum catches it.
+    std::vector<uint8_t> bad = file;
+    bad[BlockHeader::size + 3] ^= 0x40;
+    CHECK_STATUS(read_pipe(bad, opts), malformed);
+
+    // A stored size that no valid block can have is rejected before the
+    // payload is read.
+    bad = file;
+    BlockHeader h;
+    CHECK_OK(BlockHeader::decode(bad.data(), h));
+    h.stored_size = 0xFFFFFF00;
+    h.encode(bad.data());
+    CHECK_STATUS(read_pipe(bad, opts), malformed);
+
+    // Bad magic, and a stream cut inside a block.
+    bad = file;
+    bad[0] ^= 1;
+    CHECK_STATUS(read_pipe(bad, opts), malformed);
+    bad.assign(file.begin(), file.end() - 5);
+    CHECK_STATUS(read_pipe(bad, opts), out_of_bounds);
+}
+
+}  // namespace
+
+int main() {
+    dir = bpw::test::temp_dir();
+    round_trips();
+    stored_fallback();
+    corrupt_streams();
+    for (const char* f : {"round_trip.bpwz", "empty.bpwz", "random.bpwz", "corrupt.bpwz"})
+        std::remove((dir + "/" + f).c_str());
+    ::rmdir(dir.c_str());
+    return bpw::test::report("compression_test");
+}
@@ -0,0 +1,185 @@
+// Compile-time and runtime layouts: known encodings, round trips, and
+// RuntimeLayout programs surviving save() / load().
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "bpw/layout.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/runtime_layout.hpp"
+#include "bpw/writer.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+struct Header {
+    uint16_t type = 0;
+    uint32_t length = 0;
+    int8_t flags = 0;
+    int32_t delta = 0;
+    double scale = 0;
+    uint8_t tag[3] = {};
+};
+
+bool operator==(const Header& a, const Header& b) {
+    return a.type == b.type && a.length == b.length && a.flags == b.flags && a.delta == b.delta &&
+           std::memcmp(&a.scale, &b.scale, sizeof(double)) == 0 && std::memcmp(a.tag, b.tag, 3) == 0;
+}
+
+// Byte 6 is a gap, written as zero.
+using HeaderLayout = Layout<Header,
+    Field<&Header::type, 0, 2, Endian::big>,
+    Field<&Header::length, 2, 3, Endian::big>,
+    Field<&Header::flags, 5, 1, Endian::big>,
+    Field<&Header::delta, 7, 3, Endian::little>,
+    Field<&Header::scale, 10, 8, Endian::little>,
+    Field<&Header::tag, 18, 3, Endian::little>>;
+
+const std::vector<RuntimeField> header_fields = {
+    {FieldKind::unsigned_int, 0, 2, Endian::big, offsetof(Header, type), 2},
+    {FieldKind::unsigned_int, 2, 3, Endian::big, offsetof(Header, length), 4},
+    {FieldKind::signed_int, 5, 1, Endian::big, offsetof(Header, flags), 1},
+    {FieldKind::signed_int, 7, 3, Endian::little, offsetof(Header, delta), 4},
+    {FieldKind::floating, 10, 8, Endian::little, offsetof(Header, scale), 8},
+    {FieldKind::bytes, 18, 3, Endian::little, offsetof(Header, tag), 3},
+};
+
+Header sample() {
+    Header h;
+    h.type = 0x0102;
+    h.length = 0x030405;
+    h.flags = -2;
+    h.delta = -70000;
+    h.scale = 1.5;
+    h.tag[0] = 'a';
+    h.tag[1] = 'b';
+    h.tag[2] = 'c';
+    return h;
+}
+
+// sample() as HeaderLayout encodes it.
+std::vector<uint8_t> sample_bytes() {
+    std::vector<uint8_t> b = {0x01, 0x02, 0x03, 0x04, 0x05, 0xFE, 0x00};
+    const uint32_t delta = static_cast<uint32_t>(-70000) & 0xFFFFFF;
+    for (int i = 0; i < 3; ++i) b.push_back(static_cast<uint8_t>(delta >> (8 * i)));
+    uint64_t scale;
+    const double s = 1.5;
+    std::memcpy(&scale, &s, 8);
+    for (int i = 0; i < 8; ++i) b.push_back(static_cast<uint8_t>(scale >> (8 * i)));
+    b.insert(b.end(), {'a', 'b', 'c'});
+    return b;
+}
+
+void static_layout() {
+    static_assert(HeaderLayout::size == 21);
+
+    Writer out;
+    const Header h = sample();
+    CHECK_OK(HeaderLayout::write(out, h));
+    const std::vector<uint8_t> want = sample_bytes();
+    CHECK(out.size() == want.size() && std::equal(want.begin(), want.end(), out.data()));
+
+    Reader in(out.data(), out.size());
+    Header back;
+    CHECK_OK(HeaderLayout::parse(in, back));
+    CHECK(back == h && in.empty());
+
+    // A truncated record is rejected before any field is read.
+    Reader short_in(out.data(), out.size() - 1);
+    CHECK_STATUS(HeaderLayout::parse(short_in, back), out_of_bounds);
+    CHECK(short_in.position() == 0);
+
+    uint8_t buf[HeaderLayout::size + 5];
+    Writer fixed(buf, sizeof(buf));
+    CHECK_OK(HeaderLayout::write(fixed, h));
+    CHECK_STATUS(HeaderLayout::write(fixed, h), out_of_bounds);
+    CHECK(fixed.size() == HeaderLayout::size);
+}
+
+void runtime_layout() {
+    RuntimeLayout layout;
+    CHECK_OK(RuntimeLayout::compile(header_fields, sizeof(Header), layout));
+    CHECK(layout.size() == HeaderLayout::size);
+
+    // Same wire bytes as the compile-time layout, in both directions.
+    const std::vector<uint8_t> wire = sample_bytes();
+    Reader in(wire.data(), wire.size());
+    Header h;
+    CHECK_OK(layout.parse(in, &h));
+    CHECK(h == sample() && in.empty());
+
+    Writer out;
+    CHECK_OK(layout.write(out, &h));
+    CHECK(out.size() == wire.size() && std::equal(wire.begin(), wire.end(), out.data()));
+
+    std::vector<Header> many(5, sample());
+    for (size_t i = 0; i < many.size(); ++i) many[i].length = static_cast<uint32_t>(i);
+    Writer batch;
+    CHECK_OK(layout.write_many(batch, many.size(), many.data(), sizeof(Header)));
+    std::vector<Header> parsed(many.size());
+    Reader bin(batch.data(), batch.size());
+    CHECK_OK(layout.parse_many(bin, parsed.size(), parsed.data(), sizeof(Header)));
+    CHECK(parsed == many && bin.empty());
+    Reader short_batch(batch.data(), batch.size() - 1);
+    CHECK_STATUS(layout.parse_many(short_batch, parsed.size(), parsed.data(), sizeof(Header)), out_of_bounds);
+
+    // Overlapping wire fields and targets past the object are rejected.
+    std::vector<RuntimeField> bad = header_fields;
+    bad[1].offset = 1;
+    RuntimeLayout rejected;
+    CHECK_STATUS(RuntimeLayout::compile(bad, sizeof(Header), rejected), invalid_argument);
+    CHECK_STATUS(RuntimeLayout::compile(header_fields, offsetof(Header, tag), rejected), invalid_argument);
+
+    // An empty layout fails cleanly instead of running no program.
+    RuntimeLayout empty;
+    Reader any(wire.data(), wire.size());
+    CHECK_STATUS(empty.parse(any, &h), invalid_argument);
+    CHECK_STATUS(empty.write(out, &h), invalid_argument);
+    CHECK_STATUS(empty.parse_many(any, 1, &h, sizeof(Header)), invalid_argument);
+    CHECK_STATUS(empty.write_many(out, 1, &h, sizeof(Header)), invalid_argument);
+}
+
+void runtime_layout_save_load() {
+    RuntimeLayout layout;
+    CHECK_OK(RuntimeLayout::compile(header_fields, sizeof(Header), layout));
+    Writer saved;
+    CHECK_OK(layout.save(saved));
+
+    Reader in(saved.data(), saved.size());
+    RuntimeLayout loaded;
+    CHECK_OK(RuntimeLayout::load(in, loaded));
+    CHECK(in.empty());
+    CHECK(loaded.size() == layout.size() && loaded.target_size() == layout.target_size());
+    CHECK(loaded.decode_ops() == layout.decode_ops() && loaded.encode_ops() == layout.encode_ops());
+
+    const std::vector<uint8_t> wire = sample_bytes();
+    Header h;
+    Reader rec(wire.data(), wire.size());
+    CHECK_OK(loaded.parse(rec, &h));
+    CHECK(h == sample());
+    Writer out;
+    CHECK_OK(loaded.write(out, &h));
+    CHECK(out.size() == wire.size() && std::equal(wire.begin(), wire.end(), out.data()));
+
+    // Every truncation of a saved program is rejected.
+    bool all_rejected = true;
+    for (size_t n = 0; n < saved.size(); ++n) {
+        Reader cut(saved.data(), n);
+        RuntimeLayout partial;
+        all_rejected &= RuntimeLayout::load(cut, partial) != Status::ok;
+    }
+    CHECK(all_rejected);
+}
+
+}  // namespace
+
+int main() {
+    static_layout();
+    runtime_layout();
+    runtime_layout_save_load();
+    return bpw::test::report("layout_test");
+}
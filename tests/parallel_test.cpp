@@ -0,0 +1,210 @@
+// Range planning, parallel_decode(), decode_records() and run_pipeline():
+// results land in input order and the lowest failing range wins.
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bpw/framing.hpp"
+#include "bpw/parallel.hpp"
+#include "bpw/pipeline.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/record_table.hpp"
+#include "bpw/thread_pool.hpp"
+#include "bpw/writer.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+constexpr Framing framing = Framing::length_prefixed(4, 0, 4, Endian::little, 4096);
+
+// Record i: 4-byte payload length, then the u32 i followed by i % 7 filler
+// bytes. A record numbered `poison` starts with 0xFFFFFFFF instead.
+std::vector<uint8_t> make_records(uint32_t count, uint32_t poison = UINT32_MAX) {
+    Writer out;
+    for (uint32_t i = 0; i < count; ++i) {
+        (void)out.write_le<uint32_t>(4 + i % 7);
+        (void)out.write_le<uint32_t>(i == poison ? UINT32_MAX : i);
+        for (uint32_t j = 0; j < i % 7; ++j) (void)out.write_u8(0);
+    }
+    return {out.data(), out.data() + out.size()};
+}
+
+// Record numbers in a chunk, or malformed at the poisoned record.
+Status decode_chunk(Reader& chunk, std::vector<uint32_t>& ids) {
+    Reader rec;
+    while (!chunk.empty()) {
+        if (Status s = framing.next(chunk, rec); s != Status::ok) return s;
+        uint32_t len, id;
+        if (rec.read_le(len) != Status::ok || rec.read_le(id) != Status::ok) return Status::out_of_bounds;
+        if (id == UINT32_MAX) return Status::malformed;
+        ids.push_back(id);
+    }
+    return Status::ok;
+}
+
+void plan_and_decode() {
+    const std::vector<uint8_t> file = make_records(5000);
+    const Reader in(file.data(), file.size());
+    std::vector<Range> ranges;
+    CHECK_OK(plan_ranges(in, framing, 2000, ranges));
+    CHECK(ranges.size() > 10);
+
+    // Ranges tile the input and count every record once.
+    size_t end = 0, records = 0;
+    bool tiled = true;
+    for (const Range& r : ranges) {
+        tiled &= r.offset == end && r.first_record == records;
+        end += r.size;
+        records += r.record_count;
+    }
+    CHECK(tiled && end == file.size() && records == 5000);
+
+    ThreadPool pool(4);
+    std::vector<std::vector<uint32_t>> results;
+    auto fn = [](const Range&, Reader& chunk, std::vector<uint32_t>& ids) { return decode_chunk(chunk, ids); };
+    CHECK_OK(parallel_decode(pool, in, ranges, results, fn));
+    uint32_t next = 0;
+    bool ordered = true;
+    for (const auto& ids : results)
+        for (uint32_t id : ids) ordered &= id == next++;
+    CHECK(ordered && next == 5000);
+
+    const std::vector<uint8_t> bad = make_records(5000, 3210);
+    std::vector<Range> bad_ranges;
+    CHECK_OK(plan_ranges(Reader(bad.data(), bad.size()), framing, 2000, bad_ranges));
+    CHECK_STATUS(parallel_decode(pool, Reader(bad.data(), bad.size()), bad_ranges, results, fn), malformed);
+
+    // A plan for another input is caught by range_reader().
+    Reader shorter(file.data(), file.size() / 2);
+    CHECK_STATUS(parallel_decode(pool, shorter, ranges, results, fn), out_of_bounds);
+}
+
+void record_table() {
+    const std::vector<uint8_t> file = make_records(3000);
+    const Reader in(file.data(), file.size());
+    RecordTable table;
+    CHECK_OK(RecordTable::build(in, framing, table));
+    CHECK(table.size() == 3000 && table.bytes() == file.size());
+
+    Reader rec;
+    uint32_t len = 0, id = 0;
+    CHECK_OK(table.record(in, 1234, rec));
+    CHECK(rec.read_le(len) == Status::ok && rec.read_le(id) == Status::ok && id == 1234);
+    CHECK_STATUS(table.record(in, 3000, rec), out_of_bounds);
+
+    ThreadPool pool(3);
+    std::vector<uint32_t> ids(table.size(), UINT32_MAX);
+    CHECK_OK(decode_records(pool, in, table, [&](size_t i, Reader& r) {
+        uint32_t l, v;
+        if (r.read_le(l) != Status::ok || r.read_le(v) != Status::ok) return Status::out_of_bounds;
+        ids[i] = v;
+        return Status::ok;
+    }, 100));
+    bool all = true;
+    for (uint32_t i = 0; i < ids.size(); ++i) all &= ids[i] == i;
+    CHECK(all);
+
+    // The lowest failing record's error is returned.
+    Status s = decode_records(pool, in, table, [](size_t i, Reader&) {
+        return i == 2500 ? Status::unsupported : i == 700 ? Status::malformed : Status::ok;
+    }, 64);
+    CHECK(s == Status::malformed);
+
+    // A truncated stream cannot be tabled.
+    RecordTable partial;
+    CHECK_STATUS(RecordTable::build(Reader(file.data(), file.size() - 1), framing, partial), out_of_bounds);
+}
+
+struct Batch {
+    std::vector<uint32_t> ids;
+};
+
+// The pipeline outputs ranges in order, stops at the lowest failing range
+// and has output everything before it.
+void pipeline_order(uint32_t poison, unsigned threads) {
+    const std::vector<uint8_t> file = make_records(4000, poison);
+    const Reader in(file.data(), file.size());
+    std::vector<Range> ranges;
+    CHECK_OK(plan_ranges(in, framing, 500, ranges));
+
+    size_t failing = ranges.size();
+    for (size_t i = 0; i < ranges.size(); ++i)
+        if (poison >= ranges[i].first_record && poison < ranges[i].first_record + ranges[i].record_count)
+            failing = i;
+
+    PipelineOptions opts;
+    opts.decode_threads = threads;
+    opts.transform_threads = threads;
+    opts.encode_threads = threads;
+    opts.max_in_flight = 5;
+    std::vector<size_t> output_order;
+    uint32_t next_id = 0;
+    bool in_order = true;
+    Status s = run_pipeline<Batch>(
+        in, ranges, opts,
+        [](const Range&, Reader& chunk, Batch& b) {
+            b.ids.clear();
+            return decode_chunk(chunk, b.ids);
+        },
+        [](const Range&, Batch& b) {
+            for (uint32_t& id : b.ids) id = ~id;
+            return Status::ok;
+        },
+        [](const Range&, const Batch& b, Writer& out) {
+            for (uint32_t id : b.ids)
+                if (Status e = out.write_le(~id); e != Status::ok) return e;
+            return Status::ok;
+        },
+        [&](const Range& r, std::span<const uint8_t> bytes) {
+            output_order.push_back(static_cast<size_t>(&r - ranges.data()));
+            Reader out(bytes);
+            uint32_t id;
+            while (out.read_le(id) == Status::ok) in_order &= id == next_id++;
+            return Status::ok;
+        });
+
+    CHECK(s == (failing < ranges.size() ? Status::malformed : Status::ok));
+    CHECK(output_order.size() == failing);
+    bool sequential = true;
+    for (size_t i = 0; i < output_order.size(); ++i) sequential &= output_order[i] == i;
+    CHECK(sequential && in_order);
+    CHECK(next_id == (failing < ranges.size() ? ranges[failing].first_record : 4000));
+}
+
+// An output error stops the pipeline just the same.
+void pipeline_output_error() {
+    const std::vector<uint8_t> file = make_records(2000);
+    std::vector<Range> ranges;
+    CHECK_OK(plan_ranges(Reader(file.data(), file.size()), framing, 300, ranges));
+    std::atomic<size_t> outputs{0};
+    PipelineOptions opts;
+    opts.decode_threads = 2;
+    Status s = run_pipeline<Batch>(
+        Reader(file.data(), file.size()), ranges, opts,
+        [](const Range&, Reader& chunk, Batch& b) {
+            b.ids.clear();
+            return decode_chunk(chunk, b.ids);
+        },
+        [](const Range&, Batch&) { return Status::ok; },
+        [](const Range&, const Batch&, Writer&) { return Status::ok; },
+        [&](const Range&, std::span<const uint8_t>) { return ++outputs == 4 ? Status::io_error : Status::ok; });
+    CHECK(s == Status::io_error && outputs == 4);
+}
+
+}  // namespace
+
+int main() {
+    plan_and_decode();
+    record_table();
+    for (unsigned threads : {1u, 3u}) {
+        pipeline_order(UINT32_MAX, threads);
+        pipeline_order(0, threads);
+        pipeline_order(1777, threads);
+        pipeline_order(3999, threads);
+    }
+    pipeline_output_error();
+    return bpw::test::report("parallel_test");
+}
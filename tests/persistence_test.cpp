@@ -0,0 +1,177 @@
+// OffsetIndex and LayoutCache written to disk and loaded back.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "bpw/framing.hpp"
+#include "bpw/layout_cache.hpp"
+#include "bpw/offset_index.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/runtime_layout.hpp"
+#include "bpw/writer.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+constexpr Framing framing = Framing::length_prefixed(2, 0, 2, Endian::big, 1024);
+
+std::string dir;
+
+// Record k: 2-byte length, then a 4-byte key (k * 7919 mod 1000), then k % 5
+// filler bytes.
+std::vector<uint8_t> make_records(uint32_t count) {
+    Writer out;
+    for (uint32_t k = 0; k < count; ++k) {
+        (void)out.write_be<uint16_t>(static_cast<uint16_t>(4 + k % 5));
+        (void)out.write_be<uint32_t>(k * 7919 % 1000);
+        for (uint32_t i = 0; i < k % 5; ++i) (void)out.write_u8(static_cast<uint8_t>(k));
+    }
+    return {out.data(), out.data() + out.size()};
+}
+
+uint64_t key_of(Reader& rec) {
+    uint32_t key = 0;
+    (void)rec.skip(2);
+    (void)rec.read_be(key);
+    return key;
+}
+
+// Entries in `dir` other than . and .., e.g. leftover temporaries.
+size_t dir_entries() {
+    size_t n = 0;
+    if (DIR* d = ::opendir(dir.c_str())) {
+        while (dirent* e = ::readdir(d)) n += std::string(e->d_name) != "." && std::string(e->d_name) != "..";
+        ::closedir(d);
+    }
+    return n;
+}
+
+void offset_index() {
+    const std::vector<uint8_t> file = make_records(1000);
+    const Reader in(file.data(), file.size());
+    OffsetIndex index;
+    CHECK_OK(OffsetIndex::build_keyed(in, framing, 16, index, key_of));
+    CHECK(index.record_count() == 1000 && index.keyed() && index.matches(file.size()));
+
+    const std::string path = dir + "/records.idx";
+    CHECK_OK(index.save(path.c_str()));
+    OffsetIndex loaded;
+    CHECK_OK(OffsetIndex::load(path.c_str(), loaded));
+    CHECK(loaded.record_count() == 1000 && loaded.stride() == 16 && loaded.source_size() == file.size());
+
+    // seek() lands on every record, whichever side of a checkpoint.
+    bool seeks = true;
+    for (uint64_t k : {uint64_t{0}, uint64_t{1}, uint64_t{15}, uint64_t{16}, uint64_t{17}, uint64_t{999}}) {
+        Reader at;
+        seeks &= loaded.seek(in, framing, k, at) == Status::ok;
+        Reader scan = in;
+        Reader rec;
+        for (uint64_t i = 0; i < k; ++i) seeks &= framing.next(scan, rec) == Status::ok;
+        seeks &= at.data() == scan.data();
+    }
+    CHECK(seeks);
+    Reader at;
+    CHECK_STATUS(loaded.seek(in, framing, 1000, at), out_of_bounds);
+    Reader shorter(file.data(), file.size() - 1);
+    CHECK_STATUS(loaded.seek(shorter, framing, 0, at), invalid_argument);
+
+    uint64_t record = 0;
+    CHECK_OK(loaded.find_key(919, record));  // 1 * 7919 % 1000
+    Reader hit;
+    CHECK_OK(loaded.seek(in, framing, record, hit));
+    CHECK(key_of(hit) == 919);
+    CHECK_STATUS(loaded.find_key(100000, record), out_of_bounds);
+
+    // Damaged files are rejected rather than half loaded.
+    Writer saved;
+    CHECK_OK(index.serialize(saved));
+    bool truncations = true;
+    for (size_t n = 0; n < saved.size(); n += 7) {
+        OffsetIndex partial;
+        truncations &= OffsetIndex::deserialize(Reader(saved.data(), n), partial) != Status::ok;
+    }
+    CHECK(truncations);
+    OffsetIndex missing;
+    CHECK(OffsetIndex::load((dir + "/no-such.idx").c_str(), missing) != Status::ok);
+    std::remove(path.c_str());
+}
+
+struct Point {
+    uint32_t x;
+    uint16_t y;
+    int8_t z;
+};
+
+const std::vector<RuntimeField> point_fields = {
+    {FieldKind::unsigned_int, 0, 4, Endian::big, offsetof(Point, x), 4},
+    {FieldKind::unsigned_int, 4, 2, Endian::little, offsetof(Point, y), 2},
+    {FieldKind::signed_int, 6, 1, Endian::little, offsetof(Point, z), 1},
+};
+
+void layout_cache() {
+    LayoutCache cache;
+    const RuntimeLayout* a = nullptr;
+    const RuntimeLayout* b = nullptr;
+    CHECK_OK(cache.get(point_fields, sizeof(Point), a));
+    // Field order does not matter.
+    const std::vector<RuntimeField> reversed(point_fields.rbegin(), point_fields.rend());
+    CHECK_OK(cache.get(reversed, sizeof(Point), b));
+    CHECK(a && a == b && cache.size() == 1 && cache.compilations() == 1);
+
+    const std::string path = dir + "/layouts.bin";
+    CHECK_OK(cache.save(path.c_str()));
+
+    LayoutCache warm;
+    CHECK_OK(warm.load(path.c_str()));
+    const RuntimeLayout* c = nullptr;
+    CHECK_OK(warm.get(point_fields, sizeof(Point), c));
+    CHECK(c && warm.size() == 1 && warm.compilations() == 0);
+
+    const uint8_t wire[] = {0x00, 0x00, 0x01, 0x02, 0x03, 0x00, 0xFF};
+    Reader in(wire, sizeof(wire));
+    Point p{};
+    CHECK_OK(c->parse(in, &p));
+    CHECK(p.x == 0x102 && p.y == 3 && p.z == -1);
+
+    // A corrupt file leaves the cache as it was.
+    Writer saved;
+    CHECK_OK(cache.serialize(saved));
+    saved.data()[saved.size() - 1] ^= 0x55;
+    LayoutCache cold;
+    CHECK(cold.deserialize(Reader(saved.data(), saved.size())) != Status::ok);
+    CHECK(cold.size() == 0);
+
+    // Concurrent saves of one path never share a temporary file: the file
+    // ends up loadable and nothing is left behind.
+    std::vector<std::thread> savers;
+    std::vector<Status> results(4, Status::ok);
+    for (size_t t = 0; t < results.size(); ++t)
+        savers.emplace_back([&, t] {
+            for (int i = 0; i < 20 && results[t] == Status::ok; ++i) results[t] = cache.save(path.c_str());
+        });
+    for (std::thread& t : savers) t.join();
+    for (Status s : results) CHECK(s == Status::ok);
+    LayoutCache again;
+    CHECK_OK(again.load(path.c_str()));
+    CHECK(again.size() == 1);
+    CHECK(dir_entries() == 1);
+    std::remove(path.c_str());
+}
+
+}  // namespace
+
+int main() {
+    dir = bpw::test::temp_dir();
+    offset_index();
+    layout_cache();
+    ::rmdir(dir.c_str());
+    return bpw::test::report("persistence_test");
+}
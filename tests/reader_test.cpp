@@ -0,0 +1,163 @@
+// Reader, BitReader, Writer and BitWriter edge cases.
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "bpw/bit_reader.hpp"
+#include "bpw/bit_writer.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/writer.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+void reader_bounds() {
+    Reader empty;
+    uint32_t v = 7;
+    CHECK(empty.empty() && empty.remaining() == 0);
+    CHECK_STATUS(empty.read_le(v), out_of_bounds);
+    CHECK(v == 7);
+    CHECK_OK(empty.skip(0));
+
+    const uint8_t buf[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    Reader r(buf, sizeof(buf));
+    CHECK_OK(r.read_be(v));
+    CHECK(v == 0x01020304);
+    // A failed read leaves the position alone.
+    CHECK_STATUS(r.read_le(v), out_of_bounds);
+    CHECK(r.position() == 4 && r.remaining() == 1);
+    CHECK_STATUS(r.skip(SIZE_MAX), out_of_bounds);
+    CHECK(r.position() == 4);
+    uint8_t b = 0;
+    CHECK_OK(r.read_u8(b));
+    CHECK(b == 5 && r.empty());
+
+    CHECK_OK(r.seek(r.size()));
+    CHECK_STATUS(r.seek(r.size() + 1), out_of_bounds);
+    CHECK_OK(r.seek(1));
+    uint16_t le = 0, be = 0;
+    CHECK_OK(r.peek_le(le));
+    CHECK_OK(r.peek_be(be));
+    CHECK(le == 0x0302 && be == 0x0203 && r.position() == 1);
+}
+
+void reader_views() {
+    const uint8_t buf[] = {10, 11, 12, 13, 14, 15, 16, 17};
+    Reader r(buf, sizeof(buf));
+    CHECK_OK(r.skip(2));
+
+    Reader sub;
+    CHECK_OK(r.sub_reader(3, sub));
+    CHECK(sub.data() == buf + 2 && sub.size() == 3 && r.position() == 5);
+    CHECK_STATUS(r.sub_reader(4, sub), out_of_bounds);
+    CHECK(r.position() == 5);
+
+    // slice() addresses the whole buffer, not the unread part.
+    Reader s;
+    CHECK_OK(r.slice(0, 8, s));
+    CHECK(s.data() == buf && s.size() == 8 && r.position() == 5);
+    CHECK_OK(r.slice(8, 0, s));
+    CHECK(s.empty());
+    CHECK_STATUS(r.slice(9, 0, s), out_of_bounds);
+    CHECK_STATUS(r.slice(4, SIZE_MAX, s), out_of_bounds);
+
+    std::span<const uint8_t> bytes;
+    CHECK_OK(r.read_bytes(3, bytes));
+    CHECK(bytes.data() == buf + 5 && bytes.size() == 3 && r.empty());
+    CHECK_STATUS(r.read_bytes(1, bytes), out_of_bounds);
+}
+
+void bit_reader_fields() {
+    const uint8_t buf[] = {0b1011'0011, 0xF0, 0x12, 0x34, 0x56, 0x78};
+    BitReader br(buf, sizeof(buf));
+    CHECK(br.read_bits(3) == 0b101);
+    CHECK(br.read_bits(5) == 0b10011);
+    CHECK(br.is_byte_aligned());
+    CHECK(br.read_bits(4) == 0xF);
+    CHECK(br.read_signed_bits(4) == 0);
+    CHECK(br.read_bits(32) == 0x12345678);
+    CHECK(br.bits_remaining() == 0 && br.status() == Status::ok);
+
+    // Missing bits read as zero and latch the overrun.
+    CHECK(br.read_bits(8) == 0);
+    CHECK(br.overrun() && br.status() == Status::out_of_bounds);
+
+    BitReader sign(buf, 1);
+    CHECK(sign.read_signed_bits(3) == -3);  // 0b101
+    sign.align_to_byte();
+    CHECK(sign.bit_position() == 8 && sign.status() == Status::ok);
+
+    BitReader skip(buf, sizeof(buf));
+    skip.skip_bits(47);
+    CHECK(skip.read_bit() == false && skip.status() == Status::ok);
+    skip.skip_bits(1000);
+    CHECK(skip.status() == Status::out_of_bounds);
+}
+
+// BitWriter -> BitReader over short buffers, so every read mixes the
+// word refill and the tail refill.
+void bit_round_trip() {
+    std::mt19937 rng(7);
+    for (size_t fields = 0; fields < 64; ++fields) {
+        std::vector<unsigned> widths(fields);
+        std::vector<uint64_t> values(fields);
+        Writer out;
+        BitWriter bw(out);
+        for (size_t i = 0; i < fields; ++i) {
+            widths[i] = static_cast<unsigned>(rng() % 65);
+            const uint64_t mask = widths[i] == 64 ? ~uint64_t{0} : (uint64_t{1} << widths[i]) - 1;
+            values[i] = (uint64_t{rng()} << 32 | rng()) & mask;
+            bw.write_bits64(values[i], widths[i]);
+        }
+        CHECK_OK(bw.finish());
+
+        BitReader br(out.data(), out.size());
+        bool same = true;
+        for (size_t i = 0; i < fields; ++i) same &= br.read_bits64(widths[i]) == values[i];
+        CHECK(same);
+        CHECK(br.status() == Status::ok && br.bits_remaining() < 8);
+    }
+}
+
+void writer_fixed_buffer() {
+    uint8_t buf[6] = {};
+    Writer w(buf, sizeof(buf));
+    CHECK(!w.owns_buffer());
+    CHECK_OK(w.write_be<uint32_t>(0xA1B2C3D4));
+    // A write that does not fit fails without writing part of it.
+    CHECK_STATUS(w.write_le<uint32_t>(1), out_of_bounds);
+    CHECK(w.size() == 4);
+    CHECK_OK(w.write_le<uint16_t>(0x0201));
+    const uint8_t want[] = {0xA1, 0xB2, 0xC3, 0xD4, 0x01, 0x02};
+    CHECK(std::equal(buf, buf + 6, want));
+
+    // Bits that no longer fit latch the failure.
+    uint8_t small[2];
+    Writer tiny(small, sizeof(small));
+    BitWriter bw(tiny);
+    bw.write_bits(0xFFFFFF, 24);
+    CHECK(bw.finish() != Status::ok);
+
+    Writer grow;
+    for (uint32_t i = 0; i < 10000; ++i) CHECK_OK(grow.write_le(i));
+    Reader r(grow.data(), grow.size());
+    uint32_t v = 0;
+    bool same = true;
+    for (uint32_t i = 0; i < 10000; ++i) same &= r.read_le(v) == Status::ok && v == i;
+    CHECK(same && r.empty());
+}
+
+}  // namespace
+
+int main() {
+    reader_bounds();
+    reader_views();
+    bit_reader_fields();
+    bit_round_trip();
+    writer_fixed_buffer();
+    return bpw::test::report("reader_test");
+}
@@ -0,0 +1,120 @@
+// StreamParser against Framing::next over every way of splitting a stream.
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "bpw/framing.hpp"
+#include "bpw/reader.hpp"
+#include "bpw/stream_parser.hpp"
+#include "bpw/writer.hpp"
+#include "check.hpp"
+
+using namespace bpw;
+
+namespace {
+
+constexpr Framing framing = Framing::length_prefixed(3, 1, 2, Endian::big, 64);
+
+// Records with payloads of 0..11 bytes; each byte identifies its record.
+std::vector<uint8_t> make_stream() {
+    Writer out;
+    for (uint8_t i = 0; i < 12; ++i) {
+        (void)out.write_u8(0xA0);
+        (void)out.write_be<uint16_t>(i);
+        for (uint8_t j = 0; j < i; ++j) (void)out.write_u8(i);
+    }
+    return {out.data(), out.data() + out.size()};
+}
+
+using Records = std::vector<std::vector<uint8_t>>;
+
+Records expected(const std::vector<uint8_t>& stream) {
+    Records out;
+    Reader in(stream.data(), stream.size());
+    Reader rec;
+    while (!in.empty() && framing.next(in, rec) == Status::ok) out.emplace_back(rec.data(), rec.data() + rec.size());
+    return out;
+}
+
+Status feed_split(StreamParser& parser, std::span<const uint8_t> stream, std::span<const size_t> cuts,
+                  Records& got) {
+    auto collect = [&](Reader& rec) {
+        got.emplace_back(rec.data(), rec.data() + rec.size());
+        return Status::ok;
+    };
+    size_t at = 0;
+    for (size_t cut : cuts) {
+        if (Status s = parser.feed(stream.subspan(at, cut - at), collect); s != Status::ok) return s;
+        at = cut;
+    }
+    return parser.feed(stream.subspan(at), collect);
+}
+
+void every_two_cuts() {
+    const std::vector<uint8_t> stream = make_stream();
+    const Records want = expected(stream);
+    CHECK(want.size() == 12);
+
+    bool all_same = true;
+    for (size_t a = 0; a <= stream.size(); ++a) {
+        for (size_t b = a; b <= stream.size(); ++b) {
+            StreamParser parser(framing);
+            Records got;
+            const size_t cuts[] = {a, b};
+            all_same &= feed_split(parser, stream, cuts, got) == Status::ok && got == want &&
+                        parser.at_boundary() && parser.consumed() == stream.size();
+        }
+    }
+    CHECK(all_same);
+}
+
+void byte_at_a_time() {
+    const std::vector<uint8_t> stream = make_stream();
+    std::vector<size_t> cuts;
+    for (size_t i = 1; i < stream.size(); ++i) cuts.push_back(i);
+    StreamParser parser(framing);
+    Records got;
+    CHECK_OK(feed_split(parser, stream, cuts, got));
+    CHECK(got == expected(stream));
+
+    // Truncated streams keep the partial record buffered.
+    StreamParser partial(framing);
+    Records some;
+    CHECK_OK(feed_split(partial, std::span(stream).first(stream.size() - 2), {}, some));
+    CHECK(some.size() == 11 && !partial.at_boundary() && partial.buffered() == 12);
+}
+
+void errors_latch() {
+    // Length 70 + 3 header bytes exceeds max_size.
+    const uint8_t big[] = {0xA0, 0x00, 70};
+    StreamParser parser(framing);
+    Records got;
+    CHECK(feed_split(parser, big, {}, got) != Status::ok);
+    const Status latched = parser.status();
+    CHECK(latched != Status::ok);
+    const std::vector<uint8_t> stream = make_stream();
+    CHECK(feed_split(parser, stream, {}, got) == latched);
+    CHECK(got.empty());
+    parser.reset();
+    CHECK_OK(feed_split(parser, stream, {}, got));
+    CHECK(got.size() == 12);
+
+    // A handler error stops the parse and is returned.
+    StreamParser stopping(framing);
+    size_t seen = 0;
+    Status s = stopping.feed(stream, [&](Reader&) { return ++seen == 3 ? Status::malformed : Status::ok; });
+    CHECK(s == Status::malformed && seen == 3 && stopping.status() == Status::malformed);
+
+    // An unbounded framing cannot size the carry buffer.
+    StreamParser unbounded(Framing::length_prefixed(3, 1, 2, Endian::big));
+    CHECK(unbounded.status() != Status::ok);
+}
+
+}  // namespace
+
+int main() {
+    every_two_cuts();
+    byte_at_a_time();
+    errors_latch();
+    return bpw::test::report("stream_parser_test");
+}